@@ -0,0 +1,146 @@
+// Kernel benchmark: samples/sec of every AudioKernels routine for each
+// instruction set the CPU supports, compared with the scalar fallback.
+// Results of each variant are checked against the scalar output.
+//
+// Usage: bench_audiokernels [samples per pass=65536] [passes=2000]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+#include "../src/audiokernels.h"
+
+using AudioKernels::InstructionSet;
+
+namespace {
+
+struct Buffers {
+    std::vector<qint16> s16;
+    std::vector<qint32> s32;
+    std::vector<float> input;
+    std::vector<float> output;
+    std::vector<qint16> s16Out;
+    std::vector<qint32> s32Out;
+};
+
+double samplesPerSecond(size_t samples, int passes, const std::function<void()>& kernel)
+{
+    kernel(); // Warm up caches and the dispatch table
+    const auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        kernel();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds > 0.0 ? static_cast<double>(samples) * passes / seconds : 0.0;
+}
+
+template <typename T>
+double maxDifference(const std::vector<T>& a, const std::vector<T>& b)
+{
+    double difference = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        difference = std::max(difference, std::fabs(static_cast<double>(a[i]) - static_cast<double>(b[i])));
+    }
+    return difference;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t samples = argc > 1 ? std::max(64, atoi(argv[1])) : 65536;
+    const int passes = argc > 2 ? std::max(1, atoi(argv[2])) : 2000;
+
+    Buffers buffers;
+    buffers.s16.resize(samples);
+    buffers.s32.resize(samples);
+    buffers.input.resize(samples);
+    buffers.output.resize(samples);
+    buffers.s16Out.resize(samples);
+    buffers.s32Out.resize(samples);
+
+    // Include values beyond full scale so the clipping paths are exercised
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> distribution(-1.25f, 1.25f);
+    for (size_t i = 0; i < samples; ++i) {
+        buffers.input[i] = distribution(random);
+        buffers.s16[i] = static_cast<qint16>(random());
+        buffers.s32[i] = static_cast<qint32>(random());
+    }
+
+    struct Kernel {
+        const char* name;
+        std::function<void()> run;
+        std::function<std::vector<double>()> result;
+    };
+
+    Buffers& b = buffers;
+    auto asDouble = [](const auto& values) { return std::vector<double>(values.begin(), values.end()); };
+    const std::vector<Kernel> kernels = {
+        { "s16ToFloat", [&] { AudioKernels::s16ToFloat(b.s16.data(), b.output.data(), samples); },
+          [&] { AudioKernels::s16ToFloat(b.s16.data(), b.output.data(), samples); return asDouble(b.output); } },
+        { "s32ToFloat", [&] { AudioKernels::s32ToFloat(b.s32.data(), b.output.data(), samples); },
+          [&] { AudioKernels::s32ToFloat(b.s32.data(), b.output.data(), samples); return asDouble(b.output); } },
+        { "floatToS16", [&] { AudioKernels::floatToS16(b.input.data(), b.s16Out.data(), samples); },
+          [&] { AudioKernels::floatToS16(b.input.data(), b.s16Out.data(), samples); return asDouble(b.s16Out); } },
+        { "floatToS32", [&] { AudioKernels::floatToS32(b.input.data(), b.s32Out.data(), samples); },
+          [&] { AudioKernels::floatToS32(b.input.data(), b.s32Out.data(), samples); return asDouble(b.s32Out); } },
+        // Gain/mix kernels accumulate into the output across passes; gains
+        // are chosen so the values stay bounded
+        { "applyGain", [&] { AudioKernels::applyGain(b.output.data(), 0.999f, samples); },
+          [&] { b.output = b.input; AudioKernels::applyGain(b.output.data(), 0.5f, samples); return asDouble(b.output); } },
+        { "mixAdd", [&] { AudioKernels::mixAdd(b.input.data(), b.output.data(), samples); },
+          [&] { std::fill(b.output.begin(), b.output.end(), 0.25f); AudioKernels::mixAdd(b.input.data(), b.output.data(), samples); return asDouble(b.output); } },
+        { "mixStereo", [&] { AudioKernels::mixStereo(b.input.data(), b.output.data(), samples / 2, 0.7f, 0.3f); },
+          [&] { std::fill(b.output.begin(), b.output.end(), 0.25f); AudioKernels::mixStereo(b.input.data(), b.output.data(), samples / 2, 0.7f, 0.3f); return asDouble(b.output); } },
+    };
+
+    const InstructionSet sets[] = {
+        InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::NEON
+    };
+
+    std::printf("best instruction set: %s\n", AudioKernels::instructionSetName(AudioKernels::bestInstructionSet()));
+    std::printf("%zu samples x %d passes\n\n", samples, passes);
+    std::printf("%-12s %-8s %14s %9s %12s\n", "kernel", "isa", "Msamples/s", "speedup", "max diff");
+
+    bool mismatch = false;
+    for (const Kernel& kernel : kernels) {
+        AudioKernels::setInstructionSet(InstructionSet::Scalar);
+        const std::vector<double> reference = kernel.result();
+        double scalarRate = 0.0;
+
+        for (InstructionSet set : sets) {
+            if (!AudioKernels::setInstructionSet(set)) {
+                continue;
+            }
+            const std::vector<double> result = kernel.result();
+            const double difference = maxDifference(reference, result);
+            std::fill(b.output.begin(), b.output.end(), 0.0f);
+            const double rate = samplesPerSecond(samples, passes, kernel.run);
+            if (set == InstructionSet::Scalar) {
+                scalarRate = rate;
+            }
+
+            std::printf("%-12s %-8s %14.1f %8.2fx %12.3g\n", kernel.name, AudioKernels::instructionSetName(set),
+                        rate / 1.0e6, scalarRate > 0.0 ? rate / scalarRate : 0.0, difference);
+
+            // Integer outputs must match exactly, float outputs to rounding
+            if (difference > 1.0e-6) {
+                mismatch = true;
+            }
+        }
+        std::printf("\n");
+    }
+
+    AudioKernels::setInstructionSet(AudioKernels::bestInstructionSet());
+
+    if (mismatch) {
+        std::printf("MISMATCH: a SIMD kernel disagrees with the scalar fallback\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,364 @@
+// Clip scaling benchmark: the cost of a loop arrangement of N clips as one
+// AudioItem each, added the way TimelineWidget::addAudioItemToTrack adds
+// them, against batched clips kept in their Track's ClipArray. Reports the
+// time to add them, heap bytes per clip (the scene's index is counted after
+// its first query), hit tests under the pointer, and rendering a window of
+// the arrangement.
+//
+// It also adds the clips the way an import does, through
+// TimelineWidget::addAudioItemToTrack with an AudioMixer taking every
+// arrangementChanged as MainWindow does, and reports that time (duration
+// probes and arrangement publishes included) and the publishes it took.
+// The loop is a WAV file written to a temporary directory; settings and
+// caches are kept apart from the app's.
+//
+// Heap use is glibc's count of bytes in use. Elsewhere it is counted by
+// replacing the global operator new, which misses Qt containers (they call
+// malloc directly), ClipArray's storage among them.
+//
+// Runs offscreen unless QT_QPA_PLATFORM says otherwise.
+//
+// Usage: bench_clips [clips=10000] [tracks=8]
+
+#include <QApplication>
+#include <QDataStream>
+#include <QFile>
+#include <QGraphicsScene>
+#include <QImage>
+#include <QLoggingCategory>
+#include <QPainter>
+#include <QPixmapCache>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include "../src/appconfig.h"
+#include "../src/audiomixer.h"
+#include "../src/transportclock.h"
+#include "../timelinewidget/audioitem.h"
+#include "../timelinewidget/timelinewidget.h"
+#include "../timelinewidget/track.h"
+
+namespace {
+
+#if defined(__GLIBC__)
+long long heapBytes()
+{
+    const struct mallinfo2 info = mallinfo2();
+    return static_cast<long long>(info.uordblks + info.hblkhd);
+}
+#else
+std::atomic<long long> allocatedBytes{ 0 };
+
+long long heapBytes()
+{
+    return allocatedBytes;
+}
+
+// Size is stored in front of each block so delete can subtract it
+constexpr size_t HEADER = alignof(std::max_align_t);
+
+void* allocate(size_t size)
+{
+    char* block = static_cast<char*>(std::malloc(size + HEADER));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<size_t*>(block) = size;
+    allocatedBytes += static_cast<long long>(size);
+    return block + HEADER;
+}
+
+void release(void* pointer)
+{
+    if (pointer) {
+        char* block = static_cast<char*>(pointer) - HEADER;
+        allocatedBytes -= static_cast<long long>(*reinterpret_cast<size_t*>(block));
+        std::free(block);
+    }
+}
+#endif
+
+constexpr int SAMPLE_RATE = 44100;
+constexpr int TRACK_HEIGHT = 50;
+constexpr int RULER_HEIGHT = 20;
+constexpr double LOOP_SECONDS = 4.0;
+constexpr double PIXELS_PER_SECOND = TimeScale::DEFAULT_PIXELS_PER_SECOND;
+constexpr int VIEW_WIDTH = 1920;
+constexpr int HIT_TESTS = 100000;
+constexpr int RENDERS = 50;
+
+double milliseconds(const std::function<void()>& work)
+{
+    const auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Result {
+    double addMs = 0.0;
+    double timelineAddMs = 0.0; // Through TimelineWidget, until the mixer has the arrangement
+    int publishes = 0;          // Arrangements the mixer was given meanwhile
+    double bytesPerClip = 0.0;        // After adding
+    double indexedBytesPerClip = 0.0; // After the scene's first query
+    double hitTestNs = 0.0;
+    double renderMs = 0.0;
+    int hits = 0;
+};
+
+// Decaying noise bursts on every beat, stereo 16-bit
+bool writeLoop(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    const qint32 frames = static_cast<qint32>(LOOP_SECONDS * SAMPLE_RATE);
+    const qint32 dataBytes = frames * 2 * 2;
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData("RIFF", 4);
+    out << qint32(36 + dataBytes);
+    out.writeRawData("WAVEfmt ", 8);
+    out << qint32(16) << qint16(1) << qint16(2) << qint32(SAMPLE_RATE) << qint32(SAMPLE_RATE * 4) << qint16(4)
+        << qint16(16);
+    out.writeRawData("data", 4);
+    out << dataBytes;
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<double> noise(-1.0, 1.0);
+    const qint32 beatFrames = SAMPLE_RATE / 2;
+    for (qint32 frame = 0; frame < frames; ++frame) {
+        const double envelope = std::exp(-8.0 * (frame % beatFrames) / static_cast<double>(SAMPLE_RATE));
+        for (int channel = 0; channel < 2; ++channel) {
+            const double value = envelope * 0.6 * noise(random);
+            out << static_cast<qint16>(qBound(-1.0, value, 1.0) * 32767);
+        }
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+// Loop instance i: which track, and when
+int trackOf(int clip, int tracks) { return clip % tracks; }
+double startOf(int clip, int tracks) { return (clip / tracks) * LOOP_SECONDS; }
+// Scene width of the whole arrangement
+double widthOf(int clips, int tracks) { return (startOf(clips - 1, tracks) + LOOP_SECONDS) * PIXELS_PER_SECOND; }
+
+std::vector<QPointF> hitPoints(int clips, int tracks)
+{
+    std::mt19937 random(42);
+    const double width = widthOf(clips, tracks);
+    std::uniform_real_distribution<double> x(0.0, width);
+    std::uniform_real_distribution<double> y(RULER_HEIGHT, RULER_HEIGHT + tracks * TRACK_HEIGHT);
+    std::vector<QPointF> points(HIT_TESTS);
+    for (QPointF& point : points) {
+        point = QPointF(x(random), y(random));
+    }
+    return points;
+}
+
+double renderWindows(QGraphicsScene& scene, int clips, int tracks)
+{
+    QImage image(VIEW_WIDTH, tracks * TRACK_HEIGHT, QImage::Format_ARGB32_Premultiplied);
+    std::mt19937 random(7);
+    const double width = widthOf(clips, tracks);
+    std::uniform_real_distribution<double> left(0.0, std::max(0.0, width - VIEW_WIDTH));
+    return milliseconds([&] {
+        for (int render = 0; render < RENDERS; ++render) {
+            QPainter painter(&image);
+            const QRectF source(left(random), RULER_HEIGHT, VIEW_WIDTH, tracks * TRACK_HEIGHT);
+            scene.render(&painter, QRectF(image.rect()), source, Qt::IgnoreAspectRatio);
+        }
+    }) / RENDERS;
+}
+
+QList<Track*> addTracks(QGraphicsScene& scene, int tracks, qreal width)
+{
+    QList<Track*> result;
+    for (int index = 0; index < tracks; ++index) {
+        Track* track = new Track(TRACK_HEIGHT, width);
+        track->setIndex(index);
+        track->setPos(0, RULER_HEIGHT + index * TRACK_HEIGHT);
+        scene.addItem(track);
+        result.append(track);
+    }
+    return result;
+}
+
+Result benchAudioItems(int clips, int tracks, const PeakPyramid& peaks)
+{
+    Result result;
+    QGraphicsScene scene;
+    QObject receiver; // Stands in for TimelineWidget's slots
+    const qreal width = widthOf(clips, tracks);
+    const QList<Track*> trackItems = addTracks(scene, tracks, width);
+
+    const long long before = heapBytes();
+    result.addMs = milliseconds([&] {
+        for (int clip = 0; clip < clips; ++clip) {
+            const int track = trackOf(clip, tracks);
+            AudioItem* item = new AudioItem(track, startOf(clip, tracks), LOOP_SECONDS, QColor(255, 107, 107),
+                                            TRACK_HEIGHT, nullptr);
+            item->setTimeIndicatorHeight(RULER_HEIGHT);
+            item->setFilePath(QStringLiteral("loop.wav"));
+            item->setPeaks(peaks);
+            item->setPos(startOf(clip, tracks) * PIXELS_PER_SECOND, RULER_HEIGHT + track * TRACK_HEIGHT);
+            trackItems[track]->addAudioItem(item);
+            scene.addItem(item);
+            QObject::connect(item, &AudioItem::currentItem, &receiver, [](AudioItem*) {});
+            QObject::connect(item, &AudioItem::removeRequested, &receiver, [](AudioItem*) {});
+            QObject::connect(item, &AudioItem::positionChanged, &receiver, [](const QPointF&) {});
+        }
+    });
+    result.bytesPerClip = static_cast<double>(heapBytes() - before) / clips;
+
+    const std::vector<QPointF> points = hitPoints(clips, tracks);
+    scene.items(points.front()); // Builds the BSP index
+    result.indexedBytesPerClip = static_cast<double>(heapBytes() - before) / clips;
+    result.hitTestNs = milliseconds([&] {
+        for (const QPointF& point : points) {
+            const QList<QGraphicsItem*> items = scene.items(point);
+            result.hits += !items.isEmpty() && dynamic_cast<AudioItem*>(items.first()) != nullptr;
+        }
+    }) * 1.0e6 / points.size();
+
+    result.renderMs = renderWindows(scene, clips, tracks);
+    return result;
+}
+
+Result benchBatched(int clips, int tracks, const PeakPyramid& peaks)
+{
+    Result result;
+    QGraphicsScene scene;
+    const qreal width = widthOf(clips, tracks);
+    const QList<Track*> trackItems = addTracks(scene, tracks, width);
+
+    const long long before = heapBytes();
+    result.addMs = milliseconds([&] {
+        for (int clip = 0; clip < clips; ++clip) {
+            Track* track = trackItems[trackOf(clip, tracks)];
+            track->addClip(QStringLiteral("loop.wav"), startOf(clip, tracks), LOOP_SECONDS, QColor(255, 107, 107));
+        }
+        for (Track* track : trackItems) {
+            track->setSourcePeaks(QStringLiteral("loop.wav"), peaks);
+        }
+    });
+    result.bytesPerClip = static_cast<double>(heapBytes() - before) / clips;
+
+    // Same query as the item version: find the track under the point, then its clip
+    const std::vector<QPointF> points = hitPoints(clips, tracks);
+    scene.items(points.front());
+    result.indexedBytesPerClip = static_cast<double>(heapBytes() - before) / clips;
+    result.hitTestNs = milliseconds([&] {
+        for (const QPointF& point : points) {
+            const QList<QGraphicsItem*> items = scene.items(point);
+            Track* track = items.isEmpty() ? nullptr : dynamic_cast<Track*>(items.first());
+            result.hits += track && track->clips().clipAt(track->mapFromScene(point).x() / PIXELS_PER_SECOND) >= 0;
+        }
+    }) * 1.0e6 / points.size();
+
+    result.renderMs = renderWindows(scene, clips, tracks);
+    return result;
+}
+
+// The import path: addAudioItemToTrack per clip, with the mixer listening as in MainWindow
+void benchTimeline(Result& result, int clips, int tracks, bool batched, const QString& loop)
+{
+    AppConfig& config = AppConfig::instance();
+    config.setBatchedClips(batched);
+    config.setSceneHeight((tracks + 1) * config.getTrackHeight()); // The widget creates this many tracks
+
+    TransportClock clock(SAMPLE_RATE);
+    AudioMixer mixer(&clock);
+    TimelineWidget widget;
+    QObject::connect(&widget, &TimelineWidget::arrangementChanged, &widget, [&] {
+        mixer.setArrangement(widget.mixerArrangement());
+        ++result.publishes;
+    });
+
+    result.timelineAddMs = milliseconds([&] {
+        for (int clip = 0; clip < clips; ++clip) {
+            widget.addAudioItemToTrack(loop, trackOf(clip, tracks), QColor(255, 107, 107), startOf(clip, tracks));
+        }
+        // The arrangement goes out once control is back in the event loop
+        while (result.publishes == 0) {
+            QCoreApplication::processEvents();
+        }
+    });
+}
+
+void print(const char* name, const Result& result)
+{
+    std::printf("%-10s %10.1f %12.0f %12.0f %12.0f %10.2f %8d %12.1f %10d\n", name, result.addMs, result.bytesPerClip,
+                result.indexedBytesPerClip, result.hitTestNs, result.renderMs, result.hits, result.timelineAddMs,
+                result.publishes);
+}
+
+} // namespace
+
+#if !defined(__GLIBC__)
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void operator delete(void* pointer) noexcept { release(pointer); }
+void operator delete[](void* pointer) noexcept { release(pointer); }
+void operator delete(void* pointer, size_t) noexcept { release(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { release(pointer); }
+#endif
+
+int main(int argc, char* argv[])
+{
+    const int clips = argc > 1 ? std::max(1, atoi(argv[1])) : 10000;
+    const int tracks = argc > 2 ? std::max(1, atoi(argv[2])) : 8;
+
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("bench_clips")); // Own settings and caches
+    QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false"));
+    QPixmapCache::setCacheLimit(64 * 1024); // As TimelineWidget sets it
+
+    // One loop, LOOP_SECONDS of noise
+    const qint64 frames = static_cast<qint64>(LOOP_SECONDS * SAMPLE_RATE);
+    std::vector<float> samples(static_cast<size_t>(frames) * 2);
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (float& sample : samples) {
+        sample = distribution(random);
+    }
+    const PeakPyramid peaks = PeakPyramid::build(samples.data(), frames);
+
+    QTemporaryDir directory;
+    const QString loop = directory.filePath(QStringLiteral("loop.wav"));
+    if (!directory.isValid() || !writeLoop(loop)) {
+        std::fprintf(stderr, "Could not write %s\n", qPrintable(loop));
+        return 1;
+    }
+
+    std::printf("%d clips of a %.0f s loop on %d tracks; %d hit tests, %d renders of %d px\n\n", clips, LOOP_SECONDS,
+                tracks, HIT_TESTS, RENDERS, VIEW_WIDTH);
+    std::printf("%-10s %10s %12s %12s %12s %10s %8s %12s %10s\n", "mode", "add ms", "B/clip", "indexed B", "hit ns",
+                "render ms", "hits", "import ms", "publishes");
+
+    Result items = benchAudioItems(clips, tracks, peaks);
+    QPixmapCache::clear();
+    benchTimeline(items, clips, tracks, false, loop);
+    print("items", items);
+    QPixmapCache::clear();
+    Result batched = benchBatched(clips, tracks, peaks);
+    QPixmapCache::clear();
+    benchTimeline(batched, clips, tracks, true, loop);
+    print("batched", batched);
+    return 0;
+}
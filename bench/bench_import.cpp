@@ -0,0 +1,177 @@
+// Import benchmark: time to import one file the old way (the engine, the
+// waveform and the duration probe each opening the file, two of them decoding
+// it in full) against a single MediaCache::load() serving all three, and
+// against reloading it from the on-disk PCM cache (mapped, not decoded) and
+// mapping only its peaks, as reopening a project does for the timeline.
+//
+// Usage: bench_import <audio file> [runs=3]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "../src/appconfig.h"
+#include "../src/mediacache.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+#include <libavutil/avutil.h>
+}
+
+namespace {
+
+// Decodes the whole file through swresample into the given layout/format,
+// like the engine (stereo S16) and the waveform (mono float) used to
+qint64 decodeSeparately(const QString& filePath, const AVChannelLayout& layout, AVSampleFormat format)
+{
+    AVFormatContext* formatContext = nullptr;
+    if (avformat_open_input(&formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        return -1;
+    }
+    avformat_find_stream_info(formatContext, nullptr);
+
+    const AVCodec* codec = nullptr;
+    const int streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+    if (streamIndex < 0) {
+        avformat_close_input(&formatContext);
+        return -1;
+    }
+
+    AVCodecContext* codecContext = avcodec_alloc_context3(codec);
+    avcodec_parameters_to_context(codecContext, formatContext->streams[streamIndex]->codecpar);
+    avcodec_open2(codecContext, codec, nullptr);
+
+    SwrContext* swrContext = nullptr;
+    swr_alloc_set_opts2(&swrContext, &layout, format, codecContext->sample_rate,
+                        &codecContext->ch_layout, codecContext->sample_fmt, codecContext->sample_rate, 0, nullptr);
+    swr_init(swrContext);
+
+    AVPacket* packet = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+    std::vector<uint8_t> output;
+    qint64 frames = 0;
+    const int bytesPerFrame = layout.nb_channels * av_get_bytes_per_sample(format);
+
+    while (av_read_frame(formatContext, packet) >= 0) {
+        if (packet->stream_index == streamIndex && avcodec_send_packet(codecContext, packet) >= 0) {
+            while (avcodec_receive_frame(codecContext, frame) >= 0) {
+                const int outSamples = swr_get_out_samples(swrContext, frame->nb_samples);
+                const size_t offset = output.size();
+                output.resize(offset + static_cast<size_t>(outSamples) * bytesPerFrame);
+                uint8_t* destination = output.data() + offset;
+                const int converted = swr_convert(swrContext, &destination, outSamples,
+                                                  const_cast<const uint8_t**>(frame->extended_data), frame->nb_samples);
+                output.resize(offset + static_cast<size_t>(std::max(0, converted)) * bytesPerFrame);
+                frames += std::max(0, converted);
+            }
+        }
+        av_packet_unref(packet);
+    }
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    swr_free(&swrContext);
+    avcodec_free_context(&codecContext);
+    avformat_close_input(&formatContext);
+    return frames;
+}
+
+double probeDuration(const QString& filePath)
+{
+    AVFormatContext* formatContext = nullptr;
+    if (avformat_open_input(&formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        return -1.0;
+    }
+    avformat_find_stream_info(formatContext, nullptr);
+    const double duration = formatContext->duration != AV_NOPTS_VALUE
+                                ? static_cast<double>(formatContext->duration) / AV_TIME_BASE : -1.0;
+    avformat_close_input(&formatContext);
+    return duration;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <audio file> [runs]\n", argv[0]);
+        return 1;
+    }
+
+    const QString filePath = QString::fromLocal8Bit(argv[1]);
+    const int runs = argc > 2 ? std::max(1, atoi(argv[2])) : 3;
+
+    const QString absolutePath = QFileInfo(filePath).absoluteFilePath();
+    const int sampleRate = AppConfig::instance().getSampleRate();
+
+    double separateBest = 0.0;
+    double cachedBest = 0.0;
+    double reloadBest = 0.0;
+    double peakReloadBest = 0.0;
+
+    for (int run = 0; run < runs; ++run) {
+        QElapsedTimer timer;
+
+        timer.start();
+        const AVChannelLayout stereo = AV_CHANNEL_LAYOUT_STEREO;
+        const AVChannelLayout mono = AV_CHANNEL_LAYOUT_MONO;
+        const qint64 playbackFrames = decodeSeparately(filePath, stereo, AV_SAMPLE_FMT_S16);
+        const qint64 waveformFrames = decodeSeparately(filePath, mono, AV_SAMPLE_FMT_FLT);
+        const double probed = probeDuration(filePath);
+        const double separate = timer.nsecsElapsed() / 1.0e6;
+        if (playbackFrames < 0 || waveformFrames < 0 || probed < 0.0) {
+            std::fprintf(stderr, "could not decode %s\n", argv[1]);
+            return 1;
+        }
+
+        // Engine, timeline duration and waveform all ask the cache
+        MediaCache::instance().clear();
+        MediaCache::instance().diskCache().remove(absolutePath, sampleRate);
+        MediaCache::instance().peakCache().remove(absolutePath);
+        timer.start();
+        AudioResult result;
+        QSharedPointer<const DecodedMedia> media = MediaCache::instance().load(filePath, &result);
+        const double duration = MediaCache::instance().load(filePath)->durationSeconds();
+        const int peaks = MediaCache::instance().load(filePath)->peaks.levelSize(0);
+        const double cached = timer.nsecsElapsed() / 1.0e6;
+        if (!media) {
+            std::fprintf(stderr, "%s\n", qPrintable(result.getErrorMessage()));
+            return 1;
+        }
+
+        // Next session: the in-memory cache is empty, the disk entry is there
+        QThreadPool::globalInstance()->waitForDone();
+        MediaCache::instance().clear();
+        timer.start();
+        QSharedPointer<const DecodedMedia> reloaded = MediaCache::instance().load(filePath);
+        const double reload = timer.nsecsElapsed() / 1.0e6;
+
+        // Reopening a project: the timeline only needs the waveform
+        timer.start();
+        const PeakPyramid mappedPeaks = MediaCache::instance().peakCache().map(filePath);
+        const double peakReload = timer.nsecsElapsed() / 1.0e6;
+
+        std::printf("run %d: separate %.1f ms, cached %.1f ms, reload %.2f ms%s, peaks only %.2f ms%s"
+                    " (%.2fs, %d peaks, %.1f MiB PCM)\n",
+                    run + 1, separate, cached, reload, reloaded && reloaded->isMapped() ? "" : " [not mapped]",
+                    peakReload, mappedPeaks.isMapped() ? "" : " [not mapped]", duration, peaks,
+                    media->pcmBytes() / (1024.0 * 1024.0));
+
+        separateBest = run == 0 ? separate : std::min(separateBest, separate);
+        cachedBest = run == 0 ? cached : std::min(cachedBest, cached);
+        reloadBest = run == 0 ? reload : std::min(reloadBest, reload);
+        peakReloadBest = run == 0 ? peakReload : std::min(peakReloadBest, peakReload);
+    }
+
+    std::printf("\nbest of %d: separate %.1f ms, cached %.1f ms (%.2fx faster), reload %.2f ms, peaks only %.2f ms\n",
+                runs, separateBest, cachedBest, cachedBest > 0.0 ? separateBest / cachedBest : 0.0, reloadBest,
+                peakReloadBest);
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Mixer benchmark: plays one file on N tracks through AudioMixer, paced like
+// a real audio callback, and reports the DSP load (render time / real time).
+//
+// Usage: bench_mixer <audio file> [tracks=8] [seconds=10] [block frames=512]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "../src/audiomixer.h"
+#include "../src/transportclock.h"
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <audio file> [tracks] [seconds] [block frames]\n", argv[0]);
+        return 1;
+    }
+
+    const QString filePath = QString::fromLocal8Bit(argv[1]);
+    const int trackCount = argc > 2 ? std::max(1, atoi(argv[2])) : 8;
+    const int seconds = argc > 3 ? std::max(1, atoi(argv[3])) : 10;
+    const int blockFrames = argc > 4 ? std::max(32, atoi(argv[4])) : 512;
+    const int sampleRate = 48000;
+
+    TransportClock clock(sampleRate);
+    AudioMixer mixer(&clock);
+
+    MixerArrangement arrangement;
+    for (int i = 0; i < trackCount; ++i) {
+        MixerTrack track;
+        track.volume = 1.0f / trackCount;
+        track.pan = trackCount > 1 ? -1.0f + 2.0f * i / (trackCount - 1) : 0.0f;
+        arrangement.tracks.append(track);
+
+        MixerClip clip;
+        clip.id = static_cast<quintptr>(i + 1);
+        clip.filePath = filePath;
+        clip.startSeconds = 0.0;
+        clip.trackIndex = i;
+        arrangement.clips.append(clip);
+    }
+    mixer.setArrangement(arrangement);
+
+    if (!mixer.hasClips()) {
+        std::fprintf(stderr, "could not open %s\n", argv[1]);
+        return 1;
+    }
+
+    // Wait for every clip decoder to have its first block, like play() does
+    QElapsedTimer primeTimer;
+    primeTimer.start();
+    while (!mixer.isPrimed()) {
+        if (primeTimer.elapsed() > 5000) {
+            std::fprintf(stderr, "decoders did not produce audio within 5 s\n");
+            return 1;
+        }
+        QThread::msleep(1);
+    }
+    const double primeMs = primeTimer.nsecsElapsed() / 1.0e6;
+
+    std::vector<qint16> output(static_cast<size_t>(blockFrames) * AudioMixer::CHANNELS);
+    const qint64 blockNs = static_cast<qint64>(blockFrames) * 1000000000LL / sampleRate;
+    const qint64 totalBlocks = static_cast<qint64>(seconds) * sampleRate / blockFrames;
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 renderNs = 0;
+    qint64 worstNs = 0;
+
+    for (qint64 block = 0; block < totalBlocks && !mixer.finished(); ++block) {
+        const qint64 start = timer.nsecsElapsed();
+        mixer.render(output.data(), blockFrames);
+        clock.advance(blockFrames);
+        const qint64 elapsed = timer.nsecsElapsed() - start;
+        renderNs += elapsed;
+        worstNs = std::max(worstNs, elapsed);
+
+        // Pace like the audio hardware: the next callback comes one block later
+        const qint64 due = (block + 1) * blockNs;
+        const qint64 now = timer.nsecsElapsed();
+        if (due > now) {
+            QThread::usleep(static_cast<unsigned long>((due - now) / 1000));
+        }
+        mixer.collectGarbage();
+        mixer.updateWindow();
+    }
+
+    const double audioSeconds = clock.renderFrame() / static_cast<double>(sampleRate);
+    std::printf("tracks:            %d\n", trackCount);
+    std::printf("block:             %d frames (%.2f ms)\n", blockFrames, blockNs / 1.0e6);
+    std::printf("rendered:          %.2f s\n", audioSeconds);
+    std::printf("time to prime:     %.2f ms\n", primeMs);
+    std::printf("average DSP load:  %.2f %%\n", audioSeconds > 0 ? 100.0 * renderNs / 1.0e9 / audioSeconds : 0.0);
+    std::printf("worst block load:  %.2f %%\n", 100.0 * worstNs / blockNs);
+    std::printf("mixer DSP load:    %.2f %% (smoothed)\n", 100.0 * mixer.dspLoad());
+
+    mixer.clear();
+    mixer.collectGarbage();
+    return 0;
+}
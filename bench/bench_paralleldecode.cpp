@@ -0,0 +1,91 @@
+// Parallel decode benchmark: decodes a file serially and split into segments
+// decoded concurrently, reports the speedup and checks that both results are
+// bit-identical (and, if not, where the first difference is).
+//
+// Usage: bench_paralleldecode <audio file> [segments=cores] [sample rate=44100] [runs=3]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "../src/paralleldecoder.h"
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <audio file> [segments] [sample rate] [runs]\n", argv[0]);
+        return 1;
+    }
+
+    const QString filePath = QString::fromLocal8Bit(argv[1]);
+    const int segments = argc > 2 ? std::max(2, atoi(argv[2])) : QThread::idealThreadCount();
+    const int sampleRate = argc > 3 ? std::max(8000, atoi(argv[3])) : 44100;
+    const int runs = argc > 4 ? std::max(1, atoi(argv[4])) : 3;
+
+    QVector<float> serial;
+    QVector<float> parallel;
+    double serialBest = 0.0;
+    double parallelBest = 0.0;
+    int used = 1;
+
+    for (int run = 0; run < runs; ++run) {
+        QElapsedTimer timer;
+
+        timer.start();
+        AudioResult result = ParallelDecoder::decode(filePath, sampleRate, 1, &serial);
+        const double serialMs = timer.nsecsElapsed() / 1.0e6;
+        if (!result.isSuccess()) {
+            std::fprintf(stderr, "%s\n", qPrintable(result.getErrorMessage()));
+            return 1;
+        }
+
+        // Includes building the packet index the segments are planned from
+        timer.start();
+        result = ParallelDecoder::decode(filePath, sampleRate, segments, &parallel, &used);
+        const double parallelMs = timer.nsecsElapsed() / 1.0e6;
+        if (!result.isSuccess()) {
+            std::fprintf(stderr, "%s\n", qPrintable(result.getErrorMessage()));
+            return 1;
+        }
+
+        std::printf("run %d: serial %.1f ms, %d segments %.1f ms (%.2fx)\n", run + 1, serialMs, used, parallelMs,
+                    parallelMs > 0.0 ? serialMs / parallelMs : 0.0);
+        serialBest = run == 0 ? serialMs : std::min(serialBest, serialMs);
+        parallelBest = run == 0 ? parallelMs : std::min(parallelBest, parallelMs);
+    }
+
+    const qint64 frames = serial.size() / ParallelDecoder::CHANNELS;
+    std::printf("\n%lld frames at %d Hz, best of %d: serial %.1f ms, parallel %.1f ms, %.2fx on %d segments\n",
+                static_cast<long long>(frames), sampleRate, runs, serialBest, parallelBest,
+                parallelBest > 0.0 ? serialBest / parallelBest : 0.0, used);
+
+    if (used < 2) {
+        std::printf("note: decoded serially (file too short or not indexable)\n");
+    }
+
+    if (serial.size() != parallel.size()) {
+        std::printf("MISMATCH: serial has %lld frames, parallel %lld\n", static_cast<long long>(frames),
+                    static_cast<long long>(parallel.size() / ParallelDecoder::CHANNELS));
+        return 1;
+    }
+    if (std::memcmp(serial.constData(), parallel.constData(), serial.size() * sizeof(float)) != 0) {
+        qsizetype first = 0;
+        qsizetype differing = 0;
+        for (qsizetype i = serial.size() - 1; i >= 0; --i) {
+            if (std::memcmp(&serial[i], &parallel[i], sizeof(float)) != 0) {
+                first = i;
+                ++differing;
+            }
+        }
+        std::printf("MISMATCH: %lld samples differ, first at frame %lld\n", static_cast<long long>(differing),
+                    static_cast<long long>(first / ParallelDecoder::CHANNELS));
+        return 1;
+    }
+
+    std::printf("bit-exact: yes\n");
+    return 0;
+}
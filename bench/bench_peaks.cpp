@@ -0,0 +1,134 @@
+// Peak extraction benchmark: input bandwidth (GB/s of float32 PCM) of the
+// AudioKernels::peakStats kernel for each instruction set the CPU supports,
+// called per level-0 bucket as the waveform code does, and of building a
+// whole PeakPyramid with it. Results are checked against the scalar kernel.
+//
+// Usage: bench_peaks [seconds of stereo audio at 44.1 kHz=60] [passes=20]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+#include "../src/audiokernels.h"
+#include "../src/peakpyramid.h"
+
+using AudioKernels::InstructionSet;
+
+namespace {
+
+double gigabytesPerSecond(size_t bytes, int passes, const std::function<void()>& kernel)
+{
+    kernel(); // Warm up caches and the dispatch table
+    const auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        kernel();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds > 0.0 ? static_cast<double>(bytes) * passes / seconds / 1.0e9 : 0.0;
+}
+
+struct Stats {
+    float min = 0.0f;
+    float max = 0.0f;
+    double squares = 0.0;
+};
+
+// peakStats over every bucket, as PeakPyramid::build calls it
+std::vector<Stats> bucketStats(const std::vector<float>& samples)
+{
+    constexpr size_t bucketSamples = PeakPyramid::BASE_BUCKET_FRAMES * 2;
+    std::vector<Stats> stats((samples.size() + bucketSamples - 1) / bucketSamples);
+    for (size_t bucket = 0; bucket < stats.size(); ++bucket) {
+        const size_t first = bucket * bucketSamples;
+        Stats& s = stats[bucket];
+        AudioKernels::peakStats(samples.data() + first, std::min(bucketSamples, samples.size() - first), &s.min, &s.max,
+                                &s.squares);
+    }
+    return stats;
+}
+
+double maxDifference(const std::vector<Stats>& a, const std::vector<Stats>& b)
+{
+    // min/max must match exactly; sums only differ in the order they were added
+    double difference = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].min != b[i].min || a[i].max != b[i].max) {
+            return 1.0;
+        }
+        difference = std::max(difference, std::fabs(a[i].squares - b[i].squares) / std::max(1.0, a[i].squares));
+    }
+    return difference;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int seconds = argc > 1 ? std::max(1, atoi(argv[1])) : 60;
+    const int passes = argc > 2 ? std::max(1, atoi(argv[2])) : 20;
+    const qint64 frames = static_cast<qint64>(seconds) * 44100;
+
+    std::vector<float> samples(static_cast<size_t>(frames) * 2);
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (float& sample : samples) {
+        sample = distribution(random);
+    }
+    const size_t bytes = samples.size() * sizeof(float);
+
+    const InstructionSet sets[] = {
+        InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::NEON
+    };
+
+    std::printf("best instruction set: %s\n", AudioKernels::instructionSetName(AudioKernels::bestInstructionSet()));
+    std::printf("%d s of stereo float32 (%.1f MiB) x %d passes\n\n", seconds, bytes / (1024.0 * 1024.0), passes);
+    std::printf("%-12s %-8s %10s %9s %12s\n", "kernel", "isa", "GB/s", "speedup", "max diff");
+
+    AudioKernels::setInstructionSet(InstructionSet::Scalar);
+    const std::vector<Stats> reference = bucketStats(samples);
+    const PeakPyramid referencePyramid = PeakPyramid::build(samples.data(), frames);
+
+    bool mismatch = false;
+    double scalarStats = 0.0;
+    double scalarBuild = 0.0;
+    for (InstructionSet set : sets) {
+        if (!AudioKernels::setInstructionSet(set)) {
+            continue;
+        }
+
+        const double difference = maxDifference(reference, bucketStats(samples));
+        const double statsRate = gigabytesPerSecond(bytes, passes, [&] { bucketStats(samples); });
+        const PeakPyramid pyramid = PeakPyramid::build(samples.data(), frames);
+        const Peak overall = pyramid.overall();
+        const Peak expected = referencePyramid.overall();
+        const double buildDifference = overall.min == expected.min && overall.max == expected.max
+                                           ? std::fabs(overall.rms - expected.rms)
+                                           : 1.0;
+        const double buildRate = gigabytesPerSecond(bytes, passes, [&] { PeakPyramid::build(samples.data(), frames); });
+        if (set == InstructionSet::Scalar) {
+            scalarStats = statsRate;
+            scalarBuild = buildRate;
+        }
+
+        std::printf("%-12s %-8s %10.2f %8.2fx %12.3g\n", "peakStats", AudioKernels::instructionSetName(set), statsRate,
+                    scalarStats > 0.0 ? statsRate / scalarStats : 0.0, difference);
+        std::printf("%-12s %-8s %10.2f %8.2fx %12.3g\n", "pyramid", AudioKernels::instructionSetName(set), buildRate,
+                    scalarBuild > 0.0 ? buildRate / scalarBuild : 0.0, buildDifference);
+
+        if (difference > 1.0e-12 || buildDifference > 1.0e-6) {
+            mismatch = true;
+        }
+    }
+
+    AudioKernels::setInstructionSet(AudioKernels::bestInstructionSet());
+
+    if (mismatch) {
+        std::printf("MISMATCH: a SIMD kernel disagrees with the scalar fallback\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Seek benchmark: seeks AudioStreamDecoder to positions spread over a file,
+// reports the seek latency and checks that each seek lands on the right
+// sample by lining its output up against a serial decode of the whole file.
+// Returns non-zero if any seek is off.
+//
+// Seeking is counted from the stream's first sample, so run it on a file
+// whose stream starts at a non-zero timestamp (AAC in MP4 or ADTS, Ogg
+// Vorbis/Opus) as well as on one that starts at zero.
+//
+// Usage: bench_seek <audio file> [seeks=20]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "../src/audiostreamdecoder.h"
+#include "../src/paralleldecoder.h"
+
+static constexpr qint64 COMPARE_FRAMES = 4096;
+static constexpr qint64 MAX_LAG_FRAMES = 4096;     // Furthest misalignment looked for
+static constexpr double MIN_RMS = 1.0e-3;          // Quieter windows cannot be lined up
+static constexpr double MAX_ERROR_RATIO = 0.05;    // Residual vs. signal energy still counted as a match
+
+// Frame offset of decoded against reference around frame, and the residual
+// energy at that offset relative to the reference's
+static qint64 bestLag(const QVector<float>& reference, qint64 frame, const std::vector<float>& decoded, double* ratio)
+{
+    const qint64 referenceFrames = reference.size() / ParallelDecoder::CHANNELS;
+    const qint64 frames = static_cast<qint64>(decoded.size()) / ParallelDecoder::CHANNELS;
+
+    qint64 best = 0;
+    double bestError = -1.0;
+    double bestEnergy = 0.0;
+    for (qint64 lag = -MAX_LAG_FRAMES; lag <= MAX_LAG_FRAMES; ++lag) {
+        const qint64 start = frame + lag;
+        if (start < 0 || start + frames > referenceFrames) {
+            continue;
+        }
+        const float* ref = reference.constData() + start * ParallelDecoder::CHANNELS;
+        double error = 0.0;
+        double energy = 0.0;
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            const double d = decoded[i] - ref[i];
+            error += d * d;
+            energy += static_cast<double>(ref[i]) * ref[i];
+        }
+        if (bestError < 0.0 || error < bestError) {
+            bestError = error;
+            bestEnergy = energy;
+            best = lag;
+        }
+    }
+    *ratio = bestEnergy > 0.0 ? bestError / bestEnergy : 1.0;
+    return best;
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <audio file> [seeks]\n", argv[0]);
+        return 1;
+    }
+
+    const QString filePath = QString::fromLocal8Bit(argv[1]);
+    const int seeks = argc > 2 ? std::max(1, atoi(argv[2])) : 20;
+
+    // Native rate, so the comparison is not blurred by resampler state
+    AudioStreamDecoder decoder;
+    std::atomic<bool> indexed{false};
+    QObject::connect(&decoder, &AudioStreamDecoder::seekIndexReady, [&indexed]() { indexed = true; });
+    const AudioResult opened = decoder.open(filePath);
+    if (!opened.isSuccess()) {
+        std::fprintf(stderr, "%s\n", qPrintable(opened.getErrorMessage()));
+        return 1;
+    }
+    const int sampleRate = decoder.sampleRate();
+
+    QVector<float> reference;
+    const AudioResult result = ParallelDecoder::decode(filePath, sampleRate, 1, &reference);
+    if (!result.isSuccess()) {
+        std::fprintf(stderr, "%s\n", qPrintable(result.getErrorMessage()));
+        return 1;
+    }
+    const qint64 totalFrames = reference.size() / ParallelDecoder::CHANNELS;
+    if (totalFrames < 4 * (COMPARE_FRAMES + MAX_LAG_FRAMES)) {
+        std::fprintf(stderr, "file too short to check seeks (%lld frames)\n", static_cast<long long>(totalFrames));
+        return 1;
+    }
+
+    // Seeks are sample-exact once the index is built, which happens while the FIFO is full
+    QElapsedTimer indexTimer;
+    indexTimer.start();
+    while (!indexed) {
+        if (indexTimer.elapsed() > 30000) {
+            std::fprintf(stderr, "seek index not built within 30 s\n");
+            return 1;
+        }
+        QThread::msleep(1);
+    }
+    std::printf("%lld frames at %d Hz, indexed in %lld ms\n", static_cast<long long>(totalFrames), sampleRate,
+                static_cast<long long>(indexTimer.elapsed()));
+
+    std::vector<float> decoded(static_cast<size_t>(COMPARE_FRAMES) * ParallelDecoder::CHANNELS);
+    const qint64 span = totalFrames - COMPARE_FRAMES - 2 * MAX_LAG_FRAMES;
+    double worstMs = 0.0;
+    double totalMs = 0.0;
+    int checked = 0;
+    int failed = 0;
+
+    for (int i = 0; i < seeks; ++i) {
+        // Odd offsets so targets fall inside packets rather than on their edges
+        const qint64 target = MAX_LAG_FRAMES + span * i / seeks + 37 * i;
+
+        QElapsedTimer timer;
+        timer.start();
+        decoder.seekToFrame(target);
+        qint64 read = 0;
+        while (read < COMPARE_FRAMES) {
+            const qint64 n = decoder.readFrames(decoded.data() + read * ParallelDecoder::CHANNELS, COMPARE_FRAMES - read);
+            read += n;
+            if (n == 0) {
+                if (decoder.atEnd() || timer.elapsed() > 5000) {
+                    break;
+                }
+                QThread::usleep(100);
+            }
+        }
+        const double ms = timer.nsecsElapsed() / 1.0e6;
+        worstMs = std::max(worstMs, ms);
+        totalMs += ms;
+
+        if (read < COMPARE_FRAMES) {
+            std::printf("seek %lld: FAILED, only %lld frames\n", static_cast<long long>(target), static_cast<long long>(read));
+            ++failed;
+            continue;
+        }
+
+        double energy = 0.0;
+        const float* ref = reference.constData() + target * ParallelDecoder::CHANNELS;
+        for (size_t k = 0; k < decoded.size(); ++k) {
+            energy += static_cast<double>(ref[k]) * ref[k];
+        }
+        if (std::sqrt(energy / decoded.size()) < MIN_RMS) {
+            std::printf("seek %lld: %.2f ms, silent, not checked\n", static_cast<long long>(target), ms);
+            continue;
+        }
+
+        double ratio = 0.0;
+        const qint64 lag = bestLag(reference, target, decoded, &ratio);
+        ++checked;
+        if (lag != 0 || ratio > MAX_ERROR_RATIO) {
+            std::printf("seek %lld: %.2f ms, OFF by %lld frames (residual %.4f)\n", static_cast<long long>(target), ms,
+                        static_cast<long long>(lag), ratio);
+            ++failed;
+        } else {
+            std::printf("seek %lld: %.2f ms, exact (residual %.6f)\n", static_cast<long long>(target), ms, ratio);
+        }
+    }
+
+    std::printf("\n%d seeks, %d checked: mean %.2f ms, worst %.2f ms\n", seeks, checked, totalMs / seeks, worstMs);
+    if (failed > 0) {
+        std::printf("MISMATCH: %d seeks did not land on their target\n", failed);
+        return 1;
+    }
+    std::printf("sample-exact: yes\n");
+    return 0;
+}
@@ -0,0 +1,240 @@
+// Timeline paint benchmark: a TimelineWidget of N tracks and M clips of a
+// synthetic loop, shown offscreen and repainted frame by frame while it
+// scrolls, zooms and follows the playhead. Reports, per phase, the p50 and
+// p99 frame time and the clips drawn per frame. It also reports the
+// viewport pixels painted from the scene or blitted from the playhead band.
+//
+// A frame is one change of state followed by the repaint it causes, the
+// way the event loop would deliver it: only the dirty region is painted,
+// into the offscreen platform's backing store (a QImage). The loop is
+// written to a temporary WAV file and loaded like any import, so the
+// waveforms come through WaveformLoader and the tile cache as in the app.
+// Settings and caches are kept apart from the app's.
+//
+// Runs offscreen unless QT_QPA_PLATFORM says otherwise.
+//
+// Usage: bench_timeline_render [tracks=64] [clips=4096] [frames=300] [batched=0] [snapshot.png]
+
+#include <QApplication>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QLoggingCategory>
+#include <QScrollBar>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+#include "../src/appconfig.h"
+#include "../timelinewidget/audioitem.h"
+#include "../timelinewidget/timelineview.h"
+#include "../timelinewidget/timelinewidget.h"
+#include "../timelinewidget/track.h"
+
+namespace {
+
+constexpr int SAMPLE_RATE = 44100;
+constexpr double LOOP_SECONDS = 4.0;
+constexpr int WINDOW_WIDTH = 1920;
+constexpr int WINDOW_HEIGHT = 1080;
+constexpr int LOAD_TIMEOUT_MS = 120000;
+constexpr double FRAME_SECONDS = 1.0 / 60.0;
+constexpr int SCROLL_STEP = 30; // Pixels per frame, 1800 px/s at 60 Hz
+
+// Decaying noise bursts on every beat, stereo 16-bit
+bool writeLoop(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    const qint32 frames = static_cast<qint32>(LOOP_SECONDS * SAMPLE_RATE);
+    const qint32 dataBytes = frames * 2 * 2;
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData("RIFF", 4);
+    out << qint32(36 + dataBytes);
+    out.writeRawData("WAVEfmt ", 8);
+    out << qint32(16) << qint16(1) << qint16(2) << qint32(SAMPLE_RATE) << qint32(SAMPLE_RATE * 4) << qint16(4)
+        << qint16(16);
+    out.writeRawData("data", 4);
+    out << dataBytes;
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<double> noise(-1.0, 1.0);
+    const qint32 beatFrames = SAMPLE_RATE / 2;
+    for (qint32 frame = 0; frame < frames; ++frame) {
+        const double envelope = std::exp(-8.0 * (frame % beatFrames) / static_cast<double>(SAMPLE_RATE));
+        const double tone = 0.3 * std::sin(2.0 * M_PI * 110.0 * frame / SAMPLE_RATE);
+        for (int channel = 0; channel < 2; ++channel) {
+            const double value = envelope * (0.6 * noise(random) + tone);
+            out << static_cast<qint16>(qBound(-1.0, value, 1.0) * 32767);
+        }
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+struct PhaseResult {
+    std::vector<double> frameMs;
+    quint64 clipsPainted = 0;
+    qint64 scenePixels = 0;
+    qint64 blittedPixels = 0;
+};
+
+double percentile(std::vector<double> values, double fraction)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    return values[index];
+}
+
+// Applies each frame's change and delivers the repaint it causes
+PhaseResult runPhase(TimelineView* view, int frames, const std::function<void(int)>& step)
+{
+    PhaseResult result;
+    result.frameMs.reserve(frames);
+    QCoreApplication::processEvents(); // Nothing left over from the previous phase
+    view->resetRepaintStats();
+    const quint64 paintedBefore = AudioItem::paintedClipCount();
+
+    QElapsedTimer timer;
+    for (int frame = 0; frame < frames; ++frame) {
+        timer.start();
+        step(frame);
+        QCoreApplication::sendPostedEvents();
+        QCoreApplication::processEvents();
+        result.frameMs.push_back(timer.nsecsElapsed() / 1.0e6);
+    }
+
+    result.clipsPainted = AudioItem::paintedClipCount() - paintedBefore;
+    result.scenePixels = view->repaintStats().scenePixels;
+    result.blittedPixels = view->repaintStats().blittedPixels;
+    return result;
+}
+
+void print(const char* name, const PhaseResult& result)
+{
+    const double frames = std::max<size_t>(1, result.frameMs.size());
+    std::printf("%-9s %8.2f %8.2f %12.1f %16.0f %16.0f\n", name, percentile(result.frameMs, 0.5),
+                percentile(result.frameMs, 0.99), result.clipsPainted / frames, result.scenePixels / frames,
+                result.blittedPixels / frames);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int tracks = argc > 1 ? std::max(1, atoi(argv[1])) : 64;
+    const int clips = argc > 2 ? std::max(1, atoi(argv[2])) : 4096;
+    const int frames = argc > 3 ? std::max(1, atoi(argv[3])) : 300;
+    const bool batched = argc > 4 && atoi(argv[4]) != 0;
+    const QString snapshot = argc > 5 ? QString::fromLocal8Bit(argv[5]) : QString();
+
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("bench_timeline_render")); // Own settings and caches
+    QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false"));
+
+    QTemporaryDir directory;
+    const QString loop = directory.filePath(QStringLiteral("loop.wav"));
+    if (!directory.isValid() || !writeLoop(loop)) {
+        std::fprintf(stderr, "Could not write %s\n", qPrintable(loop));
+        return 1;
+    }
+
+    // The widget creates (scene height - track height) / track height tracks
+    AppConfig& config = AppConfig::instance();
+    config.setBatchedClips(batched);
+    config.setSceneHeight((tracks + 1) * config.getTrackHeight());
+
+    TimelineWidget widget;
+    widget.resize(WINDOW_WIDTH, WINDOW_HEIGHT);
+    widget.show();
+    TimelineView* view = widget.findChild<TimelineView*>();
+    if (!view || widget.getTrackCount() != tracks) {
+        std::fprintf(stderr, "Unexpected timeline layout\n");
+        return 1;
+    }
+
+    // A loop arrangement: clips laid end to end, round-robin over the tracks
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+    for (int clip = 0; clip < clips; ++clip) {
+        const QColor color = QColor::fromHsv((clip * 37) % 360, 160, 220);
+        widget.addAudioItemToTrack(loop, clip % tracks, color, (clip / tracks) * LOOP_SECONDS);
+    }
+    const auto loading = [&] {
+        for (Track* track : widget.tracks()) {
+            if (track->isSourceLoading(loop)) {
+                return true;
+            }
+            for (AudioItem* item : track->audioItems()) {
+                if (item->isLoading()) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    while (loading() && loadTimer.elapsed() < LOAD_TIMEOUT_MS) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+    }
+    if (loading()) {
+        std::fprintf(stderr, "Waveforms still loading after %d ms\n", LOAD_TIMEOUT_MS);
+        return 1;
+    }
+    const double loadMs = loadTimer.nsecsElapsed() / 1.0e6;
+
+    std::printf("%d tracks, %d %s clips of a %.0f s loop, %dx%d window; added and loaded in %.0f ms\n", tracks, clips,
+                batched ? "batched" : "item", LOOP_SECONDS, WINDOW_WIDTH, WINDOW_HEIGHT, loadMs);
+    std::printf("%d frames per phase\n\n", frames);
+    std::printf("%-9s %8s %8s %12s %16s %16s\n", "phase", "p50 ms", "p99 ms", "clips/frame", "scene px/frame",
+                "blitted px/frame");
+
+    QScrollBar* horizontal = view->horizontalScrollBar();
+    QScrollBar* vertical = view->verticalScrollBar();
+    const int anchorX = view->viewport()->width() / 2;
+
+    // Scroll right through the arrangement and down through the tracks, wrapping at the ends
+    print("scroll", runPhase(view, frames, [&](int frame) {
+        const int x = horizontal->value() + SCROLL_STEP;
+        horizontal->setValue(x > horizontal->maximum() ? 0 : x);
+        if (frame % 4 == 0) {
+            const int y = vertical->value() + SCROLL_STEP;
+            vertical->setValue(y > vertical->maximum() ? 0 : y);
+        }
+    }));
+
+    // Zoom in and out around the middle, 5 to 500 px/s and back every 120 frames
+    print("zoom", runPhase(view, frames, [&](int frame) {
+        const double decades = std::sin(2.0 * M_PI * frame / 120.0);
+        widget.setPixelsPerSecond(50.0 * std::pow(10.0, decades), anchorX);
+    }));
+
+    // Playback at the default zoom from the start; the view follows the playhead
+    widget.setPixelsPerSecond(TimeScale::DEFAULT_PIXELS_PER_SECOND, 0);
+    horizontal->setValue(0);
+    vertical->setValue(0);
+    print("playhead", runPhase(view, frames, [&](int frame) {
+        widget.setIndicatorPosition(frame * FRAME_SECONDS);
+    }));
+
+    if (!snapshot.isEmpty()) {
+        const QImage image = widget.grab().toImage();
+        if (!image.save(snapshot)) {
+            std::fprintf(stderr, "Could not save %s\n", qPrintable(snapshot));
+        }
+    }
+    return 0;
+}
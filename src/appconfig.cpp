@@ -39,6 +39,49 @@ void AppConfig::setDefaultAudioPath(const QString& path) {
     m_settings->setValue("audio/defaultPath", path);
 }
 
+// Decoded audio caches
+QString AppConfig::getPcmCachePath() const {
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pcm";
+    return m_settings->value("cache/pcmPath", defaultPath).toString();
+}
+
+void AppConfig::setPcmCachePath(const QString& path) {
+    m_settings->setValue("cache/pcmPath", path);
+}
+
+int AppConfig::getPcmCacheSizeMB() const {
+    return m_settings->value("cache/pcmSizeMB", DEFAULT_PCM_CACHE_SIZE_MB).toInt();
+}
+
+void AppConfig::setPcmCacheSizeMB(int megabytes) {
+    m_settings->setValue("cache/pcmSizeMB", megabytes);
+}
+
+int AppConfig::getMemoryCacheSizeMB() const {
+    return m_settings->value("cache/memorySizeMB", DEFAULT_MEMORY_CACHE_SIZE_MB).toInt();
+}
+
+void AppConfig::setMemoryCacheSizeMB(int megabytes) {
+    m_settings->setValue("cache/memorySizeMB", megabytes);
+}
+
+QString AppConfig::getPeakCachePath() const {
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/peaks";
+    return m_settings->value("cache/peakPath", defaultPath).toString();
+}
+
+void AppConfig::setPeakCachePath(const QString& path) {
+    m_settings->setValue("cache/peakPath", path);
+}
+
+int AppConfig::getPeakCacheSizeMB() const {
+    return m_settings->value("cache/peakSizeMB", DEFAULT_PEAK_CACHE_SIZE_MB).toInt();
+}
+
+void AppConfig::setPeakCacheSizeMB(int megabytes) {
+    m_settings->setValue("cache/peakSizeMB", megabytes);
+}
+
 // Timeline settings
 int AppConfig::getTrackHeight() const {
     return m_settings->value("timeline/trackHeight", DEFAULT_TRACK_HEIGHT).toInt();
@@ -72,6 +115,14 @@ void AppConfig::setTrackIdWidth(int width) {
     m_settings->setValue("timeline/trackIdWidth", width);
 }
 
+bool AppConfig::getBatchedClips() const {
+    return m_settings->value("timeline/batchedClips", DEFAULT_BATCHED_CLIPS).toBool();
+}
+
+void AppConfig::setBatchedClips(bool batched) {
+    m_settings->setValue("timeline/batchedClips", batched);
+}
+
 // Zoom settings
 qreal AppConfig::getZoomFactorX() const {
     return m_settings->value("zoom/factorX", DEFAULT_ZOOM_FACTOR).toReal();
@@ -19,6 +19,22 @@ public:
     QString getDefaultAudioPath() const;
     void setDefaultAudioPath(const QString& path);
     
+    // Decoded audio caches
+    QString getPcmCachePath() const;
+    void setPcmCachePath(const QString& path);
+    
+    int getPcmCacheSizeMB() const;
+    void setPcmCacheSizeMB(int megabytes);
+    
+    int getMemoryCacheSizeMB() const;
+    void setMemoryCacheSizeMB(int megabytes);
+    
+    QString getPeakCachePath() const;
+    void setPeakCachePath(const QString& path);
+    
+    int getPeakCacheSizeMB() const;
+    void setPeakCacheSizeMB(int megabytes);
+    
     // Timeline settings
     int getTrackHeight() const;
     void setTrackHeight(int height);
@@ -32,6 +48,11 @@ public:
     int getTrackIdWidth() const;
     void setTrackIdWidth(int width);
     
+    // Clips drawn by their track from a compact array instead of one scene
+    // item each; for arrangements with thousands of clips
+    bool getBatchedClips() const;
+    void setBatchedClips(bool batched);
+    
     // Zoom settings
     qreal getZoomFactorX() const;
     void setZoomFactorX(qreal factor);
@@ -57,10 +78,14 @@ private:
     // Default values
     static constexpr int DEFAULT_SAMPLE_RATE = 44100;
     static constexpr int DEFAULT_BUFFER_SIZE = 512;
+    static constexpr int DEFAULT_PCM_CACHE_SIZE_MB = 4096;
+    static constexpr int DEFAULT_MEMORY_CACHE_SIZE_MB = 1024;
+    static constexpr int DEFAULT_PEAK_CACHE_SIZE_MB = 256;
     static constexpr int DEFAULT_TRACK_HEIGHT = 50;
     static constexpr int DEFAULT_SCENE_WIDTH = 5000;
     static constexpr int DEFAULT_SCENE_HEIGHT = 1020;
     static constexpr int DEFAULT_TRACK_ID_WIDTH = 200;
+    static constexpr bool DEFAULT_BATCHED_CLIPS = false;
     static constexpr qreal DEFAULT_ZOOM_FACTOR = 1.0;
     static constexpr qreal DEFAULT_ZOOM_DELTA = 0.1;
 };
@@ -0,0 +1,10 @@
+#include "applog.h"
+
+Q_LOGGING_CATEGORY(lcAudioEngine, "musicapp.audio.engine")
+Q_LOGGING_CATEGORY(lcAudioDevice, "musicapp.audio.device")
+Q_LOGGING_CATEGORY(lcAudioMixer, "musicapp.audio.mixer")
+Q_LOGGING_CATEGORY(lcAudioDecoder, "musicapp.audio.decoder")
+Q_LOGGING_CATEGORY(lcTimeline, "musicapp.timeline")
+Q_LOGGING_CATEGORY(lcWaveform, "musicapp.timeline.waveform")
+Q_LOGGING_CATEGORY(lcTransport, "musicapp.transport")
+Q_LOGGING_CATEGORY(lcEventLoop, "musicapp.eventloop")
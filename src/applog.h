@@ -0,0 +1,82 @@
+#ifndef APPLOG_H
+#define APPLOG_H
+
+#include <QDebug>
+#include <QLoggingCategory>
+#include "realtimelog.h"
+
+// Logging categories, one per subsystem. Enable or silence them at runtime
+// with QT_LOGGING_RULES, e.g. QT_LOGGING_RULES="musicapp.audio.*.debug=true".
+Q_DECLARE_LOGGING_CATEGORY(lcAudioEngine)
+Q_DECLARE_LOGGING_CATEGORY(lcAudioDevice)
+Q_DECLARE_LOGGING_CATEGORY(lcAudioMixer)
+Q_DECLARE_LOGGING_CATEGORY(lcAudioDecoder)
+Q_DECLARE_LOGGING_CATEGORY(lcTimeline)
+Q_DECLARE_LOGGING_CATEGORY(lcWaveform)
+Q_DECLARE_LOGGING_CATEGORY(lcTransport)
+Q_DECLARE_LOGGING_CATEGORY(lcEventLoop)
+
+// Compile-time log level. Anything above it is compiled out entirely: the
+// statement is dead code and its arguments are never evaluated.
+#define MUSIC_APP_LOG_OFF 0
+#define MUSIC_APP_LOG_WARNING 1
+#define MUSIC_APP_LOG_INFO 2
+#define MUSIC_APP_LOG_DEBUG 3
+#define MUSIC_APP_LOG_TRACE 4 // Per-event/per-frame messages
+
+#ifndef MUSIC_APP_LOG_LEVEL
+#ifdef QT_NO_DEBUG
+#define MUSIC_APP_LOG_LEVEL MUSIC_APP_LOG_WARNING
+#else
+#define MUSIC_APP_LOG_LEVEL MUSIC_APP_LOG_DEBUG
+#endif
+#endif
+
+#if MUSIC_APP_LOG_LEVEL >= MUSIC_APP_LOG_WARNING
+#define LOG_WARNING(category) qCWarning(category)
+#else
+#define LOG_WARNING(category) while (false) qCWarning(category)
+#endif
+
+#if MUSIC_APP_LOG_LEVEL >= MUSIC_APP_LOG_INFO
+#define LOG_INFO(category) qCInfo(category)
+#else
+#define LOG_INFO(category) while (false) qCInfo(category)
+#endif
+
+#if MUSIC_APP_LOG_LEVEL >= MUSIC_APP_LOG_DEBUG
+#define LOG_DEBUG(category) qCDebug(category)
+#else
+#define LOG_DEBUG(category) while (false) qCDebug(category)
+#endif
+
+#if MUSIC_APP_LOG_LEVEL >= MUSIC_APP_LOG_TRACE
+#define LOG_TRACE(category) qCDebug(category)
+#else
+#define LOG_TRACE(category) while (false) qCDebug(category)
+#endif
+
+// Real-time-safe variants for the audio callback: a static message plus up to
+// RealtimeLog::MAX_ARGUMENTS numbers, queued without locking or allocating
+// and printed later by the RealtimeLog thread.
+#if MUSIC_APP_LOG_LEVEL >= MUSIC_APP_LOG_WARNING
+#define RT_LOG_WARNING(category, message, ...) \
+    do { \
+        if (category().isWarningEnabled()) \
+            RealtimeLog::instance().post(category(), QtWarningMsg, message, { __VA_ARGS__ }); \
+    } while (false)
+#else
+#define RT_LOG_WARNING(category, message, ...) do { } while (false)
+#endif
+
+#if MUSIC_APP_LOG_LEVEL >= MUSIC_APP_LOG_DEBUG
+#define RT_LOG_DEBUG(category, message, ...) \
+    do { \
+        if (category().isDebugEnabled()) \
+            RealtimeLog::instance().post(category(), QtDebugMsg, message, { __VA_ARGS__ }); \
+    } while (false)
+#else
+#define RT_LOG_DEBUG(category, message, ...) do { } while (false)
+#endif
+
+#endif // APPLOG_H
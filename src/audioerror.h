@@ -10,7 +10,8 @@ enum class AudioError {
     DecodingFailed,
     DeviceError,
     MemoryError,
-    InvalidParameters
+    InvalidParameters,
+    Cancelled
 };
 
 class AudioResult {
@@ -39,6 +40,7 @@ public:
             case AudioError::DeviceError: return "Audio device error";
             case AudioError::MemoryError: return "Memory allocation error";
             case AudioError::InvalidParameters: return "Invalid parameters";
+            case AudioError::Cancelled: return "Operation cancelled";
             default: return "Unknown error";
         }
     }
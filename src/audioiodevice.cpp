@@ -1,43 +1,99 @@
 #include "audioiodevice.h"
-#include "ffmpegaudioengine.h"
-#include <QDebug>
+#include "audiomixer.h"
+#include "transportclock.h"
+#include "applog.h"
+#include <QThread>
+#include <cstring>
 
-AudioIODevice::AudioIODevice(QBuffer* sourceBuffer, QObject* audioEngine, QObject* parent)
+AudioIODevice::AudioIODevice(AudioMixer* mixer, QObject* audioEngine, QObject* parent)
     : QIODevice(parent)
-    , m_sourceBuffer(sourceBuffer)
+    , m_mixer(mixer)
     , m_audioEngine(audioEngine)
+    , m_firstSoundPending(false)
+    , m_firstSoundDelivered(false)
+    , m_endOfStream(false)
+    , m_parked(true)
+    , m_rendering(false)
 {
-    qDebug() << "AudioIODevice: Constructor - source buffer size:" << (sourceBuffer ? sourceBuffer->size() : 0);
+    LOG_DEBUG(lcAudioDevice) << "AudioIODevice: Constructor - rendering from mixer:" << (mixer != nullptr);
     // Open in read-only mode for audio output
     open(QIODevice::ReadOnly);
-    qDebug() << "AudioIODevice: Opened in ReadOnly mode, isOpen():" << isOpen();
+    LOG_DEBUG(lcAudioDevice) << "AudioIODevice: Opened in ReadOnly mode, isOpen():" << isOpen();
 }
 
 qint64 AudioIODevice::readData(char* data, qint64 maxlen)
 {
-    // This is called by the audio hardware when it needs data
-    qDebug() << "AudioIODevice::readData called - hardware requesting" << maxlen << "bytes";
+    // Called by the audio hardware when it needs data. This runs on the
+    // audio thread: no locks, no allocation, and only RT_LOG_* logging.
+    if (!m_mixer) {
+        return 0;
+    }
+    
+    const qint64 frameBytes = AudioMixer::CHANNELS * sizeof(qint16);
+    const int frames = static_cast<int>(maxlen / frameBytes);
     
-    if (!m_sourceBuffer || !m_sourceBuffer->isOpen()) {
-        qDebug() << "AudioIODevice: Source buffer not available or not open";
+    // Pairs with park(): one of the two sees the other's store
+    m_rendering.store(true);
+    if (m_parked.load()) {
+        m_rendering.store(false, std::memory_order_release);
+        std::memset(data, 0, static_cast<size_t>(frames * frameBytes));
+        return frames * frameBytes;
+    }
+    
+    // Check if we've reached the end of the arrangement
+    if (m_mixer->finished()) {
+        m_rendering.store(false, std::memory_order_release);
+        m_endOfStream.store(true, std::memory_order_release);
         return 0;
     }
     
-    // Read data from our source buffer
-    qint64 bytesRead = m_sourceBuffer->read(data, maxlen);
-    qDebug() << "AudioIODevice: Read" << bytesRead << "bytes from source buffer";
-    qDebug() << "AudioIODevice: Source buffer position:" << m_sourceBuffer->pos() << "/ size:" << m_sourceBuffer->size();
+    // Render whole frames of the mix straight into the device buffer
+    m_mixer->render(reinterpret_cast<qint16*>(data), frames);
+    qint64 bytesRead = frames * frameBytes;
+    
+    // Advance the transport clock by exactly what the sink received
+    m_mixer->clock()->advance(frames);
+    m_rendering.store(false, std::memory_order_release);
     
-    // Check if we've reached the end
-    if (bytesRead == 0 && m_sourceBuffer->atEnd()) {
-        qDebug() << "AudioIODevice: Reached end of source buffer - signaling completion";
-        // Signal the engine that playback is complete
-        QMetaObject::invokeMethod(m_audioEngine, "onPlaybackComplete", Qt::QueuedConnection);
+    if (bytesRead > 0 && m_firstSoundPending.load(std::memory_order_relaxed)) {
+        m_firstSoundPending.store(false, std::memory_order_relaxed);
+        m_firstSoundDelivered.store(true, std::memory_order_release);
+        RT_LOG_DEBUG(lcAudioDevice, "AudioIODevice: First block delivered, frames:", static_cast<double>(frames));
     }
     
     return bytesRead;
 }
 
+void AudioIODevice::park()
+{
+    m_parked.store(true);
+    while (m_rendering.load()) {
+        QThread::yieldCurrentThread();
+    }
+}
+
+void AudioIODevice::unpark()
+{
+    m_parked.store(false, std::memory_order_release);
+}
+
+void AudioIODevice::armFirstSoundProbe()
+{
+    m_firstSoundDelivered = false;
+    m_endOfStream = false;
+    m_firstSoundPending = true;
+}
+
+bool AudioIODevice::takeFirstSoundDelivered()
+{
+    return m_firstSoundDelivered.exchange(false, std::memory_order_acquire);
+}
+
+bool AudioIODevice::takeEndOfStream()
+{
+    return m_endOfStream.exchange(false, std::memory_order_acquire);
+}
+
 qint64 AudioIODevice::writeData(const char* data, qint64 len)
 {
     // Not used for audio output
@@ -48,14 +104,11 @@ qint64 AudioIODevice::writeData(const char* data, qint64 len)
 
 qint64 AudioIODevice::bytesAvailable() const
 {
-    if (!m_sourceBuffer || !m_sourceBuffer->isOpen()) {
-        return 0;
+    if (!m_mixer || m_mixer->finished()) {
+        return QIODevice::bytesAvailable();
     }
     
-    qint64 available = m_sourceBuffer->bytesAvailable();
-    // Remove excessive logging - only log when there's actually data
-    if (available > 0) {
-        qDebug() << "AudioIODevice::bytesAvailable() returning:" << available;
-    }
-    return available;
+    // The mixer renders on demand, so one second of audio is always available
+    qint64 available = m_mixer->sampleRate() * AudioMixer::CHANNELS * sizeof(qint16);
+    return available + QIODevice::bytesAvailable();
 }
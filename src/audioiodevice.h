@@ -2,9 +2,9 @@
 #define AUDIOIODEVICE_H
 
 #include <QIODevice>
-#include <QBuffer>
+#include <atomic>
 
-class FFmpegAudioEngine;
+class AudioMixer;
 
 // Custom QIODevice that provides hardware-driven audio streaming
 class AudioIODevice : public QIODevice
@@ -12,11 +12,27 @@ class AudioIODevice : public QIODevice
     Q_OBJECT
 
 public:
-    explicit AudioIODevice(QBuffer* sourceBuffer, QObject* audioEngine, QObject* parent = nullptr);
+    explicit AudioIODevice(AudioMixer* mixer, QObject* audioEngine, QObject* parent = nullptr);
     
     // Make bytesAvailable public so FFmpegAudioEngine can access it
     qint64 bytesAvailable() const override;
 
+    // Report the next non-empty read back to the engine (time-to-first-sound)
+    void armFirstSoundProbe();
+
+    // Events raised by the audio callback; polled by the engine's position
+    // timer so the callback never has to post events or allocate
+    bool takeFirstSoundDelivered();
+    bool takeEndOfStream();
+
+    // GUI thread. While parked, the callback outputs silence without touching
+    // the mixer or the clock. park() returns once a callback that was already
+    // rendering has finished, so the transport can then be relocated safely;
+    // suspending or stopping the sink does not promise that. The device starts
+    // parked.
+    void park();
+    void unpark();
+
 protected:
     // QIODevice interface - called by audio hardware when it needs data
     qint64 readData(char* data, qint64 maxlen) override;
@@ -24,8 +40,13 @@ protected:
     bool isSequential() const override { return true; }
 
 private:
-    QBuffer* m_sourceBuffer;
+    AudioMixer* m_mixer;
     QObject* m_audioEngine;
+    std::atomic<bool> m_firstSoundPending;
+    std::atomic<bool> m_firstSoundDelivered;
+    std::atomic<bool> m_endOfStream;
+    std::atomic<bool> m_parked;
+    std::atomic<bool> m_rendering; // The callback is inside the mixer
 };
 
 #endif // AUDIOIODEVICE_H
@@ -0,0 +1,687 @@
+#include "audiokernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define AUDIO_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define AUDIO_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC/Clang only emit AVX2 instructions inside functions compiled for it;
+// MSVC accepts the intrinsics anywhere
+#if defined(AUDIO_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AUDIO_KERNELS_AVX2 __attribute__((target("avx2")))
+#else
+#define AUDIO_KERNELS_AVX2
+#endif
+
+namespace AudioKernels {
+
+namespace {
+
+constexpr float S16_SCALE = 32768.0f;
+constexpr float S32_SCALE = 2147483648.0f;
+constexpr float S16_MAX = 32767.0f;
+constexpr float S32_MAX = 2147483520.0f; // Largest float below 2^31
+
+struct KernelTable {
+    void (*s16ToFloat)(const qint16*, float*, size_t);
+    void (*s32ToFloat)(const qint32*, float*, size_t);
+    void (*floatToS16)(const float*, qint16*, size_t);
+    void (*floatToS32)(const float*, qint32*, size_t);
+    void (*applyGain)(float*, float, size_t);
+    void (*mixAdd)(const float*, float*, size_t);
+    void (*mixStereo)(const float*, float*, size_t, float, float);
+    void (*peakStats)(const float*, size_t, float*, float*, double*);
+};
+
+// ---------------------------------------------------------------------------
+// Scalar
+// ---------------------------------------------------------------------------
+
+void s16ToFloatScalar(const qint16* source, float* destination, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        destination[i] = source[i] * (1.0f / S16_SCALE);
+    }
+}
+
+void s32ToFloatScalar(const qint32* source, float* destination, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        destination[i] = static_cast<float>(source[i]) * (1.0f / S32_SCALE);
+    }
+}
+
+void floatToS16Scalar(const float* source, qint16* destination, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float sample = std::min(std::max(source[i] * S16_SCALE, -S16_SCALE), S16_MAX);
+        destination[i] = static_cast<qint16>(std::lrint(sample));
+    }
+}
+
+void floatToS32Scalar(const float* source, qint32* destination, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float sample = std::min(std::max(source[i] * S32_SCALE, -S32_SCALE), S32_MAX);
+        destination[i] = static_cast<qint32>(std::lrint(sample));
+    }
+}
+
+void applyGainScalar(float* buffer, float gain, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        buffer[i] *= gain;
+    }
+}
+
+void mixAddScalar(const float* source, float* destination, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        destination[i] += source[i];
+    }
+}
+
+void mixStereoScalar(const float* source, float* destination, size_t frames, float gainLeft, float gainRight)
+{
+    for (size_t i = 0; i < frames; ++i) {
+        destination[2 * i] += source[2 * i] * gainLeft;
+        destination[2 * i + 1] += source[2 * i + 1] * gainRight;
+    }
+}
+
+void peakStatsScalar(const float* samples, size_t count, float* minimum, float* maximum, double* sumOfSquares)
+{
+    float low = count > 0 ? samples[0] : 0.0f;
+    float high = low;
+    double squares = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        low = std::min(low, samples[i]);
+        high = std::max(high, samples[i]);
+        squares += static_cast<double>(samples[i]) * samples[i];
+    }
+    *minimum = low;
+    *maximum = high;
+    *sumOfSquares = squares;
+}
+
+// Folds the scalar tail into a SIMD result
+void finishPeakStats(const float* samples, size_t count, float low, float high, double squares,
+                     float* minimum, float* maximum, double* sumOfSquares)
+{
+    float tailLow, tailHigh;
+    double tailSquares;
+    peakStatsScalar(samples, count, &tailLow, &tailHigh, &tailSquares);
+    *minimum = count > 0 ? std::min(low, tailLow) : low;
+    *maximum = count > 0 ? std::max(high, tailHigh) : high;
+    *sumOfSquares = squares + tailSquares;
+}
+
+const KernelTable SCALAR_KERNELS = {
+    s16ToFloatScalar, s32ToFloatScalar, floatToS16Scalar, floatToS32Scalar,
+    applyGainScalar, mixAddScalar, mixStereoScalar, peakStatsScalar
+};
+
+#if defined(AUDIO_KERNELS_X86)
+
+// ---------------------------------------------------------------------------
+// SSE2 (baseline on x86-64)
+// ---------------------------------------------------------------------------
+
+void s16ToFloatSse2(const qint16* source, float* destination, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / S16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        // Sign-extend by unpacking into the high half and shifting back down
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(destination + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+    s16ToFloatScalar(source + i, destination + i, count - i);
+}
+
+void s32ToFloatSse2(const qint32* source, float* destination, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / S32_SCALE);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+    }
+    s32ToFloatScalar(source + i, destination + i, count - i);
+}
+
+void floatToS16Sse2(const float* source, qint16* destination, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(S16_SCALE);
+    const __m128 minimum = _mm_set1_ps(-S16_SCALE);
+    const __m128 maximum = _mm_set1_ps(S16_MAX);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(source + i), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(source + i + 4), scale);
+        a = _mm_min_ps(_mm_max_ps(a, minimum), maximum);
+        b = _mm_min_ps(_mm_max_ps(b, minimum), maximum);
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+    }
+    floatToS16Scalar(source + i, destination + i, count - i);
+}
+
+void floatToS32Sse2(const float* source, qint32* destination, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(S32_SCALE);
+    const __m128 minimum = _mm_set1_ps(-S32_SCALE);
+    const __m128 maximum = _mm_set1_ps(S32_MAX);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(source + i), scale);
+        a = _mm_min_ps(_mm_max_ps(a, minimum), maximum);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_cvtps_epi32(a));
+    }
+    floatToS32Scalar(source + i, destination + i, count - i);
+}
+
+void applyGainSse2(float* buffer, float gain, size_t count)
+{
+    const __m128 factor = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_loadu_ps(buffer + i), factor));
+    }
+    applyGainScalar(buffer + i, gain, count - i);
+}
+
+void mixAddSse2(const float* source, float* destination, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_loadu_ps(source + i)));
+    }
+    mixAddScalar(source + i, destination + i, count - i);
+}
+
+void mixStereoSse2(const float* source, float* destination, size_t frames, float gainLeft, float gainRight)
+{
+    const __m128 gains = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+    size_t i = 0;
+    for (; i + 2 <= frames; i += 2) {
+        const __m128 weighted = _mm_mul_ps(_mm_loadu_ps(source + 2 * i), gains);
+        _mm_storeu_ps(destination + 2 * i, _mm_add_ps(_mm_loadu_ps(destination + 2 * i), weighted));
+    }
+    mixStereoScalar(source + 2 * i, destination + 2 * i, frames - i, gainLeft, gainRight);
+}
+
+void peakStatsSse2(const float* samples, size_t count, float* minimum, float* maximum, double* sumOfSquares)
+{
+    if (count < 4) {
+        peakStatsScalar(samples, count, minimum, maximum, sumOfSquares);
+        return;
+    }
+
+    __m128 low = _mm_loadu_ps(samples);
+    __m128 high = low;
+    __m128d squaresLow = _mm_setzero_pd();
+    __m128d squaresHigh = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 values = _mm_loadu_ps(samples + i);
+        low = _mm_min_ps(low, values);
+        high = _mm_max_ps(high, values);
+        const __m128d first = _mm_cvtps_pd(values);
+        const __m128d second = _mm_cvtps_pd(_mm_movehl_ps(values, values));
+        squaresLow = _mm_add_pd(squaresLow, _mm_mul_pd(first, first));
+        squaresHigh = _mm_add_pd(squaresHigh, _mm_mul_pd(second, second));
+    }
+
+    float lows[4], highs[4];
+    double squares[2];
+    _mm_storeu_ps(lows, low);
+    _mm_storeu_ps(highs, high);
+    _mm_storeu_pd(squares, _mm_add_pd(squaresLow, squaresHigh));
+    finishPeakStats(samples + i, count - i, std::min(std::min(lows[0], lows[1]), std::min(lows[2], lows[3])),
+                    std::max(std::max(highs[0], highs[1]), std::max(highs[2], highs[3])), squares[0] + squares[1],
+                    minimum, maximum, sumOfSquares);
+}
+
+const KernelTable SSE2_KERNELS = {
+    s16ToFloatSse2, s32ToFloatSse2, floatToS16Sse2, floatToS32Sse2,
+    applyGainSse2, mixAddSse2, mixStereoSse2, peakStatsSse2
+};
+
+// ---------------------------------------------------------------------------
+// AVX2
+// ---------------------------------------------------------------------------
+
+AUDIO_KERNELS_AVX2 void s16ToFloatAvx2(const qint16* source, float* destination, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / S16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        const __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(samples));
+        _mm256_storeu_ps(destination + i, _mm256_mul_ps(values, scale));
+    }
+    s16ToFloatScalar(source + i, destination + i, count - i);
+}
+
+AUDIO_KERNELS_AVX2 void s32ToFloatAvx2(const qint32* source, float* destination, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / S32_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        _mm256_storeu_ps(destination + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+    }
+    s32ToFloatScalar(source + i, destination + i, count - i);
+}
+
+AUDIO_KERNELS_AVX2 void floatToS16Avx2(const float* source, qint16* destination, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(S16_SCALE);
+    const __m256 minimum = _mm256_set1_ps(-S16_SCALE);
+    const __m256 maximum = _mm256_set1_ps(S16_MAX);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(source + i), scale);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(source + i + 8), scale);
+        a = _mm256_min_ps(_mm256_max_ps(a, minimum), maximum);
+        b = _mm256_min_ps(_mm256_max_ps(b, minimum), maximum);
+        // packs works per 128-bit lane; restore sample order afterwards
+        const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        const __m256i ordered = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), ordered);
+    }
+    floatToS16Scalar(source + i, destination + i, count - i);
+}
+
+AUDIO_KERNELS_AVX2 void floatToS32Avx2(const float* source, qint32* destination, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(S32_SCALE);
+    const __m256 minimum = _mm256_set1_ps(-S32_SCALE);
+    const __m256 maximum = _mm256_set1_ps(S32_MAX);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(source + i), scale);
+        a = _mm256_min_ps(_mm256_max_ps(a, minimum), maximum);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_cvtps_epi32(a));
+    }
+    floatToS32Scalar(source + i, destination + i, count - i);
+}
+
+AUDIO_KERNELS_AVX2 void applyGainAvx2(float* buffer, float gain, size_t count)
+{
+    const __m256 factor = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(buffer + i, _mm256_mul_ps(_mm256_loadu_ps(buffer + i), factor));
+    }
+    applyGainScalar(buffer + i, gain, count - i);
+}
+
+AUDIO_KERNELS_AVX2 void mixAddAvx2(const float* source, float* destination, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(destination + i, _mm256_add_ps(_mm256_loadu_ps(destination + i), _mm256_loadu_ps(source + i)));
+    }
+    mixAddScalar(source + i, destination + i, count - i);
+}
+
+AUDIO_KERNELS_AVX2 void mixStereoAvx2(const float* source, float* destination, size_t frames, float gainLeft, float gainRight)
+{
+    const __m256 gains = _mm256_setr_ps(gainLeft, gainRight, gainLeft, gainRight,
+                                        gainLeft, gainRight, gainLeft, gainRight);
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m256 weighted = _mm256_mul_ps(_mm256_loadu_ps(source + 2 * i), gains);
+        _mm256_storeu_ps(destination + 2 * i, _mm256_add_ps(_mm256_loadu_ps(destination + 2 * i), weighted));
+    }
+    mixStereoScalar(source + 2 * i, destination + 2 * i, frames - i, gainLeft, gainRight);
+}
+
+AUDIO_KERNELS_AVX2 void peakStatsAvx2(const float* samples, size_t count, float* minimum, float* maximum,
+                                      double* sumOfSquares)
+{
+    if (count < 8) {
+        peakStatsScalar(samples, count, minimum, maximum, sumOfSquares);
+        return;
+    }
+
+    __m256 low = _mm256_loadu_ps(samples);
+    __m256 high = low;
+    __m256d squaresLow = _mm256_setzero_pd();
+    __m256d squaresHigh = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 values = _mm256_loadu_ps(samples + i);
+        low = _mm256_min_ps(low, values);
+        high = _mm256_max_ps(high, values);
+        const __m256d first = _mm256_cvtps_pd(_mm256_castps256_ps128(values));
+        const __m256d second = _mm256_cvtps_pd(_mm256_extractf128_ps(values, 1));
+        squaresLow = _mm256_add_pd(squaresLow, _mm256_mul_pd(first, first));
+        squaresHigh = _mm256_add_pd(squaresHigh, _mm256_mul_pd(second, second));
+    }
+
+    const __m128 low4 = _mm_min_ps(_mm256_castps256_ps128(low), _mm256_extractf128_ps(low, 1));
+    const __m128 high4 = _mm_max_ps(_mm256_castps256_ps128(high), _mm256_extractf128_ps(high, 1));
+    const __m256d squares4 = _mm256_add_pd(squaresLow, squaresHigh);
+    const __m128d squares2 = _mm_add_pd(_mm256_castpd256_pd128(squares4), _mm256_extractf128_pd(squares4, 1));
+    // Called once per short bucket from SSE code: leaving the upper halves
+    // dirty across the scalar tail and the return costs more than the loop
+    _mm256_zeroupper();
+    float lows[4], highs[4];
+    double squares[2];
+    _mm_storeu_ps(lows, low4);
+    _mm_storeu_ps(highs, high4);
+    _mm_storeu_pd(squares, squares2);
+    finishPeakStats(samples + i, count - i, std::min(std::min(lows[0], lows[1]), std::min(lows[2], lows[3])),
+                    std::max(std::max(highs[0], highs[1]), std::max(highs[2], highs[3])), squares[0] + squares[1],
+                    minimum, maximum, sumOfSquares);
+}
+
+const KernelTable AVX2_KERNELS = {
+    s16ToFloatAvx2, s32ToFloatAvx2, floatToS16Avx2, floatToS32Avx2,
+    applyGainAvx2, mixAddAvx2, mixStereoAvx2, peakStatsAvx2
+};
+
+bool cpuHasAvx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // The OS must save the YMM registers on context switches
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#endif
+}
+
+#endif // AUDIO_KERNELS_X86
+
+#if defined(AUDIO_KERNELS_NEON)
+
+// ---------------------------------------------------------------------------
+// NEON (AArch64)
+// ---------------------------------------------------------------------------
+
+void s16ToFloatNeon(const qint16* source, float* destination, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t samples = vld1q_s16(source + i);
+        const float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+        const float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+        vst1q_f32(destination + i, vmulq_n_f32(low, 1.0f / S16_SCALE));
+        vst1q_f32(destination + i + 4, vmulq_n_f32(high, 1.0f / S16_SCALE));
+    }
+    s16ToFloatScalar(source + i, destination + i, count - i);
+}
+
+void s32ToFloatNeon(const qint32* source, float* destination, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t values = vcvtq_f32_s32(vld1q_s32(source + i));
+        vst1q_f32(destination + i, vmulq_n_f32(values, 1.0f / S32_SCALE));
+    }
+    s32ToFloatScalar(source + i, destination + i, count - i);
+}
+
+void floatToS16Neon(const float* source, qint16* destination, size_t count)
+{
+    const float32x4_t minimum = vdupq_n_f32(-S16_SCALE);
+    const float32x4_t maximum = vdupq_n_f32(S16_MAX);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vmulq_n_f32(vld1q_f32(source + i), S16_SCALE);
+        float32x4_t b = vmulq_n_f32(vld1q_f32(source + i + 4), S16_SCALE);
+        a = vminq_f32(vmaxq_f32(a, minimum), maximum);
+        b = vminq_f32(vmaxq_f32(b, minimum), maximum);
+        const int16x8_t packed = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b)));
+        vst1q_s16(destination + i, packed);
+    }
+    floatToS16Scalar(source + i, destination + i, count - i);
+}
+
+void floatToS32Neon(const float* source, qint32* destination, size_t count)
+{
+    const float32x4_t minimum = vdupq_n_f32(-S32_SCALE);
+    const float32x4_t maximum = vdupq_n_f32(S32_MAX);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t a = vmulq_n_f32(vld1q_f32(source + i), S32_SCALE);
+        a = vminq_f32(vmaxq_f32(a, minimum), maximum);
+        vst1q_s32(destination + i, vcvtnq_s32_f32(a));
+    }
+    floatToS32Scalar(source + i, destination + i, count - i);
+}
+
+void applyGainNeon(float* buffer, float gain, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(buffer + i, vmulq_n_f32(vld1q_f32(buffer + i), gain));
+    }
+    applyGainScalar(buffer + i, gain, count - i);
+}
+
+void mixAddNeon(const float* source, float* destination, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(destination + i, vaddq_f32(vld1q_f32(destination + i), vld1q_f32(source + i)));
+    }
+    mixAddScalar(source + i, destination + i, count - i);
+}
+
+void mixStereoNeon(const float* source, float* destination, size_t frames, float gainLeft, float gainRight)
+{
+    const float gainValues[4] = { gainLeft, gainRight, gainLeft, gainRight };
+    const float32x4_t gains = vld1q_f32(gainValues);
+    size_t i = 0;
+    for (; i + 2 <= frames; i += 2) {
+        const float32x4_t weighted = vmulq_f32(vld1q_f32(source + 2 * i), gains);
+        vst1q_f32(destination + 2 * i, vaddq_f32(vld1q_f32(destination + 2 * i), weighted));
+    }
+    mixStereoScalar(source + 2 * i, destination + 2 * i, frames - i, gainLeft, gainRight);
+}
+
+void peakStatsNeon(const float* samples, size_t count, float* minimum, float* maximum, double* sumOfSquares)
+{
+    if (count < 4) {
+        peakStatsScalar(samples, count, minimum, maximum, sumOfSquares);
+        return;
+    }
+
+    float32x4_t low = vld1q_f32(samples);
+    float32x4_t high = low;
+    float64x2_t squaresLow = vdupq_n_f64(0.0);
+    float64x2_t squaresHigh = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t values = vld1q_f32(samples + i);
+        low = vminq_f32(low, values);
+        high = vmaxq_f32(high, values);
+        const float64x2_t first = vcvt_f64_f32(vget_low_f32(values));
+        const float64x2_t second = vcvt_high_f64_f32(values);
+        squaresLow = vaddq_f64(squaresLow, vmulq_f64(first, first));
+        squaresHigh = vaddq_f64(squaresHigh, vmulq_f64(second, second));
+    }
+
+    finishPeakStats(samples + i, count - i, vminvq_f32(low), vmaxvq_f32(high),
+                    vaddvq_f64(vaddq_f64(squaresLow, squaresHigh)), minimum, maximum, sumOfSquares);
+}
+
+const KernelTable NEON_KERNELS = {
+    s16ToFloatNeon, s32ToFloatNeon, floatToS16Neon, floatToS32Neon,
+    applyGainNeon, mixAddNeon, mixStereoNeon, peakStatsNeon
+};
+
+#endif // AUDIO_KERNELS_NEON
+
+const KernelTable* tableFor(InstructionSet set)
+{
+    switch (set) {
+#if defined(AUDIO_KERNELS_X86)
+    case InstructionSet::SSE2:
+        return &SSE2_KERNELS;
+    case InstructionSet::AVX2:
+        return &AVX2_KERNELS;
+#endif
+#if defined(AUDIO_KERNELS_NEON)
+    case InstructionSet::NEON:
+        return &NEON_KERNELS;
+#endif
+    default:
+        return &SCALAR_KERNELS;
+    }
+}
+
+InstructionSet detectInstructionSet()
+{
+#if defined(AUDIO_KERNELS_X86)
+    return cpuHasAvx2() ? InstructionSet::AVX2 : InstructionSet::SSE2;
+#elif defined(AUDIO_KERNELS_NEON)
+    return InstructionSet::NEON;
+#else
+    return InstructionSet::Scalar;
+#endif
+}
+
+std::atomic<InstructionSet>& activeSet()
+{
+    static std::atomic<InstructionSet> set(bestInstructionSet());
+    return set;
+}
+
+std::atomic<const KernelTable*>& activeTable()
+{
+    static std::atomic<const KernelTable*> table(tableFor(bestInstructionSet()));
+    return table;
+}
+
+inline const KernelTable& kernels()
+{
+    return *activeTable().load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+InstructionSet bestInstructionSet()
+{
+    static const InstructionSet best = detectInstructionSet();
+    return best;
+}
+
+InstructionSet instructionSet()
+{
+    return activeSet().load();
+}
+
+bool isSupported(InstructionSet set)
+{
+    switch (set) {
+    case InstructionSet::Scalar:
+        return true;
+    case InstructionSet::SSE2:
+#if defined(AUDIO_KERNELS_X86)
+        return true;
+#else
+        return false;
+#endif
+    case InstructionSet::AVX2:
+        return bestInstructionSet() == InstructionSet::AVX2;
+    case InstructionSet::NEON:
+        return bestInstructionSet() == InstructionSet::NEON;
+    }
+    return false;
+}
+
+bool setInstructionSet(InstructionSet set)
+{
+    if (!isSupported(set)) {
+        return false;
+    }
+    activeSet().store(set);
+    activeTable().store(tableFor(set));
+    return true;
+}
+
+const char* instructionSetName(InstructionSet set)
+{
+    switch (set) {
+    case InstructionSet::Scalar:
+        return "scalar";
+    case InstructionSet::SSE2:
+        return "SSE2";
+    case InstructionSet::AVX2:
+        return "AVX2";
+    case InstructionSet::NEON:
+        return "NEON";
+    }
+    return "unknown";
+}
+
+void s16ToFloat(const qint16* source, float* destination, size_t count)
+{
+    kernels().s16ToFloat(source, destination, count);
+}
+
+void s32ToFloat(const qint32* source, float* destination, size_t count)
+{
+    kernels().s32ToFloat(source, destination, count);
+}
+
+void floatToS16(const float* source, qint16* destination, size_t count)
+{
+    kernels().floatToS16(source, destination, count);
+}
+
+void floatToS32(const float* source, qint32* destination, size_t count)
+{
+    kernels().floatToS32(source, destination, count);
+}
+
+void applyGain(float* buffer, float gain, size_t count)
+{
+    kernels().applyGain(buffer, gain, count);
+}
+
+void mixAdd(const float* source, float* destination, size_t count)
+{
+    kernels().mixAdd(source, destination, count);
+}
+
+void mixStereo(const float* source, float* destination, size_t frames, float gainLeft, float gainRight)
+{
+    kernels().mixStereo(source, destination, frames, gainLeft, gainRight);
+}
+
+void peakStats(const float* samples, size_t count, float* minimum, float* maximum, double* sumOfSquares)
+{
+    kernels().peakStats(samples, count, minimum, maximum, sumOfSquares);
+}
+
+} // namespace AudioKernels
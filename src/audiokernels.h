@@ -0,0 +1,50 @@
+#ifndef AUDIOKERNELS_H
+#define AUDIOKERNELS_H
+
+#include <QtGlobal>
+#include <cstddef>
+
+// Sample conversion and mixing kernels for the float32 audio pipeline.
+//
+// Every kernel has a scalar version plus SSE2/AVX2 (x86-64) or NEON (AArch64)
+// versions. The best instruction set the CPU supports is picked once at
+// startup; setInstructionSet() lets benchmarks compare against the others.
+// Float samples are full scale at +-1.0; conversions to integers clip and
+// round to nearest, so all variants produce identical integer output.
+namespace AudioKernels {
+
+enum class InstructionSet {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+InstructionSet bestInstructionSet();
+InstructionSet instructionSet();
+bool isSupported(InstructionSet set);
+bool setInstructionSet(InstructionSet set); // False if the CPU lacks it
+const char* instructionSetName(InstructionSet set);
+
+// Format conversion
+void s16ToFloat(const qint16* source, float* destination, size_t count);
+void s32ToFloat(const qint32* source, float* destination, size_t count);
+void floatToS16(const float* source, qint16* destination, size_t count);
+void floatToS32(const float* source, qint32* destination, size_t count);
+
+// buffer *= gain
+void applyGain(float* buffer, float gain, size_t count);
+
+// destination += source
+void mixAdd(const float* source, float* destination, size_t count);
+
+// Interleaved stereo: destination += source * (gainLeft, gainRight)
+void mixStereo(const float* source, float* destination, size_t frames, float gainLeft, float gainRight);
+
+// Waveform peaks: smallest and largest sample and the sum of the squares
+// (accumulated in double) of count samples; all zero when count is 0
+void peakStats(const float* samples, size_t count, float* minimum, float* maximum, double* sumOfSquares);
+
+} // namespace AudioKernels
+
+#endif // AUDIOKERNELS_H
@@ -0,0 +1,388 @@
+#include "audiomixer.h"
+#include "audiostreamdecoder.h"
+#include "audiokernels.h"
+#include "mediacache.h"
+#include "transportclock.h"
+#include "applog.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+AudioMixer::AudioMixer(TransportClock* clock, QObject* parent)
+    : QObject(parent)
+    , m_clock(clock)
+    , m_sampleRate(clock->sampleRate())
+    , m_pending(nullptr)
+    , m_active(nullptr)
+    , m_retired(RETIRE_QUEUE_SIZE)
+    , m_endFrame(0)
+    , m_dspLoad(0.0f)
+    , m_masterBus(MAX_BLOCK_FRAMES * CHANNELS)
+    , m_trackBus(MAX_BLOCK_FRAMES * CHANNELS)
+    , m_clipScratch(MAX_BLOCK_FRAMES * CHANNELS)
+{
+}
+
+AudioMixer::~AudioMixer()
+{
+    // The owner stops the audio sink first, so nothing renders any more
+    collectGarbage();
+    delete m_pending.exchange(nullptr);
+    delete m_active;
+    m_active = nullptr;
+}
+
+void AudioMixer::setArrangement(const MixerArrangement& arrangement)
+{
+    // Track gains: a track is audible unless muted, or unless another track is soloed
+    bool anySolo = false;
+    for (const MixerTrack& track : arrangement.tracks) {
+        anySolo = anySolo || track.soloed;
+    }
+    m_tracks.clear();
+    m_tracks.reserve(arrangement.tracks.size());
+    for (const MixerTrack& track : arrangement.tracks) {
+        // Balance law for stereo material: centre is unity, panning attenuates the far side
+        const float pan = qBound(-1.0f, track.pan, 1.0f);
+        TrackState trackState;
+        trackState.gainLeft = track.volume * qMin(1.0f, 1.0f - pan);
+        trackState.gainRight = track.volume * qMin(1.0f, 1.0f + pan);
+        trackState.audible = !track.muted && (!anySolo || track.soloed);
+        m_tracks.push_back(trackState);
+    }
+
+    // Clips, by start. Each file is looked up in the MediaCache once, however
+    // many clips use it. PCM decoded into memory at the output rate is read
+    // by the callback itself; mapped PCM could page-fault there, so a decoder
+    // thread copies that ahead like any other file.
+    QHash<QString, QSharedPointer<const DecodedMedia>> media;
+    std::vector<Clip> clips;
+    clips.reserve(arrangement.clips.size());
+    for (const MixerClip& mixerClip : arrangement.clips) {
+        auto found = media.find(mixerClip.filePath);
+        if (found == media.end()) {
+            QSharedPointer<const DecodedMedia> cached = MediaCache::instance().find(mixerClip.filePath);
+            if (cached && (!cached->hasPcm() || cached->isMapped() || cached->sampleRate != m_sampleRate)) {
+                cached.reset();
+            }
+            found = media.insert(mixerClip.filePath, cached);
+        }
+
+        Clip clip;
+        clip.id = mixerClip.id;
+        clip.filePath = mixerClip.filePath;
+        clip.startFrame = std::llround(mixerClip.startSeconds * m_sampleRate);
+        clip.trackIndex = mixerClip.trackIndex;
+        clip.media = found.value();
+        if (clip.media) {
+            clip.endFrame = clip.startFrame + clip.media->frames;
+        } else if (mixerClip.durationSeconds > 0.0) {
+            clip.endFrame = clip.startFrame + std::llround(mixerClip.durationSeconds * m_sampleRate);
+        } else {
+            clip.endFrame = std::numeric_limits<qint64>::max(); // Until its decoder knows
+        }
+        clips.push_back(clip);
+    }
+    std::stable_sort(clips.begin(), clips.end(), [](const Clip& a, const Clip& b) {
+        return a.startFrame < b.startFrame;
+    });
+    m_clips.swap(clips);
+
+    LOG_DEBUG(lcAudioMixer) << "AudioMixer: Arrangement updated -" << m_clips.size() << "clips of" << media.size()
+                            << "files on" << arrangement.tracks.size() << "tracks";
+
+    m_window = windowAt(m_clock->renderFrame());
+    publishWindow();
+    updateEndFrame();
+}
+
+std::vector<size_t> AudioMixer::windowAt(qint64 position) const
+{
+    // Clips are sorted by start, so those starting past the horizon are a suffix
+    const qint64 horizon = position + static_cast<qint64>(LOOKAHEAD_SECONDS) * m_sampleRate;
+    std::vector<size_t> window;
+    for (size_t i = 0; i < m_clips.size() && m_clips[i].startFrame < horizon; ++i) {
+        if (m_clips[i].endFrame > position) {
+            window.push_back(i);
+        }
+    }
+    return window;
+}
+
+void AudioMixer::updateWindow()
+{
+    std::vector<size_t> window = windowAt(m_clock->renderFrame());
+    if (window != m_window) {
+        m_window.swap(window);
+        publishWindow();
+    }
+}
+
+void AudioMixer::publishWindow()
+{
+    collectGarbage();
+
+    RenderState* state = new RenderState;
+    state->tracks = m_tracks;
+
+    // Reuse the decoder of a clip that stays in the window, open a new one
+    // otherwise. A moved clip gets a fresh decoder because the running one
+    // cannot be repositioned while the audio thread reads from it.
+    const qint64 position = m_clock->renderFrame();
+    QHash<ClipKey, QSharedPointer<AudioStreamDecoder>> decoders;
+    std::vector<ClipState> clips;
+    clips.reserve(m_window.size());
+    int skipped = 0;
+
+    for (size_t index : m_window) {
+        const Clip& clip = m_clips[index];
+        ClipState clipState;
+        clipState.decoder = nullptr;
+        clipState.pcm = nullptr;
+        clipState.pcmFrames = 0;
+        clipState.startFrame = clip.startFrame;
+        clipState.endFrame = clip.endFrame;
+        clipState.trackIndex = clip.trackIndex;
+
+        if (clip.media) {
+            clipState.pcm = clip.media->pcm;
+            clipState.pcmFrames = clip.media->frames;
+            state->media.append(clip.media);
+        } else {
+            // The window is in order of start, so the clips due first get the decoders
+            if (decoders.size() >= MAX_DECODERS) {
+                ++skipped;
+                continue;
+            }
+            const ClipKey key(clip.id, clip.startFrame);
+            QSharedPointer<AudioStreamDecoder> decoder = m_decoders.value(key);
+            if (!decoder) {
+                decoder.reset(new AudioStreamDecoder());
+                connect(decoder.data(), &AudioStreamDecoder::bufferPrimed, this, &AudioMixer::bufferPrimed);
+                connect(decoder.data(), &AudioStreamDecoder::seekIndexReady, this, &AudioMixer::onClipLengthChanged);
+                decoder->openInBackground(clip.filePath, m_sampleRate, qMax<qint64>(0, position - clip.startFrame));
+            }
+            decoders.insert(key, decoder);
+            clipState.decoder = decoder.data();
+            state->decoders.append(decoder);
+        }
+        clips.push_back(clipState);
+    }
+
+    if (skipped > 0) {
+        LOG_WARNING(lcAudioMixer) << "AudioMixer:" << skipped << "clips near the playhead left silent, all"
+                                  << MAX_DECODERS << "decoders are in use";
+    }
+
+    std::stable_sort(clips.begin(), clips.end(), [](const ClipState& a, const ClipState& b) {
+        return a.trackIndex < b.trackIndex;
+    });
+    state->clips = clips;
+
+    // Decoders of clips that left the window stop once the audio thread lets go of them
+    m_published.swap(clips);
+    m_decoders.swap(decoders);
+
+    LOG_TRACE(lcAudioMixer) << "AudioMixer: Rendering" << m_published.size() << "clips," << m_decoders.size()
+                            << "through decoders";
+    publish(state);
+}
+
+void AudioMixer::updateEndFrame()
+{
+    qint64 endFrame = 0;
+    for (const Clip& clip : m_clips) {
+        if (clip.endFrame != std::numeric_limits<qint64>::max()) {
+            endFrame = qMax(endFrame, clip.endFrame);
+        }
+    }
+    if (m_endFrame.exchange(endFrame) != endFrame) {
+        emit endFrameChanged(endFrame);
+    }
+}
+
+void AudioMixer::onClipLengthChanged()
+{
+    // A clip whose length the timeline did not give ends where its decoder says
+    bool changed = false;
+    for (size_t index : m_window) {
+        Clip& clip = m_clips[index];
+        if (clip.endFrame != std::numeric_limits<qint64>::max()) {
+            continue;
+        }
+        QSharedPointer<AudioStreamDecoder> decoder = m_decoders.value(ClipKey(clip.id, clip.startFrame));
+        if (decoder && decoder->durationFrames() > 0) {
+            clip.endFrame = clip.startFrame + decoder->durationFrames();
+            changed = true;
+        }
+    }
+    if (changed) {
+        publishWindow();
+        updateEndFrame();
+    }
+}
+
+void AudioMixer::clear()
+{
+    setArrangement(MixerArrangement());
+}
+
+void AudioMixer::publish(RenderState* state)
+{
+    // A state the audio thread never picked up can be freed right here
+    delete m_pending.exchange(state, std::memory_order_acq_rel);
+}
+
+void AudioMixer::collectGarbage()
+{
+    RenderState* retired = nullptr;
+    while (m_retired.read(&retired, 1) == 1) {
+        delete retired;
+    }
+}
+
+void AudioMixer::setPosition(qint64 frame)
+{
+    frame = qMax<qint64>(0, frame);
+    m_clock->locate(frame);
+
+    // Line the decoders up with the new transport position; clips that come
+    // into the window there open at it
+    for (const ClipState& clip : m_published) {
+        if (clip.decoder && frame < clip.endFrame) {
+            clip.decoder->seekToFrame(qMax<qint64>(0, frame - clip.startFrame));
+        }
+    }
+    updateWindow();
+}
+
+qint64 AudioMixer::endFrame() const
+{
+    return m_endFrame.load();
+}
+
+bool AudioMixer::hasClips() const
+{
+    return !m_clips.empty();
+}
+
+bool AudioMixer::isPrimed() const
+{
+    for (const ClipState& clip : m_published) {
+        if (clip.decoder && clip.decoder->bytesBuffered() == 0 && !clip.decoder->atEnd()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double AudioMixer::dspLoad() const
+{
+    return m_dspLoad.load(std::memory_order_relaxed);
+}
+
+bool AudioMixer::finished() const
+{
+    return m_clock->renderFrame() >= m_endFrame.load(std::memory_order_relaxed);
+}
+
+void AudioMixer::render(qint16* output, int frames)
+{
+    const auto renderStart = std::chrono::steady_clock::now();
+
+    // Pick up a newly published arrangement, retiring the old one to the GUI
+    if (m_retired.writeAvailable() > 0) {
+        if (RenderState* next = m_pending.exchange(nullptr, std::memory_order_acq_rel)) {
+            if (m_active) {
+                m_retired.write(&m_active, 1);
+            }
+            m_active = next;
+        }
+    }
+
+    qint64 position = m_clock->renderFrame();
+    int done = 0;
+
+    while (done < frames) {
+        const int count = qMin(frames - done, MAX_BLOCK_FRAMES);
+        float* master = m_masterBus.data();
+        std::fill(master, master + count * CHANNELS, 0.0f);
+
+        if (m_active) {
+            mixBlock(*m_active, position, count);
+        }
+
+        // The only conversion to the device format, clipping at full scale
+        AudioKernels::floatToS16(master, output + done * CHANNELS, static_cast<size_t>(count) * CHANNELS);
+
+        position += count;
+        done += count;
+    }
+
+    // DSP load: time spent rendering relative to the duration of the rendered audio
+    if (frames > 0) {
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+        const double load = elapsed * m_sampleRate / frames;
+        const float previous = m_dspLoad.load(std::memory_order_relaxed);
+        m_dspLoad.store(static_cast<float>(previous * 0.9 + load * 0.1), std::memory_order_relaxed);
+    }
+}
+
+void AudioMixer::mixBlock(const RenderState& state, qint64 position, int frames)
+{
+    const qint64 blockEnd = position + frames;
+    float* master = m_masterBus.data();
+    float* trackBus = m_trackBus.data();
+    float* scratch = m_clipScratch.data();
+
+    size_t i = 0;
+    while (i < state.clips.size()) {
+        const int trackIndex = state.clips[i].trackIndex;
+        bool trackHasAudio = false;
+
+        // Sum this track's clips into the track bus at unity gain
+        for (; i < state.clips.size() && state.clips[i].trackIndex == trackIndex; ++i) {
+            const ClipState& clip = state.clips[i];
+            const qint64 from = qMax(position, clip.startFrame);
+            const qint64 to = qMin(blockEnd, clip.endFrame);
+            if (from >= to) {
+                continue;
+            }
+
+            if (!trackHasAudio) {
+                std::fill(trackBus, trackBus + frames * CHANNELS, 0.0f);
+                trackHasAudio = true;
+            }
+
+            if (clip.pcm) {
+                const qint64 offset = from - clip.startFrame;
+                const qint64 count = qBound<qint64>(0, clip.pcmFrames - offset, to - from);
+                AudioKernels::mixAdd(clip.pcm + offset * CHANNELS, trackBus + (from - position) * CHANNELS,
+                                     static_cast<size_t>(count) * CHANNELS);
+                continue;
+            }
+
+            // Muted clips are still consumed so they stay in sync when unmuted.
+            // Read by position, so frames missing after an underrun are
+            // skipped rather than played late.
+            const qint64 got = clip.decoder->readFramesAt(scratch, from - clip.startFrame, to - from);
+            if (got < to - from && !clip.decoder->atEnd()) {
+                RT_LOG_WARNING(lcAudioMixer, "AudioMixer: Clip decoder underrun, missing frames:",
+                               static_cast<double>(to - from - got), static_cast<double>(trackIndex));
+            }
+            AudioKernels::mixAdd(scratch, trackBus + (from - position) * CHANNELS, static_cast<size_t>(got) * CHANNELS);
+        }
+
+        if (!trackHasAudio || trackIndex < 0 || trackIndex >= static_cast<int>(state.tracks.size())) {
+            continue;
+        }
+
+        // Track gain/pan, summed into the master bus
+        const TrackState& track = state.tracks[trackIndex];
+        if (!track.audible) {
+            continue;
+        }
+        AudioKernels::mixStereo(trackBus, master, static_cast<size_t>(frames), track.gainLeft, track.gainRight);
+    }
+}
@@ -0,0 +1,168 @@
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <QObject>
+#include <QHash>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <vector>
+#include "audioringbuffer.h"
+
+class AudioStreamDecoder;
+class TransportClock;
+struct DecodedMedia;
+
+// A clip on the timeline as seen by the mixer
+struct MixerClip {
+    quintptr id = 0;            // Stable identity of the clip (its timeline item)
+    QString filePath;
+    double startSeconds = 0.0;  // Position on the timeline
+    double durationSeconds = 0.0; // Length, or 0 if not known yet
+    int trackIndex = 0;
+};
+
+// Per-track mix settings, mirrored from Track
+struct MixerTrack {
+    float volume = 1.0f;        // Linear gain
+    float pan = 0.0f;           // -1 (left) .. 1 (right)
+    bool muted = false;
+    bool soloed = false;
+};
+
+struct MixerArrangement {
+    QVector<MixerTrack> tracks;
+    QVector<MixerClip> clips;
+};
+
+// Sums every clip of every track into a stereo master bus inside the audio
+// callback. Clips are summed into a track bus, the bus gets the track's
+// gain/pan, and the buses are summed into the master, which is converted to
+// the device format once at the end.
+//
+// Only clips near the playhead are rendered: those that overlap the next
+// LOOKAHEAD_SECONDS. A clip whose file the MediaCache holds decoded in memory
+// is read from that shared PCM directly, however many clips use the file.
+// Any other clip in the window gets an AudioStreamDecoder, opened on its own
+// thread, from a pool of at most MAX_DECODERS; it is let go once the clip
+// has played or the playhead leaves it. updateWindow() moves the window
+// along during playback.
+//
+// The mixer renders at the transport clock's render position; the audio
+// device advances that clock by the frames it hands to the sink.
+//
+// The arrangement is edited on the GUI thread and published to the audio
+// thread as an immutable RenderState through an atomic pointer. States the
+// audio thread has replaced are handed back through a ring buffer and freed on
+// the GUI thread, so render() never locks or frees memory.
+class AudioMixer : public QObject
+{
+    Q_OBJECT
+
+public:
+    AudioMixer(TransportClock* clock, QObject* parent = nullptr);
+    ~AudioMixer() override;
+
+    static constexpr int CHANNELS = 2;
+
+    int sampleRate() const { return m_sampleRate; }
+    TransportClock* clock() const { return m_clock; }
+
+    // GUI thread
+    void setArrangement(const MixerArrangement& arrangement);
+    void clear();
+    // Relocates the clock and seeks the clip decoders as their consumer. Only
+    // while render() is not running (see AudioIODevice::park()).
+    void setPosition(qint64 frame);
+    void updateWindow(); // Brings the clips near the playhead in, and lets go of those behind it
+    qint64 endFrame() const;
+    bool hasClips() const;
+    bool isPrimed() const; // Only while render() is not running
+    double dspLoad() const;
+    void collectGarbage();
+
+    // Audio thread
+    void render(qint16* output, int frames);
+    bool finished() const;
+
+signals:
+    void bufferPrimed();
+    void endFrameChanged(qint64 frame);
+
+private slots:
+    void onClipLengthChanged(); // A decoder replaced its estimated length with the exact one
+
+private:
+    struct ClipState {
+        AudioStreamDecoder* decoder; // Null when played from pcm
+        const float* pcm;            // Decoded file in the MediaCache, or null
+        qint64 pcmFrames;
+        qint64 startFrame;
+        qint64 endFrame;
+        int trackIndex;
+    };
+
+    // A clip of the arrangement, GUI side
+    struct Clip {
+        quintptr id;
+        QString filePath;
+        qint64 startFrame;
+        qint64 endFrame; // Max while the length is not known
+        int trackIndex;
+        QSharedPointer<const DecodedMedia> media; // Played from memory, or null
+    };
+
+    struct TrackState {
+        float gainLeft;
+        float gainRight;
+        bool audible;
+    };
+
+    struct RenderState {
+        std::vector<TrackState> tracks;
+        std::vector<ClipState> clips; // Sorted by track
+        // Keeps the decoders and PCM alive for as long as the audio thread may use them
+        QVector<QSharedPointer<AudioStreamDecoder>> decoders;
+        QVector<QSharedPointer<const DecodedMedia>> media;
+    };
+
+    typedef QPair<quintptr, qint64> ClipKey;
+
+    void publish(RenderState* state);
+    std::vector<size_t> windowAt(qint64 position) const;
+    void publishWindow(); // The clips in m_window, with a decoder each unless in memory
+    void updateEndFrame();
+    void mixBlock(const RenderState& state, qint64 position, int frames);
+
+    TransportClock* m_clock;
+    const int m_sampleRate;
+
+    // GUI-side view of the arrangement
+    std::vector<TrackState> m_tracks;
+    std::vector<Clip> m_clips; // Sorted by start
+    std::vector<size_t> m_window; // Indices of the clips near the playhead, as published
+    std::vector<ClipState> m_published;
+    QHash<ClipKey, QSharedPointer<AudioStreamDecoder>> m_decoders; // Of clips in the window
+
+    // Hand-over between GUI and audio thread
+    std::atomic<RenderState*> m_pending;
+    RenderState* m_active; // Audio thread only
+    AudioRingBuffer<RenderState*> m_retired;
+
+    std::atomic<qint64> m_endFrame;
+    std::atomic<float> m_dspLoad;
+
+    // Preallocated scratch buffers for render()
+    std::vector<float> m_masterBus;
+    std::vector<float> m_trackBus;
+    std::vector<float> m_clipScratch;
+
+    static constexpr int MAX_BLOCK_FRAMES = 1024;
+    static constexpr int LOOKAHEAD_SECONDS = 4; // A decoder fills its FIFO in well under this
+    static constexpr int MAX_DECODERS = 64; // Threads and FIFOs (about 2 MB each) in use at once
+    static constexpr int RETIRE_QUEUE_SIZE = 64;
+};
+
+#endif // AUDIOMIXER_H
@@ -0,0 +1,144 @@
+#ifndef AUDIORINGBUFFER_H
+#define AUDIORINGBUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Wait-free single-producer/single-consumer ring buffer for audio samples.
+//
+// Capacity is rounded up to a power of two and allocated once, so read() and
+// write() never allocate, lock or block. The read and write indices grow
+// monotonically and live on separate cache lines to avoid false sharing
+// between the decoder thread and the audio callback.
+template <typename T>
+class AudioRingBuffer
+{
+public:
+    AudioRingBuffer() = default;
+    explicit AudioRingBuffer(size_t minCapacity) { allocate(minCapacity); }
+
+    AudioRingBuffer(const AudioRingBuffer&) = delete;
+    AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+    // (Re)allocates storage. Neither side may be using the buffer.
+    void allocate(size_t minCapacity)
+    {
+        size_t capacity = 1;
+        while (capacity < minCapacity) {
+            capacity <<= 1;
+        }
+        m_buffer.reset(new T[capacity]());
+        m_capacity = capacity;
+        m_mask = capacity - 1;
+        m_writeIndex.store(0, std::memory_order_relaxed);
+        m_readIndex.store(0, std::memory_order_relaxed);
+    }
+
+    void release()
+    {
+        m_buffer.reset();
+        m_capacity = 0;
+        m_mask = 0;
+        m_writeIndex.store(0, std::memory_order_relaxed);
+        m_readIndex.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+    // Position of the next item written. Positions grow monotonically, so
+    // either side can use one to mark a point in the stream.
+    size_t writePosition() const { return m_writeIndex.load(std::memory_order_acquire); }
+
+    // Producer side
+    size_t writeAvailable() const
+    {
+        const size_t write = m_writeIndex.load(std::memory_order_relaxed);
+        const size_t read = m_readIndex.load(std::memory_order_acquire);
+        return m_capacity - (write - read);
+    }
+
+    size_t write(const T* data, size_t count)
+    {
+        const size_t write = m_writeIndex.load(std::memory_order_relaxed);
+        const size_t read = m_readIndex.load(std::memory_order_acquire);
+        const size_t n = std::min(count, m_capacity - (write - read));
+        if (n == 0) {
+            return 0;
+        }
+
+        const size_t offset = write & m_mask;
+        const size_t first = std::min(n, m_capacity - offset);
+        std::copy(data, data + first, m_buffer.get() + offset);
+        std::copy(data + first, data + n, m_buffer.get());
+
+        m_writeIndex.store(write + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side
+    size_t readAvailable() const
+    {
+        const size_t read = m_readIndex.load(std::memory_order_relaxed);
+        const size_t write = m_writeIndex.load(std::memory_order_acquire);
+        return write - read;
+    }
+
+    size_t read(T* dest, size_t count)
+    {
+        const size_t read = m_readIndex.load(std::memory_order_relaxed);
+        const size_t write = m_writeIndex.load(std::memory_order_acquire);
+        const size_t n = std::min(count, write - read);
+        if (n == 0) {
+            return 0;
+        }
+
+        const size_t offset = read & m_mask;
+        const size_t first = std::min(n, m_capacity - offset);
+        std::copy(m_buffer.get() + offset, m_buffer.get() + offset + first, dest);
+        std::copy(m_buffer.get(), m_buffer.get() + (n - first), dest + first);
+
+        m_readIndex.store(read + n, std::memory_order_release);
+        return n;
+    }
+
+    // Drops up to count items without copying them
+    size_t skip(size_t count)
+    {
+        const size_t read = m_readIndex.load(std::memory_order_relaxed);
+        const size_t write = m_writeIndex.load(std::memory_order_acquire);
+        const size_t n = std::min(count, write - read);
+        m_readIndex.store(read + n, std::memory_order_release);
+        return n;
+    }
+
+    // Position of the next item read
+    size_t readPosition() const { return m_readIndex.load(std::memory_order_relaxed); }
+
+    // Drops the items queued before position. Does nothing if they have
+    // already been read.
+    size_t skipTo(size_t position)
+    {
+        const size_t read = m_readIndex.load(std::memory_order_relaxed);
+        const size_t write = m_writeIndex.load(std::memory_order_acquire);
+        const size_t n = position - read;
+        if (n == 0 || n > write - read) {
+            return 0;
+        }
+        m_readIndex.store(position, std::memory_order_release);
+        return n;
+    }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    std::unique_ptr<T[]> m_buffer;
+    size_t m_capacity = 0;
+    size_t m_mask = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_writeIndex{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_readIndex{0};
+};
+
+#endif // AUDIORINGBUFFER_H
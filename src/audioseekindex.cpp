@@ -0,0 +1,182 @@
+#include "audioseekindex.h"
+#include "applog.h"
+#include <algorithm>
+
+AudioSeekIndex::AudioSeekIndex()
+    : m_nextSample(0)
+    , m_totalSamples(0)
+    , m_sampleRate(0)
+    , m_complete(false)
+#if HAVE_FFMPEG
+    , m_formatContext(nullptr)
+    , m_packet(nullptr)
+    , m_streamIndex(-1)
+    , m_timeBase(AVRational{1, 1})
+#endif
+{
+}
+
+AudioSeekIndex::~AudioSeekIndex()
+{
+    closeSource();
+}
+
+void AudioSeekIndex::reset(const QString& filePath)
+{
+    clear();
+    m_filePath = filePath;
+}
+
+void AudioSeekIndex::clear()
+{
+    closeSource();
+    m_filePath.clear();
+    m_entries.clear();
+    m_entries.squeeze();
+    m_nextSample = 0;
+    m_totalSamples = 0;
+    m_sampleRate = 0;
+    m_complete = false;
+}
+
+bool AudioSeekIndex::openSource()
+{
+#if HAVE_FFMPEG
+    if (avformat_open_input(&m_formatContext, m_filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        return false;
+    }
+    if (avformat_find_stream_info(m_formatContext, nullptr) < 0) {
+        return false;
+    }
+
+    m_streamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    if (m_streamIndex < 0) {
+        return false;
+    }
+
+    // Only the packet headers are needed: skip every other stream entirely
+    for (unsigned int i = 0; i < m_formatContext->nb_streams; ++i) {
+        if (static_cast<int>(i) != m_streamIndex) {
+            m_formatContext->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    AVStream* stream = m_formatContext->streams[m_streamIndex];
+    m_timeBase = stream->time_base;
+    m_sampleRate = stream->codecpar->sample_rate;
+    m_packet = av_packet_alloc();
+    return m_packet && m_sampleRate > 0;
+#else
+    return false;
+#endif
+}
+
+void AudioSeekIndex::closeSource()
+{
+#if HAVE_FFMPEG
+    if (m_packet) {
+        av_packet_free(&m_packet);
+    }
+    if (m_formatContext) {
+        avformat_close_input(&m_formatContext);
+    }
+    m_streamIndex = -1;
+#endif
+}
+
+bool AudioSeekIndex::scan(int maxPackets)
+{
+    if (m_complete) {
+        return true;
+    }
+
+#if HAVE_FFMPEG
+    if (!m_formatContext) {
+        if (m_filePath.isEmpty() || !openSource()) {
+            LOG_WARNING(lcAudioDecoder) << "AudioSeekIndex: Could not scan" << m_filePath;
+            closeSource();
+            m_entries.clear();
+            m_complete = true;
+            return true;
+        }
+    }
+
+    const AVRational sampleBase{1, m_sampleRate};
+
+    for (int i = 0; i < maxPackets; ++i) {
+        if (av_read_frame(m_formatContext, m_packet) < 0) {
+            m_complete = true;
+            break;
+        }
+
+        if (m_packet->stream_index == m_streamIndex) {
+            const int64_t pts = m_packet->pts != AV_NOPTS_VALUE ? m_packet->pts : m_packet->dts;
+
+            // Trust packet timestamps when present, otherwise continue the
+            // running count of packet durations
+            Entry entry;
+            entry.sample = pts != AV_NOPTS_VALUE ? av_rescale_q(pts, m_timeBase, sampleBase) : m_nextSample;
+            entry.position = m_packet->pos;
+            entry.timestamp = pts != AV_NOPTS_VALUE ? pts : av_rescale_q(m_nextSample, sampleBase, m_timeBase);
+
+            // Keep the index sorted even if a demuxer reports a stray timestamp
+            if (m_entries.isEmpty() || entry.sample > m_entries.last().sample) {
+                m_entries.append(entry);
+            }
+
+            const qint64 duration = m_packet->duration > 0 ? av_rescale_q(m_packet->duration, m_timeBase, sampleBase) : 0;
+            m_nextSample = qMax(m_nextSample, entry.sample + duration);
+        }
+        av_packet_unref(m_packet);
+    }
+
+    if (m_complete) {
+        m_totalSamples = m_entries.isEmpty() ? 0 : m_nextSample - m_entries.first().sample;
+        m_entries.squeeze();
+        closeSource();
+        LOG_DEBUG(lcAudioDecoder) << "AudioSeekIndex: Indexed" << m_entries.size() << "packets," << m_totalSamples << "samples at"
+                                  << m_sampleRate << "Hz";
+    }
+    return m_complete;
+#else
+    Q_UNUSED(maxPackets)
+    m_complete = true;
+    return true;
+#endif
+}
+
+qint64 AudioSeekIndex::firstSample() const
+{
+    return m_entries.isEmpty() ? 0 : m_entries.first().sample;
+}
+
+int AudioSeekIndex::findPacket(qint64 sample) const
+{
+    if (m_entries.isEmpty()) {
+        return -1;
+    }
+
+    // Last packet starting at or before the sample
+    auto it = std::upper_bound(m_entries.cbegin(), m_entries.cend(), sample,
+                               [](qint64 value, const Entry& entry) { return value < entry.sample; });
+    return qMax(0, static_cast<int>(it - m_entries.cbegin()) - 1);
+}
+
+#if HAVE_FFMPEG
+int AudioSeekIndex::prerollPackets(AVCodecID codecId)
+{
+    switch (codecId) {
+    case AV_CODEC_ID_MP3:
+    case AV_CODEC_ID_MP2:
+        return 2; // Bit reservoir plus the overlapped MDCT of the previous frame
+    case AV_CODEC_ID_AAC:
+    case AV_CODEC_ID_VORBIS:
+    case AV_CODEC_ID_OPUS:
+    case AV_CODEC_ID_AC3:
+    case AV_CODEC_ID_EAC3:
+        return 1; // Overlapped transform: the previous packet completes the first frame
+    default:
+        return 0; // PCM, FLAC, ALAC, ...: every packet decodes on its own
+    }
+}
+#endif
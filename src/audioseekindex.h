@@ -0,0 +1,80 @@
+#ifndef AUDIOSEEKINDEX_H
+#define AUDIOSEEKINDEX_H
+
+#include <QString>
+#include <QVector>
+
+#if HAVE_FFMPEG
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+#endif
+
+// Maps sample offsets to packet positions for one audio stream.
+//
+// The index is built by reading packets without decoding them, on a format
+// context of its own, so it can be built in small batches while playback
+// runs. Lookups are a binary search. The sample count it ends up with is
+// exact even when the container's duration is only an estimate (VBR MP3).
+class AudioSeekIndex
+{
+public:
+    struct Entry {
+        qint64 sample;    // First sample of the packet, in stream sample-rate units
+        qint64 position;  // Byte offset of the packet in the file, or -1
+        qint64 timestamp; // Packet pts in stream time base
+    };
+
+    AudioSeekIndex();
+    ~AudioSeekIndex();
+
+    AudioSeekIndex(const AudioSeekIndex&) = delete;
+    AudioSeekIndex& operator=(const AudioSeekIndex&) = delete;
+
+    // Starts a new index for the file; the scan itself happens in scan()
+    void reset(const QString& filePath);
+    void clear();
+
+    // Reads up to maxPackets packets. Returns true once the index is complete
+    // (or the file could not be scanned, see isValid()).
+    bool scan(int maxPackets);
+
+    bool isComplete() const { return m_complete; }
+    bool isValid() const { return m_complete && !m_entries.isEmpty(); }
+
+    int sampleRate() const { return m_sampleRate; }
+    qint64 firstSample() const;
+    qint64 totalSamples() const { return m_totalSamples; } // Exact length in samples
+    int size() const { return m_entries.size(); }
+    const Entry& entry(int index) const { return m_entries[index]; }
+
+    // Index of the packet containing the sample (the first packet for samples before it)
+    int findPacket(qint64 sample) const;
+
+#if HAVE_FFMPEG
+    // Packets to decode before the target so the decoder state has settled
+    // (MP3's bit reservoir reaches back into earlier frames, for example)
+    static int prerollPackets(AVCodecID codecId);
+#endif
+
+private:
+    bool openSource();
+    void closeSource();
+
+    QString m_filePath;
+    QVector<Entry> m_entries;
+    qint64 m_nextSample;
+    qint64 m_totalSamples;
+    int m_sampleRate;
+    bool m_complete;
+
+#if HAVE_FFMPEG
+    AVFormatContext* m_formatContext;
+    AVPacket* m_packet;
+    int m_streamIndex;
+    AVRational m_timeBase;
+#endif
+};
+
+#endif // AUDIOSEEKINDEX_H
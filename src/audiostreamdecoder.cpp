@@ -0,0 +1,715 @@
+#include "audiostreamdecoder.h"
+#include "audiokernels.h"
+#include "applog.h"
+#include "wakeupcounter.h"
+#include <algorithm>
+
+AudioStreamDecoder::AudioStreamDecoder(QObject *parent)
+    : QThread(parent)
+#if HAVE_FFMPEG
+    , m_formatContext(nullptr)
+    , m_codecContext(nullptr)
+    , m_swrContext(nullptr)
+    , m_frame(nullptr)
+    , m_packet(nullptr)
+    , m_audioStreamIndex(-1)
+    , m_directConvert(false)
+#endif
+    , m_sampleRate(44100)
+    , m_durationMs(0)
+    , m_durationFrames(0)
+    , m_endOfStream(false)
+    , m_primed(false)
+    , m_seekRequestFrame(0)
+    , m_seekHandledFrame(0)
+    , m_seekRequested(0)
+    , m_seekHandled(0)
+    , m_stopRequested(false)
+    , m_ready(false)
+    , m_seekWritePosition(0)
+    , m_readGeneration(0)
+    , m_readFrame(0)
+    , m_mediaFrame(0)
+    , m_seekTargetFrame(-1)
+    , m_seekOriginFrame(0)
+    , m_nextSourceSample(-1)
+{
+}
+
+AudioStreamDecoder::~AudioStreamDecoder()
+{
+    close();
+}
+
+AudioResult AudioStreamDecoder::open(const QString& filePath, int outputSampleRate)
+{
+    close();
+    resetPosition();
+
+    const AudioResult result = openFile(filePath, outputSampleRate);
+    if (result.isSuccess()) {
+        m_stopRequested = false;
+        m_ready.store(true, std::memory_order_release);
+        start();
+    }
+    return result;
+}
+
+void AudioStreamDecoder::openInBackground(const QString& filePath, int outputSampleRate, qint64 startFrame)
+{
+    close();
+    resetPosition();
+
+    m_openPath = filePath;
+    m_openSampleRate = outputSampleRate;
+    m_openStartFrame = qMax<qint64>(0, startFrame);
+    m_stopRequested = false;
+    start();
+}
+
+void AudioStreamDecoder::resetPosition()
+{
+    // Nothing reads or decodes yet, so both sides can be set here
+    m_seekHandled = m_seekRequested.load();
+    m_seekWritePosition = 0;
+    m_seekHandledFrame = 0;
+    m_readGeneration = m_seekHandled.load();
+    m_readFrame = 0;
+}
+
+AudioResult AudioStreamDecoder::openFile(const QString& filePath, int outputSampleRate)
+{
+    // Already decoded at this rate: play from memory
+    QSharedPointer<const DecodedMedia> media = MediaCache::instance().find(filePath);
+    if (media && media->hasPcm() && (outputSampleRate <= 0 || media->sampleRate == outputSampleRate)) {
+        m_media = media;
+        m_mediaFrame = 0;
+        m_sampleRate = media->sampleRate;
+        m_durationFrames = media->frames;
+        m_durationMs = media->frames * 1000 / m_sampleRate;
+
+        m_ring.allocate(static_cast<size_t>(m_sampleRate) * OUTPUT_CHANNELS * BUFFER_AHEAD_SECONDS);
+        m_endOfStream = false;
+        m_primed = false;
+
+        LOG_DEBUG(lcAudioDecoder) << "AudioStreamDecoder: Playing" << filePath << "from the media cache";
+        return AudioResult::success();
+    }
+
+#if HAVE_FFMPEG
+    LOG_DEBUG(lcAudioDecoder) << "AudioStreamDecoder: Opening" << filePath;
+
+    if (avformat_open_input(&m_formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        releaseFFmpeg();
+        return AudioResult(AudioError::DecodingFailed, "Could not open audio file");
+    }
+
+    if (avformat_find_stream_info(m_formatContext, nullptr) < 0) {
+        releaseFFmpeg();
+        return AudioResult(AudioError::DecodingFailed, "Could not find stream information");
+    }
+
+    const AVCodec* codec = nullptr;
+    m_audioStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+    if (m_audioStreamIndex < 0 || !codec) {
+        releaseFFmpeg();
+        return AudioResult(AudioError::DecodingFailed, "Could not find audio stream");
+    }
+
+    AVStream* stream = m_formatContext->streams[m_audioStreamIndex];
+
+    m_codecContext = avcodec_alloc_context3(codec);
+    if (!m_codecContext) {
+        releaseFFmpeg();
+        return AudioResult(AudioError::MemoryError, "Could not allocate codec context");
+    }
+
+    if (avcodec_parameters_to_context(m_codecContext, stream->codecpar) < 0
+        || avcodec_open2(m_codecContext, codec, nullptr) < 0) {
+        releaseFFmpeg();
+        return AudioResult(AudioError::DecodingFailed, "Could not open codec");
+    }
+
+    // Resample to the requested rate, or keep the file's own rate
+    m_sampleRate = outputSampleRate > 0 ? outputSampleRate : m_codecContext->sample_rate;
+
+    // Interleaved stereo that needs no resampling only needs a sample format
+    // conversion; everything else goes through swresample
+    const AVSampleFormat sourceFormat = m_codecContext->sample_fmt;
+    m_directConvert = m_codecContext->sample_rate == m_sampleRate
+                      && m_codecContext->ch_layout.nb_channels == OUTPUT_CHANNELS
+                      && (sourceFormat == AV_SAMPLE_FMT_S16 || sourceFormat == AV_SAMPLE_FMT_S32
+                          || sourceFormat == AV_SAMPLE_FMT_FLT);
+
+    if (!m_directConvert) {
+        AVChannelLayout stereoLayout = AV_CHANNEL_LAYOUT_STEREO;
+        int ret = swr_alloc_set_opts2(&m_swrContext,
+                                      &stereoLayout, AV_SAMPLE_FMT_FLT, m_sampleRate,
+                                      &m_codecContext->ch_layout, sourceFormat, m_codecContext->sample_rate,
+                                      0, nullptr);
+        if (ret < 0 || !m_swrContext || swr_init(m_swrContext) < 0) {
+            releaseFFmpeg();
+            return AudioResult(AudioError::DecodingFailed, "Could not initialize resampler");
+        }
+    }
+
+    m_frame = av_frame_alloc();
+    m_packet = av_packet_alloc();
+    if (!m_frame || !m_packet) {
+        releaseFFmpeg();
+        return AudioResult(AudioError::MemoryError, "Could not allocate frame or packet");
+    }
+
+    if (stream->duration != AV_NOPTS_VALUE) {
+        m_durationMs = av_rescale_q(stream->duration, stream->time_base, AVRational{1, 1000});
+    } else if (m_formatContext->duration != AV_NOPTS_VALUE) {
+        m_durationMs = av_rescale(m_formatContext->duration, 1000, AV_TIME_BASE);
+    } else {
+        m_durationMs = 0;
+    }
+    m_durationFrames = av_rescale(m_durationMs, m_sampleRate, 1000);
+
+    // Size the FIFO for a few seconds of output (rounded up to a power of two)
+    m_ring.allocate(static_cast<size_t>(m_sampleRate) * OUTPUT_CHANNELS * BUFFER_AHEAD_SECONDS);
+    m_endOfStream = false;
+    m_primed = false;
+    m_seekTargetFrame = -1;
+    m_seekOriginFrame = 0;
+    m_nextSourceSample = -1;
+    m_seekIndex.reset(filePath);
+
+    LOG_DEBUG(lcAudioDecoder) << "AudioStreamDecoder: Opened -" << m_sampleRate << "Hz," << m_durationMs << "ms, FIFO"
+                              << m_ring.capacity() * sizeof(float) << "bytes" << (m_directConvert ? "(direct)" : "(resampled)");
+
+    return AudioResult::success();
+#else
+    Q_UNUSED(filePath)
+    return AudioResult(AudioError::UnsupportedFormat, "FFmpeg not available");
+#endif
+}
+
+AudioResult AudioStreamDecoder::probe(const QString& filePath, qint64* durationMs)
+{
+#if HAVE_FFMPEG
+    AVFormatContext* formatContext = nullptr;
+    if (avformat_open_input(&formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        return AudioResult(AudioError::DecodingFailed, "Could not open audio file");
+    }
+
+    if (avformat_find_stream_info(formatContext, nullptr) < 0) {
+        avformat_close_input(&formatContext);
+        return AudioResult(AudioError::DecodingFailed, "Could not find stream information");
+    }
+
+    const AVCodec* codec = nullptr;
+    int streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+    if (streamIndex < 0 || !codec) {
+        avformat_close_input(&formatContext);
+        return AudioResult(AudioError::UnsupportedFormat, "Could not find a decodable audio stream");
+    }
+
+    if (durationMs) {
+        *durationMs = formatContext->duration != AV_NOPTS_VALUE
+                          ? av_rescale(formatContext->duration, 1000, AV_TIME_BASE) : 0;
+    }
+
+    avformat_close_input(&formatContext);
+    return AudioResult::success();
+#else
+    Q_UNUSED(filePath)
+    Q_UNUSED(durationMs)
+    return AudioResult(AudioError::UnsupportedFormat, "FFmpeg not available");
+#endif
+}
+
+void AudioStreamDecoder::close()
+{
+    m_ready = false;
+    stopThread();
+    releaseFFmpeg();
+    m_openPath.clear();
+
+    m_media.reset();
+    m_seekIndex.clear();
+    m_ring.release();
+    m_endOfStream = false;
+    m_primed = false;
+    m_seekHandled = m_seekRequested.load();
+    m_readGeneration = m_seekHandled;
+    m_seekWritePosition = 0;
+    m_durationMs = 0;
+    m_durationFrames = 0;
+}
+
+bool AudioStreamDecoder::isOpen() const
+{
+    return isRunning();
+}
+
+void AudioStreamDecoder::stopThread()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    m_stopRequested = true;
+    m_wake.signal();
+    wait();
+
+    // Drop a wakeup the thread never took, so the next one starts asleep
+    m_wake.reset();
+}
+
+void AudioStreamDecoder::releaseFFmpeg()
+{
+#if HAVE_FFMPEG
+    if (m_swrContext) {
+        swr_free(&m_swrContext);
+    }
+    if (m_codecContext) {
+        avcodec_free_context(&m_codecContext);
+    }
+    if (m_formatContext) {
+        avformat_close_input(&m_formatContext);
+    }
+    if (m_frame) {
+        av_frame_free(&m_frame);
+    }
+    if (m_packet) {
+        av_packet_free(&m_packet);
+    }
+    m_audioStreamIndex = -1;
+    m_directConvert = false;
+#endif
+}
+
+void AudioStreamDecoder::seek(qint64 positionMs)
+{
+    seekToFrame(positionMs * m_sampleRate / 1000);
+}
+
+void AudioStreamDecoder::seekToFrame(qint64 frame)
+{
+    requestSeek(frame);
+}
+
+void AudioStreamDecoder::requestSeek(qint64 frame)
+{
+    // Lock-free, so the callback can post a seek too. Before the file is open
+    // the decoder thread still owns the FIFO, and handles the request once it
+    // is.
+    const bool ready = m_ready.load(std::memory_order_acquire);
+
+    // The consumer sees an empty stream until the decoder thread has started
+    // refilling the FIFO from the new position. What is queued now is dropped
+    // straight away, so the decoder thread has room to refill even while the
+    // callback is not reading; anything it writes before it sees the request
+    // is dropped by the first read after the seek is handled.
+    const size_t queued = ready ? m_ring.writePosition() : 0;
+    m_seekRequestFrame.store(qMax<qint64>(0, frame));
+    m_seekRequested.fetch_add(1, std::memory_order_release);
+    if (ready) {
+        m_ring.skipTo(queued);
+    }
+
+    // After the request, so a decoder thread woken by it also finds it
+    m_wake.signal();
+}
+
+bool AudioStreamDecoder::seekPending() const
+{
+    return m_seekRequested.load(std::memory_order_acquire) != m_seekHandled.load(std::memory_order_acquire);
+}
+
+void AudioStreamDecoder::dropStaleSamples()
+{
+    const quint64 handled = m_seekHandled.load(std::memory_order_acquire);
+    if (handled != m_readGeneration) {
+        // Count frames from where the seek's data starts, including any
+        // already read past it
+        const size_t start = m_seekWritePosition.load(std::memory_order_relaxed);
+        m_ring.skipTo(start);
+        m_readGeneration = handled;
+        m_readFrame = m_seekHandledFrame.load(std::memory_order_relaxed)
+                      + static_cast<qint64>((m_ring.readPosition() - start) / OUTPUT_CHANNELS);
+    }
+}
+
+size_t AudioStreamDecoder::freshAvailable() const
+{
+    const size_t available = m_ring.readAvailable();
+    if (m_seekHandled.load(std::memory_order_acquire) == m_readGeneration) {
+        return available;
+    }
+    const size_t stale = m_seekWritePosition.load(std::memory_order_relaxed) - m_ring.readPosition();
+    return stale <= available ? available - stale : available;
+}
+
+qint64 AudioStreamDecoder::readFrames(float* dest, qint64 frames)
+{
+    if (!m_ready.load(std::memory_order_acquire) || seekPending()) {
+        return 0;
+    }
+    dropStaleSamples();
+
+    // Whole frames only, so channels never swap
+    const size_t count = m_ring.read(dest, static_cast<size_t>(frames) * OUTPUT_CHANNELS);
+    m_readFrame += static_cast<qint64>(count / OUTPUT_CHANNELS);
+    wakeIfRoom();
+    return static_cast<qint64>(count / OUTPUT_CHANNELS);
+}
+
+qint64 AudioStreamDecoder::readFramesAt(float* dest, qint64 frame, qint64 frames)
+{
+    if (!m_ready.load(std::memory_order_acquire) || seekPending()) {
+        return 0;
+    }
+    dropStaleSamples();
+
+    if (m_endOfStream.load() && m_ring.readAvailable() == 0) {
+        return 0; // Nothing left to line up
+    }
+
+    // Behind: drop what should already have played. Further behind than the
+    // FIFO holds, or ahead, the stream starts over at the next block instead.
+    const qint64 behind = frame - m_readFrame;
+    if (behind < 0 || behind > static_cast<qint64>(m_ring.capacity() / OUTPUT_CHANNELS)) {
+        requestSeek(frame + frames); // This block stays silent
+        return 0;
+    }
+    if (behind > 0) {
+        const qint64 skipped = static_cast<qint64>(m_ring.skip(static_cast<size_t>(behind) * OUTPUT_CHANNELS) / OUTPUT_CHANNELS);
+        m_readFrame += skipped;
+        if (skipped < behind) {
+            wakeIfRoom();
+            return 0;
+        }
+    }
+    return readFrames(dest, frames);
+}
+
+qint64 AudioStreamDecoder::bytesBuffered() const
+{
+    if (!m_ready.load(std::memory_order_acquire) || seekPending()) {
+        return 0;
+    }
+    return static_cast<qint64>(freshAvailable() * sizeof(float));
+}
+
+bool AudioStreamDecoder::atEnd() const
+{
+    return !seekPending() && m_endOfStream.load() && freshAvailable() == 0;
+}
+
+void AudioStreamDecoder::wakeIfRoom()
+{
+    // Wake the decoder once there is a batch worth decoding. The signal
+    // stays set, so a decoder that checked for work just before this read
+    // does not sleep through it.
+    if (!m_endOfStream.load(std::memory_order_relaxed)
+        && m_ring.capacity() - m_ring.readAvailable() >= refillThreshold()) {
+        m_wake.signal();
+    }
+}
+
+bool AudioStreamDecoder::hasWork() const
+{
+    return m_stopRequested || seekPending() || (!m_endOfStream && m_ring.writeAvailable() >= refillThreshold());
+}
+
+void AudioStreamDecoder::idleWait()
+{
+    if (hasWork()) {
+        return;
+    }
+    m_wake.wait();
+    WakeupCounter::countThreadWakeup();
+}
+
+void AudioStreamDecoder::run()
+{
+    if (!m_openPath.isEmpty() && !openOnThread()) {
+        return;
+    }
+
+    while (!m_stopRequested) {
+        if (seekPending()) {
+            const quint64 request = m_seekRequested.load(std::memory_order_acquire);
+            const qint64 frame = m_seekRequestFrame.load();
+            performSeek(frame);
+            m_seekHandledFrame.store(m_media ? m_mediaFrame : frame, std::memory_order_relaxed);
+            m_seekWritePosition.store(m_ring.writePosition(), std::memory_order_relaxed);
+            m_seekHandled.store(request, std::memory_order_release);
+            continue;
+        }
+
+        if (m_endOfStream || m_ring.writeAvailable() < refillThreshold()) {
+            // Spend the idle time indexing, a batch at a time so seeks stay responsive
+            if (!m_media && !m_seekIndex.isComplete()) {
+                if (m_seekIndex.scan(INDEX_SCAN_BATCH)) {
+                    onSeekIndexComplete();
+                }
+                continue;
+            }
+            idleWait();
+            continue;
+        }
+
+        const bool more = m_media ? copyNextBlock() : decodeNextPacket();
+        if (!more && !seekPending()) {
+            m_endOfStream = true;
+            if (!m_primed) {
+                m_primed = true;
+                emit bufferPrimed();
+            }
+        }
+    }
+}
+
+bool AudioStreamDecoder::openOnThread()
+{
+    const AudioResult result = openFile(m_openPath, m_openSampleRate);
+    if (!result.isSuccess()) {
+        LOG_WARNING(lcAudioDecoder) << "AudioStreamDecoder: Could not open" << m_openPath << "-" << result.getErrorMessage();
+        releaseFFmpeg();
+        m_endOfStream = true; // Reads as a finished stream, so nobody waits for it
+        emit decodeError(result.getError(), result.getErrorMessage());
+        emit bufferPrimed();
+        return false;
+    }
+
+    if (m_openStartFrame > 0) {
+        performSeek(m_openStartFrame);
+        m_seekHandledFrame = m_media ? m_mediaFrame : m_openStartFrame;
+        m_readFrame = m_seekHandledFrame.load();
+    }
+
+    // Publishes the stream to the consumer
+    m_ready.store(true, std::memory_order_release);
+    return true;
+}
+
+bool AudioStreamDecoder::copyNextBlock()
+{
+    const qint64 frames = qMin<qint64>(m_media->frames - m_mediaFrame, MEMORY_BLOCK_FRAMES);
+    if (frames <= 0) {
+        return false;
+    }
+
+    const qint64 frame = m_mediaFrame;
+    m_mediaFrame += frames;
+    writeBlock(m_media->pcm + frame * OUTPUT_CHANNELS, frames * OUTPUT_CHANNELS);
+    return true;
+}
+
+bool AudioStreamDecoder::decodeNextPacket()
+{
+#if HAVE_FFMPEG
+    if (av_read_frame(m_formatContext, m_packet) < 0) {
+        // Drain whatever the decoder still holds
+        avcodec_send_packet(m_codecContext, nullptr);
+        while (avcodec_receive_frame(m_codecContext, m_frame) >= 0) {
+            convertAndWrite();
+        }
+        return false;
+    }
+
+    if (m_packet->stream_index == m_audioStreamIndex) {
+        if (avcodec_send_packet(m_codecContext, m_packet) >= 0) {
+            while (avcodec_receive_frame(m_codecContext, m_frame) >= 0) {
+                convertAndWrite();
+            }
+        }
+    }
+    av_packet_unref(m_packet);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AudioStreamDecoder::convertAndWrite()
+{
+#if HAVE_FFMPEG
+    const int frameBytes = bytesPerFrame();
+    const int outSamples = m_directConvert ? m_frame->nb_samples
+                                           : swr_get_out_samples(m_swrContext, m_frame->nb_samples);
+    if (outSamples <= 0) {
+        return;
+    }
+
+    const qsizetype needed = static_cast<qsizetype>(outSamples) * frameBytes;
+    if (m_convertBuffer.size() < needed) {
+        m_convertBuffer.resize(needed);
+    }
+
+    float* output = reinterpret_cast<float*>(m_convertBuffer.data());
+    int converted = 0;
+    int64_t resamplerDelay = 0; // Output frames still held back from earlier input
+    if (m_directConvert) {
+        const size_t samples = static_cast<size_t>(outSamples) * OUTPUT_CHANNELS;
+        switch (m_codecContext->sample_fmt) {
+        case AV_SAMPLE_FMT_S16:
+            AudioKernels::s16ToFloat(reinterpret_cast<const qint16*>(m_frame->data[0]), output, samples);
+            break;
+        case AV_SAMPLE_FMT_S32:
+            AudioKernels::s32ToFloat(reinterpret_cast<const qint32*>(m_frame->data[0]), output, samples);
+            break;
+        default:
+            std::copy_n(reinterpret_cast<const float*>(m_frame->data[0]), samples, output);
+            break;
+        }
+        converted = outSamples;
+    } else {
+        uint8_t* outputBytes = reinterpret_cast<uint8_t*>(output);
+        resamplerDelay = swr_get_delay(m_swrContext, m_sampleRate);
+        converted = swr_convert(m_swrContext, &outputBytes, outSamples,
+                                const_cast<const uint8_t**>(m_frame->extended_data), m_frame->nb_samples);
+    }
+    if (converted <= 0) {
+        return;
+    }
+
+    const float* source = output;
+    qint64 frames = converted;
+
+    // Trim the head of the first frame after a seek so output starts on the target sample
+    if (m_seekTargetFrame >= 0) {
+        AVStream* stream = m_formatContext->streams[m_audioStreamIndex];
+        int64_t frameStart = AV_NOPTS_VALUE;
+        if (m_nextSourceSample >= 0) {
+            // After a byte seek, count samples from the indexed packet
+            frameStart = av_rescale(m_nextSourceSample, m_sampleRate, m_seekIndex.sampleRate());
+            m_nextSourceSample += m_frame->nb_samples;
+        } else if (m_frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+            frameStart = av_rescale_q(m_frame->best_effort_timestamp, stream->time_base, AVRational{1, m_sampleRate});
+        }
+        if (frameStart != AV_NOPTS_VALUE) {
+            // The resampler's output starts with what it held back, so it
+            // begins that much before this frame's timestamp
+            frameStart -= m_seekOriginFrame + resamplerDelay;
+            const qint64 drop = qBound<qint64>(0, m_seekTargetFrame - frameStart, frames);
+            source += drop * OUTPUT_CHANNELS;
+            frames -= drop;
+            if (frameStart + converted < m_seekTargetFrame) {
+                return; // Whole frame lies before the target, keep looking
+            }
+        }
+        m_seekTargetFrame = -1;
+        m_nextSourceSample = -1;
+    }
+
+    if (frames > 0) {
+        writeBlock(source, frames * OUTPUT_CHANNELS);
+    }
+#endif
+}
+
+void AudioStreamDecoder::performSeek(qint64 frame)
+{
+    if (m_media) {
+        // Cached PCM is random access
+        m_mediaFrame = qMin(frame, m_media->frames);
+        m_endOfStream = false;
+        m_primed = false;
+        return;
+    }
+
+#if HAVE_FFMPEG
+    m_seekTimer.start();
+    m_nextSourceSample = -1;
+    bool seeked = false;
+
+    // Frames count from the first sample, timestamps from the container's
+    // origin (non-zero for AAC priming, Ogg granule offsets, cut streams)
+    AVStream* stream = m_formatContext->streams[m_audioStreamIndex];
+    if (m_seekIndex.isValid()) {
+        m_seekOriginFrame = av_rescale(m_seekIndex.firstSample(), m_sampleRate, m_seekIndex.sampleRate());
+    } else if (stream->start_time != AV_NOPTS_VALUE) {
+        m_seekOriginFrame = av_rescale_q(stream->start_time, stream->time_base, AVRational{1, m_sampleRate});
+    } else {
+        m_seekOriginFrame = 0;
+    }
+
+    if (m_seekIndex.isValid()) {
+        // Binary search for the packet holding the target, then step back a
+        // few packets so the decoder has settled by the time it gets there
+        const qint64 sourceSample = m_seekIndex.firstSample() + av_rescale(frame, m_seekIndex.sampleRate(), m_sampleRate);
+        const int packet = qMax(0, m_seekIndex.findPacket(sourceSample)
+                                       - AudioSeekIndex::prerollPackets(m_codecContext->codec_id));
+        const AudioSeekIndex::Entry& entry = m_seekIndex.entry(packet);
+
+        if (entry.position >= 0 && !(m_formatContext->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+            // Byte seeks are exact; the demuxer's timestamps after one are
+            // estimates, so samples are counted from the index instead
+            seeked = av_seek_frame(m_formatContext, m_audioStreamIndex, entry.position, AVSEEK_FLAG_BYTE) >= 0;
+            if (seeked) {
+                m_nextSourceSample = entry.sample;
+            }
+        } else {
+            seeked = av_seek_frame(m_formatContext, m_audioStreamIndex, entry.timestamp, AVSEEK_FLAG_BACKWARD) >= 0;
+        }
+    }
+
+    if (!seeked) {
+        const int64_t timestamp = av_rescale_q(frame + m_seekOriginFrame, AVRational{1, m_sampleRate}, stream->time_base);
+        if (av_seek_frame(m_formatContext, m_audioStreamIndex, timestamp, AVSEEK_FLAG_BACKWARD) < 0) {
+            LOG_WARNING(lcAudioDecoder) << "AudioStreamDecoder: Seek to frame" << frame << "failed";
+            emit decodeError(AudioError::DecodingFailed, "Seek failed");
+        }
+    }
+
+    avcodec_flush_buffers(m_codecContext);
+    if (m_swrContext) {
+        swr_init(m_swrContext); // Drop samples buffered inside the resampler
+    }
+
+    m_endOfStream = false;
+    m_primed = false;
+
+    m_seekTargetFrame = frame;
+#else
+    Q_UNUSED(frame)
+#endif
+}
+
+void AudioStreamDecoder::writeBlock(const float* samples, qint64 count)
+{
+    size_t written = 0;
+    while (written < static_cast<size_t>(count)) {
+        if (m_stopRequested || seekPending()) {
+            return; // The consumer drops this data, it is stale
+        }
+
+        const size_t n = m_ring.write(samples + written, static_cast<size_t>(count) - written);
+        written += n;
+        if (n == 0) {
+            idleWait();
+        }
+    }
+
+    if (!m_primed) {
+        m_primed = true;
+        if (m_seekTimer.isValid()) {
+            LOG_DEBUG(lcAudioDecoder) << "AudioStreamDecoder: Seek ready in" << m_seekTimer.nsecsElapsed() / 1.0e6 << "ms";
+            m_seekTimer.invalidate();
+        }
+        emit bufferPrimed();
+    }
+}
+
+void AudioStreamDecoder::onSeekIndexComplete()
+{
+#if HAVE_FFMPEG
+    if (!m_seekIndex.isValid()) {
+        return;
+    }
+
+    const qint64 frames = av_rescale(m_seekIndex.totalSamples(), m_sampleRate, m_seekIndex.sampleRate());
+    if (frames != m_durationFrames.load()) {
+        LOG_DEBUG(lcAudioDecoder) << "AudioStreamDecoder: Duration corrected from" << m_durationFrames.load() << "to" << frames << "frames";
+        m_durationFrames = frames;
+    }
+    emit seekIndexReady();
+#endif
+}
@@ -0,0 +1,188 @@
+#ifndef AUDIOSTREAMDECODER_H
+#define AUDIOSTREAMDECODER_H
+
+#include <QThread>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <atomic>
+#include "audioringbuffer.h"
+#include "audioseekindex.h"
+#include "realtimewake.h"
+#include "mediacache.h"
+
+#if HAVE_FFMPEG
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+#include <libavutil/avutil.h>
+}
+#endif
+
+#include "audioerror.h"
+
+// Decodes an audio file on its own thread into a bounded FIFO that runs a few
+// seconds ahead of the playhead. Memory use is fixed by the FIFO capacity and
+// does not depend on the length of the file.
+//
+// The FIFO is a lock-free SPSC ring: the decoder thread is the only producer
+// and the audio device callback the only consumer, so read() never locks,
+// allocates or blocks. The thread sleeps without a timeout once the FIFO is
+// full or the stream has ended; the consumer wakes it when it has read an
+// eighth of the FIFO, and seeks and close() wake it too.
+//
+// While the FIFO is full the thread builds a seek index for the file, after
+// which seeks go straight to the right packet and are trimmed to the exact
+// sample, and the duration is exact rather than the container's estimate.
+//
+// Files already decoded into the MediaCache at the output rate are played
+// from memory instead: the thread only copies blocks into the FIFO.
+//
+// openInBackground() opens the file on the decoder thread itself, so a mixer
+// can start decoders during playback without blocking the GUI; reads return
+// nothing until the file is open.
+class AudioStreamDecoder : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit AudioStreamDecoder(QObject *parent = nullptr);
+    ~AudioStreamDecoder() override;
+
+    // Opens the file and sets up the decoder on the calling thread, then
+    // starts the decoding thread. Any previously opened file is closed.
+    // Output is resampled to outputSampleRate (0 keeps the file's own rate).
+    AudioResult open(const QString& filePath, int outputSampleRate = 0);
+    // Returns at once; failures are reported through decodeError() and the
+    // stream then reads as ended. Decoding starts at startFrame.
+    void openInBackground(const QString& filePath, int outputSampleRate, qint64 startFrame = 0);
+    void close();
+    bool isOpen() const;
+
+    // Checks that a file has a decodable audio stream without starting a decoder
+    static AudioResult probe(const QString& filePath, qint64* durationMs = nullptr);
+
+    // Output format (interleaved stereo float32, full scale +-1.0)
+    int sampleRate() const { return m_sampleRate; }
+    int channelCount() const { return OUTPUT_CHANNELS; }
+    int bytesPerFrame() const { return OUTPUT_CHANNELS * OUTPUT_BYTES_PER_SAMPLE; }
+    qint64 durationMs() const { return m_durationMs; }
+    qint64 durationFrames() const { return m_durationFrames.load(); }
+
+    // Repositions the stream. The FIFO is refilled from the new position;
+    // bufferPrimed() is emitted once the first block is available. This is
+    // consumer side: it drops what is queued, so it must not be called while
+    // the audio callback is reading. The callback seeks through readFramesAt().
+    void seek(qint64 positionMs);
+    void seekToFrame(qint64 frame);
+
+    // Consumer side, called from the audio device callback. Takes no locks;
+    // at most it wakes the decoder thread through a RealtimeWake.
+    qint64 readFrames(float* dest, qint64 frames);
+    // Reads from frame on, so a consumer stays in step with its own clock:
+    // frames that missed their block in an underrun are skipped when they
+    // arrive, and a gap too large to skip is closed with a seek. Returns the
+    // frames copied to dest, which start at frame.
+    qint64 readFramesAt(float* dest, qint64 frame, qint64 frames);
+    qint64 bytesBuffered() const;
+    bool atEnd() const;
+
+signals:
+    void bufferPrimed();
+    void seekIndexReady(); // durationFrames() is exact from now on
+    void decodeError(AudioError error, const QString& message);
+
+protected:
+    void run() override;
+
+private:
+    AudioResult openFile(const QString& filePath, int outputSampleRate);
+    bool openOnThread();
+    void resetPosition();
+    void stopThread();
+    void releaseFFmpeg();
+    bool decodeNextPacket();
+    bool copyNextBlock();
+    void convertAndWrite();
+    void performSeek(qint64 frame);
+    void onSeekIndexComplete();
+    void writeBlock(const float* samples, qint64 count);
+    void requestSeek(qint64 frame);
+    bool seekPending() const;
+    void dropStaleSamples();
+    size_t freshAvailable() const;
+    void wakeIfRoom();
+    bool hasWork() const;
+    void idleWait();
+    size_t refillThreshold() const { return m_ring.capacity() / 8; } // Decode in batches of this many samples
+
+#if HAVE_FFMPEG
+    AVFormatContext* m_formatContext;
+    AVCodecContext* m_codecContext;
+    SwrContext* m_swrContext;
+    AVFrame* m_frame;
+    AVPacket* m_packet;
+    int m_audioStreamIndex;
+    bool m_directConvert; // Stereo at the output rate: convert with AudioKernels instead of swresample
+#endif
+
+    int m_sampleRate;
+    qint64 m_durationMs;
+    std::atomic<qint64> m_durationFrames; // Refined by the decoder thread once indexed
+    QByteArray m_convertBuffer;
+
+    // Bounded FIFO shared with the consumer (interleaved samples)
+    AudioRingBuffer<float> m_ring;
+    std::atomic<bool> m_endOfStream;
+    bool m_primed; // Decoder thread only
+
+    // Seek requests: pending while the requested generation is unhandled
+    std::atomic<qint64> m_seekRequestFrame;
+    std::atomic<qint64> m_seekHandledFrame; // Frame at m_seekWritePosition after the last handled seek
+    std::atomic<quint64> m_seekRequested;
+    std::atomic<quint64> m_seekHandled;
+    std::atomic<bool> m_stopRequested;
+    std::atomic<bool> m_ready; // The file is open and the FIFO allocated; reads wait for it
+
+    // File openInBackground() left for the decoder thread, or empty
+    QString m_openPath;
+    int m_openSampleRate = 0;
+    qint64 m_openStartFrame = 0;
+
+    // The decoder thread never rewinds the consumer's read index. It records
+    // where its writes for the last handled seek start, and the consumer
+    // drops everything queued before that.
+    std::atomic<size_t> m_seekWritePosition;
+    // Consumer only: the seek whose stale samples were dropped, and the frame
+    // the next read returns, counted from it
+    quint64 m_readGeneration;
+    qint64 m_readFrame;
+
+    // The decoder thread sleeps on this; of the consumer's signals, only the
+    // first after it fell asleep makes a system call
+    RealtimeWake m_wake;
+
+    // Cached PCM played instead of decoding, or null
+    QSharedPointer<const DecodedMedia> m_media;
+    qint64 m_mediaFrame; // Decoder thread only
+
+    // Sample the first decoded frame after a seek is trimmed to, or -1
+    qint64 m_seekTargetFrame;
+    // Output frame the stream's first sample is timestamped with; frame 0
+    // of the decoder is that sample, as in ParallelDecoder
+    qint64 m_seekOriginFrame;
+
+    // Decoder thread only
+    AudioSeekIndex m_seekIndex;
+    qint64 m_nextSourceSample; // Source sample of the next decoded frame after a byte seek, or -1
+    QElapsedTimer m_seekTimer;
+
+    static constexpr int OUTPUT_CHANNELS = 2;
+    static constexpr int OUTPUT_BYTES_PER_SAMPLE = sizeof(float);
+    static constexpr int BUFFER_AHEAD_SECONDS = 4;
+    static constexpr int INDEX_SCAN_BATCH = 512; // Packets indexed per idle slice
+    static constexpr int MEMORY_BLOCK_FRAMES = 4096; // Frames copied per batch from cached PCM
+};
+
+#endif // AUDIOSTREAMDECODER_H
@@ -1,6 +1,9 @@
 #include "ffmpegaudioengine.h"
 #include "audioiodevice.h"
-#include <QDebug>
+#include "audiostreamdecoder.h"
+#include "mediacache.h"
+#include "appconfig.h"
+#include "applog.h"
 #include <QFileInfo>
 #include <QMutexLocker>
 #include <QThread>
@@ -9,25 +12,18 @@
 
 FFmpegAudioEngine::FFmpegAudioEngine(QObject *parent)
     : QObject(parent)
+    , m_clock(AppConfig::instance().getSampleRate())
+    , m_mixer(nullptr)
     , m_audioSink(nullptr)
     , m_audioDevice(nullptr)
-    , m_audioBuffer(nullptr)
     , m_positionTimer(nullptr)
     , m_isPlaying(false)
     , m_isPaused(false)
     , m_currentPosition(0)
     , m_duration(0)
-    , m_playbackStartTime(0)
     , m_volume(1.0f)
     , m_muted(false)
-#if HAVE_FFMPEG
-    , m_formatContext(nullptr)
-    , m_codecContext(nullptr)
-    , m_swrContext(nullptr)
-    , m_audioStreamIndex(-1)
-    , m_frame(nullptr)
-    , m_packet(nullptr)
-#endif
+    , m_playPending(false)
 {
     initializeAudio();
 }
@@ -52,27 +48,29 @@ FFmpegAudioEngine::~FFmpegAudioEngine()
         m_audioDevice->deleteLater();
     }
     
-    cleanupFFmpeg();
+    // The mixer (a child object) stops its clip decoders when destroyed
 }
 
 void FFmpegAudioEngine::initializeAudio()
 {
-    qDebug() << "FFmpegAudioEngine: Initializing audio system...";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Initializing audio system...";
     
     try {
         // Initialize FFmpeg
         if (!initializeFFmpeg()) {
-            qDebug() << "FFmpegAudioEngine: Failed to initialize FFmpeg";
+            LOG_WARNING(lcAudioEngine) << "FFmpegAudioEngine: Failed to initialize FFmpeg";
             return;
         }
         
-        // Setup audio format - will be updated when loading audio file
-        m_audioFormat.setSampleRate(44100); // Default, will be overridden
-        m_audioFormat.setChannelCount(2);
+        // Setup audio format - every clip is resampled to the engine rate
+        m_audioFormat.setSampleRate(m_clock.sampleRate());
+        m_audioFormat.setChannelCount(AudioMixer::CHANNELS);
         m_audioFormat.setSampleFormat(QAudioFormat::Int16);
         
-        // Create audio buffer
-        m_audioBuffer = new QBuffer(&m_audioData, this);
+        // Create the mixer
+        m_mixer = new AudioMixer(&m_clock, this);
+        connect(m_mixer, &AudioMixer::bufferPrimed, this, &FFmpegAudioEngine::onBufferPrimed);
+        connect(m_mixer, &AudioMixer::endFrameChanged, this, &FFmpegAudioEngine::onMixerEndFrameChanged);
         
         // Create position update timer
         m_positionTimer = new QTimer(this);
@@ -81,64 +79,32 @@ void FFmpegAudioEngine::initializeAudio()
         
         // Removed m_playbackTimer - using hardware-driven callbacks instead
         
-        qDebug() << "FFmpegAudioEngine: Audio system initialized successfully";
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Audio system initialized successfully";
     } catch (const std::exception& e) {
-        qDebug() << "FFmpegAudioEngine: Exception during initialization:" << e.what();
+        LOG_WARNING(lcAudioEngine) << "FFmpegAudioEngine: Exception during initialization:" << e.what();
     } catch (...) {
-        qDebug() << "FFmpegAudioEngine: Unknown exception during initialization";
+        LOG_WARNING(lcAudioEngine) << "FFmpegAudioEngine: Unknown exception during initialization";
     }
 }
 
 bool FFmpegAudioEngine::initializeFFmpeg()
 {
 #if HAVE_FFMPEG
-    qDebug() << "FFmpegAudioEngine: Initializing FFmpeg libraries...";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Initializing FFmpeg libraries...";
     
     // Initialize FFmpeg (only needed for older versions)
     // av_register_all(); // Deprecated in newer FFmpeg versions
     
     return true;
 #else
-    qDebug() << "FFmpegAudioEngine: FFmpeg not available";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: FFmpeg not available";
     return false;
 #endif
 }
 
-void FFmpegAudioEngine::cleanupFFmpeg()
-{
-#if HAVE_FFMPEG
-    if (m_swrContext) {
-        swr_free(&m_swrContext);
-        m_swrContext = nullptr;
-    }
-    
-    if (m_codecContext) {
-        avcodec_free_context(&m_codecContext);
-        m_codecContext = nullptr;
-    }
-    
-    if (m_formatContext) {
-        avformat_close_input(&m_formatContext);
-        m_formatContext = nullptr;
-    }
-    
-    if (m_frame) {
-        av_frame_free(&m_frame);
-        m_frame = nullptr;
-    }
-    
-    if (m_packet) {
-        av_packet_free(&m_packet);
-        m_packet = nullptr;
-    }
-#endif
-}
-
 AudioResult FFmpegAudioEngine::loadAudioFile(const QString& filePath)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    qDebug() << "FFmpegAudioEngine: Loading audio file:" << filePath;
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Loading audio file:" << filePath;
     
     QFileInfo fileInfo(filePath);
     if (!fileInfo.exists()) {
@@ -147,178 +113,49 @@ AudioResult FFmpegAudioEngine::loadAudioFile(const QString& filePath)
         return AudioResult(AudioError::FileNotFound, errorMsg);
     }
     
-    // Stop current playback
-    if (m_isPlaying) {
-        stop();
-    }
-    
-    // Clean up previous audio data
-    cleanupFFmpeg();
-    m_audioData.clear();
-    
-    // Decode the audio file
-    AudioResult result = decodeAudioFile(filePath);
+    // Only check that it can be decoded here; the timeline and the waveform
+    // loader reuse this probe. The loader decodes the file into the media
+    // cache in the background; the clip decoders stream it from the file
+    // until then. It becomes audible once its clip is part of the arrangement
+    // passed to setArrangement().
+    AudioResult result = MediaCache::instance().probe(filePath);
     if (!result.isSuccess()) {
+        emit audioError(result.getError(), result.getErrorMessage());
         return result;
     }
     
-    // Setup audio output
-    setupAudioOutput();
+    if (!m_audioSink) {
+        setupAudioOutput();
+    }
     
     emit audioLoaded(filePath);
-    qDebug() << "FFmpegAudioEngine: Successfully loaded audio file:" << filePath;
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Successfully loaded audio file:" << filePath;
     
     return AudioResult(); // Success
 }
 
-AudioResult FFmpegAudioEngine::decodeAudioFile(const QString& filePath)
+void FFmpegAudioEngine::setArrangement(const MixerArrangement& arrangement)
 {
-#if HAVE_FFMPEG
-    qDebug() << "FFmpegAudioEngine: Decoding audio file with FFmpeg...";
-    
-    // Open input file
-    if (avformat_open_input(&m_formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
-        QString errorMsg = "Could not open audio file";
-        emit audioError(AudioError::DecodingFailed, errorMsg);
-        return AudioResult(AudioError::DecodingFailed, errorMsg);
-    }
-    
-    // Retrieve stream information
-    if (avformat_find_stream_info(m_formatContext, nullptr) < 0) {
-        QString errorMsg = "Could not find stream information";
-        emit audioError(AudioError::DecodingFailed, errorMsg);
-        return AudioResult(AudioError::DecodingFailed, errorMsg);
-    }
-    
-    // Find audio stream
-    m_audioStreamIndex = -1;
-    for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
-        if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
-            m_audioStreamIndex = i;
-            break;
-        }
-    }
-    
-    if (m_audioStreamIndex == -1) {
-        QString errorMsg = "Could not find audio stream";
-        emit audioError(AudioError::DecodingFailed, errorMsg);
-        return AudioResult(AudioError::DecodingFailed, errorMsg);
-    }
-    
-    // Get codec parameters
-    AVCodecParameters* codecpar = m_formatContext->streams[m_audioStreamIndex]->codecpar;
-    
-    // Find decoder
-    const AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
-    if (!codec) {
-        QString errorMsg = "Unsupported codec";
-        emit audioError(AudioError::UnsupportedFormat, errorMsg);
-        return AudioResult(AudioError::UnsupportedFormat, errorMsg);
-    }
-    
-    // Allocate codec context
-    m_codecContext = avcodec_alloc_context3(codec);
-    if (!m_codecContext) {
-        QString errorMsg = "Could not allocate codec context";
-        emit audioError(AudioError::MemoryError, errorMsg);
-        return AudioResult(AudioError::MemoryError, errorMsg);
-    }
-    
-    // Copy codec parameters to context
-    if (avcodec_parameters_to_context(m_codecContext, codecpar) < 0) {
-        QString errorMsg = "Could not copy codec parameters";
-        emit audioError(AudioError::DecodingFailed, errorMsg);
-        return AudioResult(AudioError::DecodingFailed, errorMsg);
-    }
-    
-    // Open codec
-    if (avcodec_open2(m_codecContext, codec, nullptr) < 0) {
-        QString errorMsg = "Could not open codec";
-        emit audioError(AudioError::DecodingFailed, errorMsg);
-        return AudioResult(AudioError::DecodingFailed, errorMsg);
-    }
-    
-    // Setup resampler for consistent output format (newer FFmpeg API)
-    // Use the original file's sample rate instead of forcing 44100 to prevent speed issues
-    int outputSampleRate = m_codecContext->sample_rate;
-    qDebug() << "FFmpegAudioEngine: Input sample rate:" << m_codecContext->sample_rate << "Hz";
-    qDebug() << "FFmpegAudioEngine: Output sample rate:" << outputSampleRate << "Hz";
-    
-    AVChannelLayout stereo_layout = AV_CHANNEL_LAYOUT_STEREO;
-    int ret = swr_alloc_set_opts2(&m_swrContext,
-                                  &stereo_layout, AV_SAMPLE_FMT_S16, outputSampleRate,
-                                  &m_codecContext->ch_layout, m_codecContext->sample_fmt, m_codecContext->sample_rate,
-                                  0, nullptr);
-    
-    if (ret < 0 || !m_swrContext || swr_init(m_swrContext) < 0) {
-        QString errorMsg = "Could not initialize resampler";
-        emit audioError(AudioError::DecodingFailed, errorMsg);
-        return AudioResult(AudioError::DecodingFailed, errorMsg);
-    }
-    
-    // Update audio format to match the loaded file
-    m_audioFormat.setSampleRate(outputSampleRate);
-    qDebug() << "FFmpegAudioEngine: Updated QAudioFormat sample rate to" << outputSampleRate << "Hz";
-    
-    // Calculate duration
-    if (m_formatContext->duration != AV_NOPTS_VALUE) {
-        m_duration = m_formatContext->duration / AV_TIME_BASE * 1000; // Convert to milliseconds
-        emit durationChanged(m_duration / 1000.0);
-    }
-    
-    // Allocate frame and packet
-    m_frame = av_frame_alloc();
-    m_packet = av_packet_alloc();
-    
-    if (!m_frame || !m_packet) {
-        QString errorMsg = "Could not allocate frame or packet";
-        emit audioError(AudioError::MemoryError, errorMsg);
-        return AudioResult(AudioError::MemoryError, errorMsg);
-    }
-    
-    // Decode entire file into memory for simplicity
-    qDebug() << "FFmpegAudioEngine: Decoding audio data...";
-    
-    while (av_read_frame(m_formatContext, m_packet) >= 0) {
-        if (m_packet->stream_index == m_audioStreamIndex) {
-            // Send packet to decoder
-            if (avcodec_send_packet(m_codecContext, m_packet) >= 0) {
-                // Receive frames from decoder
-                while (avcodec_receive_frame(m_codecContext, m_frame) >= 0) {
-                    // Resample to our target format
-                    uint8_t* output_buffer;
-                    int output_samples = swr_get_out_samples(m_swrContext, m_frame->nb_samples);
-                    av_samples_alloc(&output_buffer, nullptr, 2, output_samples, AV_SAMPLE_FMT_S16, 0);
-                    
-                    int converted_samples = swr_convert(m_swrContext, &output_buffer, output_samples,
-                                                       (const uint8_t**)m_frame->data, m_frame->nb_samples);
-                    
-                    if (converted_samples > 0) {
-                        int buffer_size = converted_samples * 2 * sizeof(int16_t); // 2 channels, 16-bit
-                        m_audioData.append((const char*)output_buffer, buffer_size);
-                    }
-                    
-                    av_freep(&output_buffer);
-                }
-            }
-        }
-        av_packet_unref(m_packet);
-    }
-    
-    qDebug() << "FFmpegAudioEngine: Decoded" << m_audioData.size() << "bytes of audio data";
-    qDebug() << "FFmpegAudioEngine: Duration:" << (m_duration / 1000.0) << "seconds";
+    QMutexLocker locker(&m_mutex);
     
-    return AudioResult(); // Success
-#else
-    QString errorMsg = "FFmpeg not available";
-    emit audioError(AudioError::UnsupportedFormat, errorMsg);
-    return AudioResult(AudioError::UnsupportedFormat, errorMsg);
-#endif
+    // The duration follows through endFrameChanged
+    m_mixer->setArrangement(arrangement);
+}
+
+void FFmpegAudioEngine::onMixerEndFrameChanged(qint64 frame)
+{
+    m_duration = frame * 1000 / m_clock.sampleRate();
+    emit durationChanged(m_duration / 1000.0);
+}
+
+double FFmpegAudioEngine::getDspLoad() const
+{
+    return m_mixer ? m_mixer->dspLoad() : 0.0;
 }
 
 void FFmpegAudioEngine::setupAudioOutput()
 {
-    qDebug() << "FFmpegAudioEngine: Setting up audio output...";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Setting up audio output...";
     
     // Clean up existing audio sink
     if (m_audioSink) {
@@ -333,39 +170,30 @@ void FFmpegAudioEngine::setupAudioOutput()
     
     // Connect to hardware-driven notify signal for real-time audio processing
     connect(m_audioSink, &QAudioSink::stateChanged, this, [this](QAudio::State state) {
-        qDebug() << "FFmpegAudioEngine: Audio state changed to" << state;
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Audio state changed to" << state;
     });
     
     // Create custom AudioIODevice for hardware-driven callbacks
     if (m_audioDevice) {
         delete m_audioDevice;
     }
-    m_audioDevice = new AudioIODevice(m_audioBuffer, this, this);
+    m_audioDevice = new AudioIODevice(m_mixer, this, this);
     
-    qDebug() << "FFmpegAudioEngine: QAudioSink buffer size set to" << m_audioSink->bufferSize() << "bytes";
-    qDebug() << "FFmpegAudioEngine: Audio format:" << m_audioFormat.sampleRate() << "Hz," << m_audioFormat.channelCount() << "channels," << m_audioFormat.sampleFormat();
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: QAudioSink buffer size set to" << m_audioSink->bufferSize() << "bytes";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Audio format:" << m_audioFormat.sampleRate() << "Hz," << m_audioFormat.channelCount() << "channels," << m_audioFormat.sampleFormat();
     
-    // Setup audio buffer
-    m_audioBuffer->close();
-    m_audioBuffer->setData(m_audioData);
-    m_audioBuffer->open(QIODevice::ReadOnly);
-    
-    qDebug() << "FFmpegAudioEngine: Audio buffer setup - size:" << m_audioData.size() << "bytes";
-    qDebug() << "FFmpegAudioEngine: Audio buffer open:" << m_audioBuffer->isOpen();
-    qDebug() << "FFmpegAudioEngine: Audio buffer position:" << m_audioBuffer->pos();
-    
-    qDebug() << "FFmpegAudioEngine: Audio output setup complete";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Audio output setup complete";
 }
 
 void FFmpegAudioEngine::play()
 {
     QMutexLocker locker(&m_mutex);
     
-    qDebug() << "FFmpegAudioEngine: Starting playback...";
-    qDebug() << "FFmpegAudioEngine: Current position:" << m_currentPosition << "ms";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Starting playback...";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Current position:" << m_currentPosition << "ms";
     
-    if (m_audioData.isEmpty()) {
-        qDebug() << "FFmpegAudioEngine: No audio data loaded";
+    if (!m_mixer->hasClips()) {
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: No audio data loaded";
         emit audioError(AudioError::FileNotFound, "No audio file loaded");
         return;
     }
@@ -374,42 +202,79 @@ void FFmpegAudioEngine::play()
         setupAudioOutput();
     }
     
-    // CRITICAL: Ensure audio buffer is positioned correctly before starting playback
-    if (m_audioBuffer && m_duration > 0) {
-        qint64 bytePosition = (m_currentPosition * m_audioData.size()) / m_duration;
-        m_audioBuffer->seek(bytePosition);
-        qDebug() << "FFmpegAudioEngine: Positioned audio buffer to byte" << bytePosition << "for playback from" << (m_currentPosition / 1000.0) << "seconds";
-        qDebug() << "FFmpegAudioEngine: Audio buffer position after seek:" << m_audioBuffer->pos();
+    // Resuming a pause: the sink still holds the audio queued when it was
+    // suspended, and the mixer carries on right after it
+    if (m_audioSink->state() == QAudio::SuspendedState) {
+        m_isPlaying = true;
+        m_isPaused = false;
+        m_audioDevice->unpark();
+        m_audioSink->resume();
+        m_positionTimer->start();
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Resumed playback from" << (m_currentPosition / 1000.0) << "seconds";
+        emit playbackStateChanged(true);
+        return;
     }
     
-    // Start audio output with our custom device
-    qDebug() << "FFmpegAudioEngine: Starting audio sink with custom device";
-    qDebug() << "FFmpegAudioEngine: Audio device valid:" << (m_audioDevice != nullptr);
-    qDebug() << "FFmpegAudioEngine: Audio device open:" << (m_audioDevice ? m_audioDevice->isOpen() : false);
+    // The clip decoders were already positioned by setTimelinePosition()/stop(),
+    // so playback can start as soon as they all have their first block
+    m_firstSoundTimer.start();
+    m_audioDevice->armFirstSoundProbe();
+    
+    m_isPlaying = true;
+    m_isPaused = false;
     
+    if (m_mixer->isPrimed()) {
+        startSink();
+    } else {
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Waiting for the clip decoders' first blocks";
+        m_playPending = true;
+    }
+    
+    if (m_isPlaying) {
+        emit playbackStateChanged(true);
+    }
+}
+
+void FFmpegAudioEngine::startSink()
+{
+    m_playPending = false;
+    
+    // Start audio output with our custom device
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Starting audio sink with custom device";
+    m_audioDevice->unpark();
     m_audioSink->start(m_audioDevice);
     
-    qDebug() << "FFmpegAudioEngine: Audio sink state after start:" << m_audioSink->state();
-    qDebug() << "FFmpegAudioEngine: Audio sink error:" << m_audioSink->error();
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Audio sink state after start:" << m_audioSink->state();
     
-    if (m_audioSink->state() != QAudio::ActiveState) {
-        qDebug() << "FFmpegAudioEngine: Failed to start audio sink - state:" << m_audioSink->state();
+    if (m_audioSink->state() != QAudio::ActiveState && m_audioSink->state() != QAudio::IdleState) {
+        LOG_WARNING(lcAudioEngine) << "FFmpegAudioEngine: Failed to start audio sink - state:" << m_audioSink->state();
+        m_isPlaying = false;
         emit audioError(AudioError::DeviceError, "Failed to start audio output");
+        emit playbackStateChanged(false);
         return;
     }
     
-    // Record playback start time accounting for current position
-    m_playbackStartTime = QTime::currentTime().msecsSinceStartOfDay() - m_currentPosition;
-    qDebug() << "FFmpegAudioEngine: Playback start time adjusted for position:" << m_playbackStartTime;
-    
     // Start position timer
     m_positionTimer->start();
     
-    m_isPlaying = true;
-    m_isPaused = false;
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Playback started successfully from position" << (m_currentPosition / 1000.0) << "seconds";
+}
+
+void FFmpegAudioEngine::onBufferPrimed()
+{
+    QMutexLocker locker(&m_mutex);
     
-    emit playbackStateChanged(true);
-    qDebug() << "FFmpegAudioEngine: Playback started successfully from position" << (m_currentPosition / 1000.0) << "seconds";
+    if (m_playPending && m_isPlaying && m_mixer->isPrimed()) {
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Clips primed after" << m_firstSoundTimer.elapsed() << "ms - starting sink";
+        startSink();
+    }
+}
+
+void FFmpegAudioEngine::onFirstAudioDelivered()
+{
+    double milliseconds = m_firstSoundTimer.nsecsElapsed() / 1.0e6;
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Time to first sound:" << milliseconds << "ms";
+    emit timeToFirstSound(milliseconds);
 }
 
 void FFmpegAudioEngine::stop()
@@ -419,26 +284,30 @@ void FFmpegAudioEngine::stop()
     
     QMutexLocker locker(&m_mutex);
     
-    qDebug() << "FFmpegAudioEngine: Stopping playback...";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Stopping playback...";
     
     // Set flags immediately to stop all processing
     m_isPlaying = false;
     m_isPaused = false;
+    m_playPending = false;
     
     if (m_audioSink) {
         m_audioSink->stop();
     }
+    if (m_audioDevice) {
+        m_audioDevice->park();
+    }
     
     m_currentPosition = 0;
     
-    // Reset audio buffer position
-    if (m_audioBuffer) {
-        m_audioBuffer->seek(0);
+    // Rewind the mixer so the next play() starts from the beginning
+    if (m_mixer) {
+        m_mixer->setPosition(0);
     }
     
     emit playbackStateChanged(false);
     emit positionChanged(0.0);
-    qDebug() << "FFmpegAudioEngine: Playback stopped";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Playback stopped";
 }
 
 void FFmpegAudioEngine::pause()
@@ -448,43 +317,53 @@ void FFmpegAudioEngine::pause()
     
     QMutexLocker locker(&m_mutex);
     
-    qDebug() << "FFmpegAudioEngine: Pausing playback...";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Pausing playback...";
     
     // Set flags immediately to stop all processing
     m_isPlaying = false;
     m_isPaused = true;
+    m_playPending = false;
     
     if (m_audioSink) {
         m_audioSink->suspend();
     }
+    // A suspended sink may still call back; the mixer is relocated below
+    if (m_audioDevice) {
+        m_audioDevice->park();
+    }
+    
+    // The audio still queued in the suspended sink plays on resume(), and
+    // the mixer stays where it got to; show where the sound stopped
+    m_currentPosition = m_clock.playbackFrame() * 1000 / m_clock.sampleRate();
+    emit positionChanged(m_currentPosition / 1000.0);
     
     emit playbackStateChanged(false);
-    qDebug() << "FFmpegAudioEngine: Playback paused";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Playback paused";
 }
 
 void FFmpegAudioEngine::onAudioStateChanged(QAudio::State state)
 {
-    qDebug() << "FFmpegAudioEngine: Audio state changed to" << state;
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Audio state changed to" << state;
     
     switch (state) {
     case QAudio::ActiveState:
-        qDebug() << "FFmpegAudioEngine: Audio is now active and should be playing";
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Audio is now active and should be playing";
         break;
     case QAudio::SuspendedState:
-        qDebug() << "FFmpegAudioEngine: Audio is suspended/paused";
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Audio is suspended/paused";
         break;
     case QAudio::StoppedState:
-        qDebug() << "FFmpegAudioEngine: Audio has stopped";
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Audio has stopped";
         m_isPlaying = false;
         m_positionTimer->stop();
-        emit playbackStateChanged("stopped");
+        emit playbackStateChanged(false);
         break;
     case QAudio::IdleState:
-        qDebug() << "FFmpegAudioEngine: Audio is idle - no data available or underrun";
-        qDebug() << "FFmpegAudioEngine: This usually means AudioIODevice isn't providing data";
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Audio is idle - no data available or underrun";
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: This usually means AudioIODevice isn't providing data";
         // Check if we have data available
         if (m_audioDevice) {
-            qDebug() << "FFmpegAudioEngine: AudioIODevice bytes available:" << m_audioDevice->bytesAvailable();
+            LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: AudioIODevice bytes available:" << m_audioDevice->bytesAvailable();
         }
         break;
     }
@@ -492,7 +371,7 @@ void FFmpegAudioEngine::onAudioStateChanged(QAudio::State state)
 
 void FFmpegAudioEngine::onPlaybackComplete()
 {
-    qDebug() << "FFmpegAudioEngine: Playback completed";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Playback completed";
     stop();
 }
 
@@ -502,16 +381,37 @@ void FFmpegAudioEngine::updatePosition()
         return;
     }
     
-    // Remove mutex lock to prevent blocking in timer callback
-    // Calculate position based on elapsed time
-    qint64 currentTime = QTime::currentTime().msecsSinceStartOfDay();
-    qint64 elapsedTime = currentTime - m_playbackStartTime;
+    // Pick up events flagged by the audio callback
+    if (m_audioDevice) {
+        if (m_audioDevice->takeFirstSoundDelivered()) {
+            onFirstAudioDelivered();
+        }
+        if (m_audioDevice->takeEndOfStream()) {
+            onPlaybackComplete();
+            return;
+        }
+    }
+    
+    // Free arrangement snapshots the audio thread has finished with, and
+    // bring the clips coming up into the mixer
+    if (m_mixer) {
+        m_mixer->collectGarbage();
+        m_mixer->updateWindow();
+    }
     
-    // Update position atomically
-    m_currentPosition = elapsedTime;
+    // Audio delivered to the sink but not yet played is the output latency.
+    // processedUSecs() tells how much the device has consumed, the free space
+    // how much is still queued; take whichever reports the larger backlog.
+    if (m_audioSink) {
+        const qint64 bytesPerFrame = m_audioFormat.bytesPerFrame();
+        const qint64 queuedFrames = (m_audioSink->bufferSize() - m_audioSink->bytesFree()) / bytesPerFrame;
+        const qint64 processedFrames = m_audioSink->processedUSecs() * m_clock.sampleRate() / 1000000;
+        m_clock.setOutputLatency(qMax(queuedFrames, m_clock.deliveredFrames() - processedFrames));
+    }
     
-    double seconds = elapsedTime / 1000.0;
-    qDebug() << "FFmpegAudioEngine: Position update:" << seconds << "seconds";
+    // Position comes from the frames the sink actually played
+    const double seconds = m_clock.playbackSeconds();
+    m_currentPosition = static_cast<qint64>(seconds * 1000.0);
     emit positionChanged(seconds);
 }
 
@@ -587,20 +487,29 @@ void FFmpegAudioEngine::setTimelinePosition(double seconds)
 {
     // Prevent seeking during playback to avoid feedback loop
     if (m_isPlaying) {
-        qDebug() << "FFmpegAudioEngine: Ignoring setTimelinePosition during playback to prevent feedback loop";
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Ignoring setTimelinePosition during playback to prevent feedback loop";
         return;
     }
     
-    qDebug() << "FFmpegAudioEngine: setTimelinePosition called with" << seconds << "seconds";
+    LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: setTimelinePosition called with" << seconds << "seconds";
     
-    m_currentPosition = static_cast<qint64>(seconds * 1000.0);
+    const qint64 position = static_cast<qint64>(seconds * 1000.0);
+    if (m_audioSink && m_audioSink->state() == QAudio::SuspendedState) {
+        // Paused: pause()'s own position coming back through the UI keeps
+        // the queued audio for resume(); anywhere else makes it stale
+        if (qAbs(position - m_currentPosition) <= 1) {
+            return;
+        }
+        m_audioSink->stop();
+    }
+    
+    m_currentPosition = position;
     
-    // Seek in audio buffer if possible
-    if (m_audioBuffer && m_duration > 0) {
-        qint64 bytePosition = (m_currentPosition * m_audioData.size()) / m_duration;
-        m_audioBuffer->seek(bytePosition);
-        m_playbackStartTime = QTime::currentTime().msecsSinceStartOfDay() - m_currentPosition;
-        qDebug() << "FFmpegAudioEngine: Seeked to byte position" << bytePosition;
+    // Relocate the transport; every clip decoder refills from the new position.
+    // The device is parked whenever the engine is not playing.
+    if (m_mixer) {
+        m_mixer->setPosition(m_currentPosition * m_clock.sampleRate() / 1000);
+        LOG_DEBUG(lcAudioEngine) << "FFmpegAudioEngine: Seeked mixer to" << m_currentPosition << "ms";
     }
 }
 
@@ -628,11 +537,11 @@ void FFmpegAudioEngine::setMuted(bool muted)
 
 void FFmpegAudioEngine::clearAudio()
 {
+    stop();
+    
     QMutexLocker locker(&m_mutex);
     
-    stop();
-    cleanupFFmpeg();
-    m_audioData.clear();
+    m_mixer->clear();
     m_duration = 0;
     m_currentPosition = 0;
 }
@@ -7,22 +7,15 @@
 #include <QAudioFormat>
 #include <QAudioSink>
 #include <QIODevice>
-#include <QBuffer>
-#include <QByteArray>
+#include <QElapsedTimer>
 
 // Forward declaration
 class AudioIODevice;
-
-#if HAVE_FFMPEG
-extern "C" {
-#include <libavformat/avformat.h>
-#include <libavcodec/avcodec.h>
-#include <libswresample/swresample.h>
-#include <libavutil/avutil.h>
-}
-#endif
+class AudioMixer;
 
 #include "audioerror.h"
+#include "audiomixer.h"
+#include "transportclock.h"
 
 class FFmpegAudioEngine : public QObject
 {
@@ -45,6 +38,13 @@ public:
     AudioResult loadAudioFile(const QString& filePath);
     void clearAudio();
     
+    // Multi-track playback: every clip of every track is mixed
+    void setArrangement(const MixerArrangement& arrangement);
+    double getDspLoad() const; // Render time / real time of the last callbacks
+    
+    // Single source of truth for the playback position (readable from any thread)
+    const TransportClock& transportClock() const { return m_clock; }
+    
     // Position control
     void setTimelinePosition(double seconds);
     double getCurrentPosition() const;
@@ -62,6 +62,7 @@ signals:
     void durationChanged(double seconds);
     void audioLoaded(const QString& filePath);
     void audioError(AudioError error, const QString& message);
+    void timeToFirstSound(double milliseconds);
 
 public slots:
     void onTransportPlay();
@@ -74,29 +75,25 @@ private slots:
     void updatePosition();
     void onPlaybackComplete(); // Called when audio playback finishes
     void onAudioStateChanged(QAudio::State state); // Called when QAudioSink state changes
+    void onBufferPrimed(); // A clip decoder has audio ready after open/seek
+    void onMixerEndFrameChanged(qint64 frame); // Arrangement length changed
+    void onFirstAudioDelivered(); // Called by AudioIODevice on the first non-empty read
 
 private:
     void initializeAudio();
     bool initializeFFmpeg();
-    void cleanupFFmpeg();
-    AudioResult decodeAudioFile(const QString& filePath);
     void setupAudioOutput();
+    void startSink();
+    
+    // Transport position, advanced by the audio device
+    TransportClock m_clock;
     
-    // FFmpeg components
-#if HAVE_FFMPEG
-    AVFormatContext* m_formatContext;
-    AVCodecContext* m_codecContext;
-    SwrContext* m_swrContext;
-    int m_audioStreamIndex;
-    AVFrame* m_frame;
-    AVPacket* m_packet;
-#endif
+    // Mixer rendering the arrangement into the audio device
+    AudioMixer* m_mixer;
     
     // Qt Audio components
     QAudioSink* m_audioSink;
     AudioIODevice* m_audioDevice; // Custom hardware-driven device
-    QBuffer* m_audioBuffer;
-    QByteArray m_audioData;
     QAudioFormat m_audioFormat;
     
     // Timing and position
@@ -106,11 +103,12 @@ private:
     // Audio state
     bool m_isPlaying;
     bool m_isPaused;
-    qint64 m_currentPosition; // in milliseconds
+    qint64 m_currentPosition; // in milliseconds, mirrors the transport clock
     qint64 m_duration; // in milliseconds
-    qint64 m_playbackStartTime;
     float m_volume;
     bool m_muted;
+    bool m_playPending; // play() requested before the clip decoders had data
+    QElapsedTimer m_firstSoundTimer;
     
     // Thread safety
     mutable QMutex m_mutex;
@@ -1,11 +1,25 @@
 #include "mainwindow.h"
+#include "realtimelog.h"
+#include "wakeupcounter.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    
+    // Start the audio thread's log channel before any audio runs
+    RealtimeLog::instance();
+    
+    // Wakeups of the GUI and worker threads, reported at exit (and periodically
+    // with MUSIC_APP_WAKEUP_REPORT=<seconds>); idle, there should be none
+    WakeupCounter::instance().install();
+    
     MainWindow w;
     w.show();
-    return a.exec();
+    const int result = a.exec();
+    
+    WakeupCounter::instance().report();
+    RealtimeLog::instance().shutdown();
+    return result;
 }
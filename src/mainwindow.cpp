@@ -1,9 +1,13 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 #include "../timelinewidget/timelinewidget.h"
+#include "../timelinewidget/track.h"
+#include "../timelinewidget/audioitem.h"
 #include "transportdock.h"
 #include "ffmpegaudioengine.h"
 #include "audioimportdialog.h"
+#include "wakeupcounter.h"
+#include "applog.h"
 #include <QBoxLayout>
 #include <QDateTime>
 #include <QDebug>
@@ -28,6 +32,7 @@ MainWindow::MainWindow(QWidget *parent)
     
     // Create timeline widget
     m_timelineWidget = new TimelineWidget(this);
+    m_timelineWidget->setTransportClock(&m_audioEngine->transportClock());
 
     // Create main layout
     QVBoxLayout *layout = new QVBoxLayout(ui->centralwidget);
@@ -76,10 +81,14 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_audioEngine, &FFmpegAudioEngine::positionChanged,
             m_transportDock, &TransportDock::setPosition, Qt::QueuedConnection);
     
-    // Connect audio engine position to timeline
+    // Connect audio engine position to timeline; only used while stopped, during
+    // playback the timeline follows the engine's transport clock itself
     connect(m_audioEngine, &FFmpegAudioEngine::positionChanged,
             m_timelineWidget, &TimelineWidget::setIndicatorPosition, Qt::QueuedConnection);
     
+    // Keep the engine's mix in sync with the timeline
+    connect(m_timelineWidget, &TimelineWidget::arrangementChanged, this, &MainWindow::onArrangementChanged);
+    
     // Setup menu bar
     setupMenuBar();
     
@@ -93,9 +102,17 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+void MainWindow::onArrangementChanged()
+{
+    // Coalesced by the timeline: one rebuild however many clips were added
+    m_audioEngine->setArrangement(m_timelineWidget->mixerArrangement());
+}
+
 void MainWindow::onPlayRequested()
 {
     qDebug() << "Play requested - delegating to audio engine";
+    // The engine plays what it was given; hand it any edit still pending
+    m_timelineWidget->flushArrangementChanged();
     // Start timeline movement directly like spacebar does
     m_timelineWidget->startTimelineMovement();
     // Audio engine handles this via direct connection
@@ -124,7 +141,7 @@ void MainWindow::onStopAndReturnRequested()
 
 void MainWindow::onPositionChanged(double seconds)
 {
-    qDebug() << "Position changed to:" << seconds << "seconds - delegating to audio engine";
+    LOG_TRACE(lcTransport) << "MainWindow: Position changed to" << seconds << "seconds";
     // Audio engine handles this via direct connection
 }
 
@@ -181,6 +198,15 @@ void MainWindow::onAudioEnginePlaybackStateChanged(bool isPlaying)
     // Update transport dock play/stop button state
     qDebug() << "Audio engine playback state changed to:" << (isPlaying ? "playing" : "stopped");
     
+    // Wakeups over the stretch that just ended, so idle time is reported on its own
+    WakeupCounter::instance().report();
+    
+    // While the engine plays, the playhead follows its transport clock
+    // (positionChanged) instead of the timeline's free-running timer
+    if (isPlaying) {
+        m_timelineWidget->stopTimelineMovement();
+    }
+    
     // TODO: Update transport dock button visual states
     // This could involve changing button icons or colors to reflect current state
 }
@@ -36,6 +36,7 @@ private slots:
     // Audio engine slots
     void onAudioEnginePositionChanged(double seconds);
     void onAudioEnginePlaybackStateChanged(bool isPlaying);
+    void onArrangementChanged(); // Pushes the timeline's clips and track mix to the engine
     
     // File menu actions
     void loadAudioFile();
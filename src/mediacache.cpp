@@ -0,0 +1,426 @@
+#include "mediacache.h"
+#include "appconfig.h"
+#include "applog.h"
+#include "audiokernels.h"
+#include "paralleldecoder.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+MediaCache& MediaCache::instance()
+{
+    static MediaCache instance;
+    return instance;
+}
+
+MediaCache::MediaCache()
+    : m_memoryBudget(static_cast<qint64>(AppConfig::instance().getMemoryCacheSizeMB()) * 1024 * 1024)
+    , m_memoryUsage(0)
+    , m_useCounter(0)
+{
+}
+
+bool MediaCache::makeKey(const QString& filePath, Key* key)
+{
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        return false;
+    }
+
+    key->filePath = fileInfo.absoluteFilePath();
+    key->modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    key->size = fileInfo.size();
+    return true;
+}
+
+QSharedPointer<const DecodedMedia> MediaCache::lookup(const Key& key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return {};
+    }
+    it->lastUsed = ++m_useCounter;
+    return it->media;
+}
+
+QSharedPointer<const DecodedMedia> MediaCache::find(const QString& filePath)
+{
+    Key key;
+    if (!makeKey(filePath, &key)) {
+        return {};
+    }
+
+    QMutexLocker locker(&m_mutex);
+    return lookup(key);
+}
+
+AudioResult MediaCache::probe(const QString& filePath, int* sourceRate, qint64* estimatedFrames)
+{
+    Key key;
+    if (!makeKey(filePath, &key)) {
+        return AudioResult(AudioError::FileNotFound, QString("Audio file not found: %1").arg(filePath));
+    }
+
+    Probe probe;
+    bool cached = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_probes.constFind(key);
+        if (it != m_probes.constEnd()) {
+            probe = *it;
+            cached = true;
+        }
+    }
+
+    // Opening the file is I/O, so it is done without the lock
+    if (!cached) {
+        probe.sourceRate = 0;
+        probe.estimatedFrames = 0;
+        probe.result = ParallelDecoder::probe(key.filePath, &probe.sourceRate, &probe.estimatedFrames);
+
+        QMutexLocker locker(&m_mutex);
+        // A different version of the same file is stale now
+        for (auto it = m_probes.begin(); it != m_probes.end();) {
+            if (it.key().filePath == key.filePath) {
+                it = m_probes.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        m_probes.insert(key, probe);
+    }
+
+    if (sourceRate) {
+        *sourceRate = probe.sourceRate;
+    }
+    if (estimatedFrames) {
+        *estimatedFrames = probe.estimatedFrames;
+    }
+    return probe.result;
+}
+
+QSharedPointer<const DecodedMedia> MediaCache::load(const QString& filePath, AudioResult* result,
+                                                    const ParallelDecoder::Progress& progress)
+{
+    Key key;
+    if (!makeKey(filePath, &key)) {
+        if (result) {
+            *result = AudioResult(AudioError::FileNotFound, QString("Audio file not found: %1").arg(filePath));
+        }
+        return {};
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        // Wait out another caller's load of the same version. If it failed or
+        // was cancelled nothing was inserted, and this caller tries itself.
+        while (m_loading.contains(key)) {
+            m_loadFinished.wait(&m_mutex);
+        }
+        if (QSharedPointer<const DecodedMedia> media = lookup(key)) {
+            if (result) {
+                *result = AudioResult::success();
+            }
+            return media;
+        }
+        m_loading.insert(key);
+    }
+
+    QSharedPointer<const DecodedMedia> media = loadUncached(key, result, progress);
+
+    QMutexLocker locker(&m_mutex);
+    m_loading.remove(key);
+    m_loadFinished.wakeAll();
+    return media;
+}
+
+QSharedPointer<const DecodedMedia> MediaCache::loadUncached(const Key& key, AudioResult* result,
+                                                            const ParallelDecoder::Progress& progress)
+{
+    const QString& filePath = key.filePath;
+    const int sampleRate = AppConfig::instance().getSampleRate();
+    QElapsedTimer timer;
+    timer.start();
+
+    // Decoded by an earlier run (or another instance): map it
+    if (QSharedPointer<DecodedMedia> mapped = m_diskCache.map(key.filePath, key.modified, key.size, sampleRate)) {
+        mapped->peaks = m_peakCache.map(key.filePath);
+        if (mapped->peaks.frames() != mapped->frames) {
+            mapped->peaks = PeakPyramid::build(mapped->pcm, mapped->frames);
+            const PeakPyramid peaks = mapped->peaks;
+            const QString path = key.filePath;
+            QThreadPool::globalInstance()->start([this, path, peaks, sampleRate]() {
+                m_peakCache.store(path, peaks, sampleRate);
+            });
+        }
+        LOG_DEBUG(lcAudioDecoder) << "MediaCache: Mapped" << filePath << "from the disk cache in"
+                                  << timer.nsecsElapsed() / 1.0e6 << "ms";
+        if (result) {
+            *result = AudioResult::success();
+        }
+        return publish(key, mapped);
+    }
+
+    // A file whose PCM would not fit the budget anyway never goes through memory
+    int sourceRate = 0;
+    qint64 estimatedFrames = 0;
+    const bool oversized = probe(filePath, &sourceRate, &estimatedFrames).isSuccess() && sourceRate > 0
+                           && estimatedFrames * sampleRate / sourceRate * DecodedMedia::CHANNELS
+                                      * static_cast<qint64>(sizeof(float))
+                                  > memoryBudget();
+
+    // Decode without holding the lock so other files stay available meanwhile
+    QSharedPointer<DecodedMedia> media(new DecodedMedia);
+    AudioResult decodeResult = oversized ? decodeToDisk(key, sampleRate, progress, &media)
+                                         : decode(key.filePath, sampleRate, progress, media.data());
+    if (result) {
+        *result = decodeResult;
+    }
+    if (decodeResult.getError() == AudioError::Cancelled) {
+        LOG_DEBUG(lcAudioDecoder) << "MediaCache: Decoding" << filePath << "cancelled";
+        return {};
+    }
+    if (!decodeResult.isSuccess()) {
+        LOG_WARNING(lcAudioDecoder) << "MediaCache: Could not decode" << filePath << "-" << decodeResult.getErrorMessage();
+        return {};
+    }
+
+    LOG_DEBUG(lcAudioDecoder) << "MediaCache: Decoded" << filePath << "in" << timer.elapsed() << "ms -" << media->frames
+                              << "frames," << media->pcmBytes() / (1024 * 1024) << "MiB"
+                              << (oversized ? (media->isMapped() ? "(to the disk cache)" : "(peaks only)") : "");
+
+    if (oversized) {
+        const PeakPyramid peaks = media->peaks;
+        const QString path = key.filePath;
+        QThreadPool::globalInstance()->start([this, path, peaks, sampleRate]() {
+            m_peakCache.store(path, peaks, sampleRate);
+        });
+        return publish(key, media);
+    }
+
+    // Write it to disk off the calling thread; the task keeps the PCM alive
+    // even if the memory budget drops it meanwhile
+    const qint64 modified = key.modified;
+    const qint64 size = key.size;
+    QThreadPool::globalInstance()->start([this, media, modified, size]() {
+        m_peakCache.store(media->filePath, media->peaks, media->sampleRate);
+        m_diskCache.store(*media, modified, size);
+    });
+
+    return publish(key, media);
+}
+
+AudioResult MediaCache::decodeToDisk(const Key& key, int sampleRate, const ParallelDecoder::Progress& progress,
+                                     QSharedPointer<DecodedMedia>* media)
+{
+    // Null if the disk cache is disabled or full; the peaks are still kept
+    std::unique_ptr<PcmDiskCache::Writer> writer =
+        m_diskCache.createWriter(key.filePath, sampleRate, key.modified, key.size);
+
+    // Level 0 of the peaks, built as the PCM goes by. The output arrives in
+    // arbitrary chunks, so a bucket can span several of them.
+    QVector<Peak> base;
+    float low = 0.0f;
+    float high = 0.0f;
+    double squares = 0.0;
+    qint64 bucketFrames = 0;
+    qint64 frames = 0;
+    const auto closeBucket = [&]() {
+        base.append(Peak{ low, high, static_cast<float>(std::sqrt(squares / (bucketFrames * DecodedMedia::CHANNELS))) });
+        squares = 0.0;
+        bucketFrames = 0;
+    };
+
+    const auto sink = [&](const float* samples, int count) {
+        if (writer && !writer->append(samples, count)) {
+            writer.reset(); // Discards the partial file; the peaks are still worth having
+        }
+        for (qint64 position = 0; position < count;) {
+            const qint64 n = std::min<qint64>(PeakPyramid::BASE_BUCKET_FRAMES - bucketFrames, count - position);
+            float chunkLow;
+            float chunkHigh;
+            double chunkSquares;
+            AudioKernels::peakStats(samples + position * DecodedMedia::CHANNELS,
+                                    static_cast<size_t>(n * DecodedMedia::CHANNELS), &chunkLow, &chunkHigh, &chunkSquares);
+            low = bucketFrames > 0 ? std::min(low, chunkLow) : chunkLow;
+            high = bucketFrames > 0 ? std::max(high, chunkHigh) : chunkHigh;
+            squares += chunkSquares;
+            bucketFrames += n;
+            position += n;
+            if (bucketFrames == PeakPyramid::BASE_BUCKET_FRAMES) {
+                closeBucket();
+            }
+        }
+        frames += count;
+        return true;
+    };
+
+    AudioResult result = ParallelDecoder::decodeTo(key.filePath, sampleRate, sink, progress);
+    if (!result.isSuccess()) {
+        return result;
+    }
+    if (frames == 0) {
+        return AudioResult(AudioError::DecodingFailed, "No audio could be decoded");
+    }
+    if (bucketFrames > 0) {
+        closeBucket();
+    }
+
+    if (writer && writer->commit()) {
+        *media = m_diskCache.map(key.filePath, key.modified, key.size, sampleRate);
+    }
+    if (!*media) {
+        media->reset(new DecodedMedia);
+        (*media)->filePath = key.filePath;
+        (*media)->sampleRate = sampleRate;
+        (*media)->frames = frames;
+    }
+    (*media)->peaks = PeakPyramid::fromBaseLevel(base, frames);
+    return AudioResult::success();
+}
+
+QSharedPointer<const DecodedMedia> MediaCache::publish(const Key& key, const QSharedPointer<DecodedMedia>& media)
+{
+    QVector<Dropped> dropped;
+    QSharedPointer<const DecodedMedia> published;
+    {
+        QMutexLocker locker(&m_mutex);
+        dropped = insert(key, media);
+        published = lookup(key);
+    }
+    mapDropped(dropped);
+    return published;
+}
+
+QVector<MediaCache::Dropped> MediaCache::insert(const Key& key, const QSharedPointer<DecodedMedia>& media)
+{
+    // A different version of the same file is stale now
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it.key().filePath == key.filePath) {
+            m_memoryUsage -= it->media->heapBytes();
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    m_entries.insert(key, Entry{ media, ++m_useCounter });
+    m_memoryUsage += media->heapBytes();
+    return enforceBudget();
+}
+
+QVector<MediaCache::Dropped> MediaCache::enforceBudget()
+{
+    QVector<Dropped> dropped;
+    while (m_memoryUsage > m_memoryBudget) {
+        // Least recently used entry that still holds decoded PCM
+        auto victim = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->media->heapBytes() > 0 && (victim == m_entries.end() || it->lastUsed < victim->lastUsed)) {
+                victim = it;
+            }
+        }
+        if (victim == m_entries.end()) {
+            break;
+        }
+
+        // Published media is immutable and may be playing: replace it with a
+        // copy without PCM, which mapDropped() swaps for the disk cache's
+        // mapping if it has been written. Current users keep theirs until
+        // they let go.
+        const DecodedMedia& decoded = *victim->media;
+        QSharedPointer<DecodedMedia> reduced(new DecodedMedia);
+        reduced->filePath = decoded.filePath;
+        reduced->sampleRate = decoded.sampleRate;
+        reduced->frames = decoded.frames;
+        reduced->peaks = decoded.peaks;
+
+        LOG_DEBUG(lcAudioDecoder) << "MediaCache: Dropping decoded PCM of" << decoded.filePath << "to stay within"
+                                  << m_memoryBudget / (1024 * 1024) << "MiB";
+        m_memoryUsage -= decoded.heapBytes();
+        victim->media = reduced;
+        dropped.append(Dropped{ victim.key(), reduced });
+    }
+    return dropped;
+}
+
+void MediaCache::mapDropped(const QVector<Dropped>& dropped)
+{
+    for (const Dropped& entry : dropped) {
+        QSharedPointer<DecodedMedia> mapped = m_diskCache.map(entry.key.filePath, entry.key.modified, entry.key.size,
+                                                              entry.reduced->sampleRate);
+        if (!mapped) {
+            continue;
+        }
+        mapped->peaks = entry.reduced->peaks;
+
+        // Unless the entry was replaced or dropped while the file was mapped
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(entry.key);
+        if (it != m_entries.end() && it->media == entry.reduced) {
+            it->media = mapped;
+            LOG_DEBUG(lcAudioDecoder) << "MediaCache: Mapped the dropped PCM of" << entry.key.filePath
+                                      << "from the disk cache";
+        }
+    }
+}
+
+void MediaCache::setMemoryBudget(qint64 bytes)
+{
+    QVector<Dropped> dropped;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_memoryBudget = qMax<qint64>(0, bytes);
+        dropped = enforceBudget();
+    }
+    mapDropped(dropped);
+}
+
+qint64 MediaCache::memoryBudget() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_memoryBudget;
+}
+
+qint64 MediaCache::memoryUsage() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_memoryUsage;
+}
+
+void MediaCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_probes.clear();
+    m_memoryUsage = 0;
+}
+
+AudioResult MediaCache::decode(const QString& filePath, int sampleRate, const ParallelDecoder::Progress& progress,
+                               DecodedMedia* media)
+{
+    media->filePath = filePath;
+    media->sampleRate = sampleRate;
+    media->pcm = nullptr;
+    media->peaks = PeakPyramid();
+
+    // Long files are split across all cores
+    AudioResult result = ParallelDecoder::decode(filePath, sampleRate, 0, &media->pcmBuffer, nullptr, progress);
+    if (!result.isSuccess()) {
+        return result;
+    }
+
+    media->frames = media->pcmBuffer.size() / DecodedMedia::CHANNELS;
+    if (media->frames == 0) {
+        return AudioResult(AudioError::DecodingFailed, "No audio could be decoded");
+    }
+    media->pcm = media->pcmBuffer.constData();
+
+    media->peaks = PeakPyramid::build(media->pcm, media->frames);
+    return AudioResult::success();
+}
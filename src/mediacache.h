@@ -0,0 +1,147 @@
+#ifndef MEDIACACHE_H
+#define MEDIACACHE_H
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include "audioerror.h"
+#include "paralleldecoder.h"
+#include "pcmdiskcache.h"
+#include "peakcache.h"
+#include "peakpyramid.h"
+
+// One source file decoded to the engine's output format. Immutable once
+// published, so decoders and the timeline can share it without locking.
+struct DecodedMedia {
+    QString filePath;
+    int sampleRate = 0;  // Output rate the PCM was resampled to
+    qint64 frames = 0;   // Exact length in frames at sampleRate
+    const float* pcm = nullptr; // Interleaved stereo float32, or null if it did not fit the cache budget
+    PeakPyramid peaks;    // Waveform summary for drawing
+
+    // What pcm points into: decoded in this process, or mapped from the disk cache
+    QVector<float> pcmBuffer;
+    QSharedPointer<QFile> pcmFile;
+
+    static constexpr int CHANNELS = 2;
+
+    bool hasPcm() const { return pcm != nullptr; }
+    bool isMapped() const { return !pcmFile.isNull(); }
+    double durationSeconds() const { return sampleRate > 0 ? static_cast<double>(frames) / sampleRate : 0.0; }
+    qint64 pcmBytes() const { return pcm ? frames * CHANNELS * static_cast<qint64>(sizeof(float)) : 0; }
+    qint64 heapBytes() const { return static_cast<qint64>(pcmBuffer.size()) * sizeof(float); }
+};
+
+// Process-wide cache of decoded source files, keyed by path, modification
+// time and size so an edited file is decoded again.
+//
+// A file is probed once and decoded once: import, the timeline and the loader
+// share the probe's estimate through probe(), and the playback PCM, the
+// waveform peaks and the exact duration all come from that single decode. Decoded PCM is kept
+// within a memory budget (least recently used files give theirs up first);
+// peaks and duration are small and always kept. A file whose PCM would not fit
+// the budget at all, going by the container's length estimate, is never held
+// in memory: it is decoded serially straight into the PcmDiskCache and mapped
+// from there, or kept as peaks only if the disk cache cannot take it.
+//
+// Results are also written to the PcmDiskCache and the PeakCache in the
+// background, so the next load of an unchanged file maps the PCM and peaks
+// instead of decoding it. Mapped data lives in the kernel's page cache and
+// does not count against the budget.
+class MediaCache
+{
+public:
+    static MediaCache& instance();
+
+    // Returns the cached result, or decodes the file at the engine's sample
+    // rate. Blocks while decoding; safe to call from any thread. A file being
+    // loaded by another caller is not decoded twice: later callers wait for
+    // the first one's result. progress sees the audio as it is decoded (not
+    // called for cached files, nor for callers that waited) and can cancel.
+    QSharedPointer<const DecodedMedia> load(const QString& filePath, AudioResult* result = nullptr,
+                                            const ParallelDecoder::Progress& progress = ParallelDecoder::Progress());
+
+    // Cached result only, or null; never decodes
+    QSharedPointer<const DecodedMedia> find(const QString& filePath);
+
+    // ParallelDecoder::probe() of the file, opened once per version of the
+    // file; later calls return the same result without touching it
+    AudioResult probe(const QString& filePath, int* sourceRate = nullptr, qint64* estimatedFrames = nullptr);
+
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+    qint64 memoryUsage() const;
+    void clear();
+
+    PcmDiskCache& diskCache() { return m_diskCache; }
+    PeakCache& peakCache() { return m_peakCache; }
+
+private:
+    MediaCache();
+    ~MediaCache() = default;
+    MediaCache(const MediaCache&) = delete;
+    MediaCache& operator=(const MediaCache&) = delete;
+
+    struct Key {
+        QString filePath;
+        qint64 modified;
+        qint64 size;
+
+        bool operator==(const Key& other) const
+        {
+            return filePath == other.filePath && modified == other.modified && size == other.size;
+        }
+    };
+    friend size_t qHash(const Key& key, size_t seed) { return qHashMulti(seed, key.filePath, key.modified, key.size); }
+
+    struct Entry {
+        QSharedPointer<const DecodedMedia> media;
+        quint64 lastUsed;
+    };
+
+    struct Probe {
+        AudioResult result;
+        int sourceRate;
+        qint64 estimatedFrames;
+    };
+
+    static bool makeKey(const QString& filePath, Key* key);
+    static AudioResult decode(const QString& filePath, int sampleRate, const ParallelDecoder::Progress& progress,
+                              DecodedMedia* media);
+    AudioResult decodeToDisk(const Key& key, int sampleRate, const ParallelDecoder::Progress& progress,
+                             QSharedPointer<DecodedMedia>* media);
+    QSharedPointer<const DecodedMedia> loadUncached(const Key& key, AudioResult* result,
+                                                    const ParallelDecoder::Progress& progress);
+    QSharedPointer<const DecodedMedia> lookup(const Key& key); // Caller holds m_mutex
+
+    // An entry enforceBudget() replaced with a copy without PCM. The disk
+    // cache may hold its PCM; mapping that is file I/O, so it is done by
+    // mapDropped() after the lock is released.
+    struct Dropped {
+        Key key;
+        QSharedPointer<const DecodedMedia> reduced;
+    };
+    QVector<Dropped> insert(const Key& key, const QSharedPointer<DecodedMedia>& media); // Caller holds m_mutex
+    QVector<Dropped> enforceBudget(); // Caller holds m_mutex
+    void mapDropped(const QVector<Dropped>& dropped); // Caller does not hold m_mutex
+    // insert() and mapDropped(); returns what was published
+    QSharedPointer<const DecodedMedia> publish(const Key& key, const QSharedPointer<DecodedMedia>& media);
+
+    mutable QMutex m_mutex;
+    QHash<Key, Entry> m_entries;
+    QSet<Key> m_loading;             // Being mapped or decoded by some caller
+    QHash<Key, Probe> m_probes;       // Latest version of each probed file
+    QWaitCondition m_loadFinished;   // A key left m_loading
+    qint64 m_memoryBudget;
+    qint64 m_memoryUsage;
+    quint64 m_useCounter;
+    PcmDiskCache m_diskCache;
+    PeakCache m_peakCache;
+};
+
+#endif // MEDIACACHE_H
@@ -0,0 +1,608 @@
+#include "paralleldecoder.h"
+#include "audiokernels.h"
+#include "audioseekindex.h"
+#include "applog.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <limits>
+
+#if HAVE_FFMPEG
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+#include <libavutil/avutil.h>
+}
+#endif
+
+#if HAVE_FFMPEG
+namespace {
+
+constexpr int CHANNELS = ParallelDecoder::CHANNELS;
+
+// Demuxer, codec and conversion to stereo float at the source's own rate.
+// Every segment opens its own.
+class SourceDecoder
+{
+public:
+    ~SourceDecoder()
+    {
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+        swr_free(&swrContext);
+        avcodec_free_context(&codecContext);
+        avformat_close_input(&formatContext);
+    }
+
+    AudioResult open(const QString& filePath)
+    {
+        if (avformat_open_input(&formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+            return AudioResult(AudioError::DecodingFailed, "Could not open audio file");
+        }
+        if (avformat_find_stream_info(formatContext, nullptr) < 0) {
+            return AudioResult(AudioError::DecodingFailed, "Could not find stream information");
+        }
+
+        const AVCodec* codec = nullptr;
+        streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+        if (streamIndex < 0 || !codec) {
+            return AudioResult(AudioError::UnsupportedFormat, "Could not find a decodable audio stream");
+        }
+        for (unsigned int i = 0; i < formatContext->nb_streams; ++i) {
+            if (static_cast<int>(i) != streamIndex) {
+                formatContext->streams[i]->discard = AVDISCARD_ALL;
+            }
+        }
+
+        codecContext = avcodec_alloc_context3(codec);
+        if (!codecContext) {
+            return AudioResult(AudioError::MemoryError, "Could not allocate codec context");
+        }
+        if (avcodec_parameters_to_context(codecContext, formatContext->streams[streamIndex]->codecpar) < 0
+            || avcodec_open2(codecContext, codec, nullptr) < 0) {
+            return AudioResult(AudioError::DecodingFailed, "Could not open codec");
+        }
+
+        // No rate change here, so conversion is stateless and can be split anywhere
+        const AVSampleFormat format = codecContext->sample_fmt;
+        directConvert = codecContext->ch_layout.nb_channels == CHANNELS
+                        && (format == AV_SAMPLE_FMT_S16 || format == AV_SAMPLE_FMT_S32 || format == AV_SAMPLE_FMT_FLT);
+        if (!directConvert) {
+            AVChannelLayout stereoLayout = AV_CHANNEL_LAYOUT_STEREO;
+            if (swr_alloc_set_opts2(&swrContext, &stereoLayout, AV_SAMPLE_FMT_FLT, codecContext->sample_rate,
+                                    &codecContext->ch_layout, format, codecContext->sample_rate, 0, nullptr) < 0
+                || swr_init(swrContext) < 0) {
+                return AudioResult(AudioError::DecodingFailed, "Could not initialize sample conversion");
+            }
+        }
+
+        packet = av_packet_alloc();
+        frame = av_frame_alloc();
+        if (!packet || !frame) {
+            return AudioResult(AudioError::MemoryError, "Could not allocate frame or packet");
+        }
+        return AudioResult::success();
+    }
+
+    // Converts the current frame into scratch; returns the frame count
+    int convert(QVector<float>* scratch)
+    {
+        const int frames = frame->nb_samples;
+        if (scratch->size() < frames * CHANNELS) {
+            scratch->resize(frames * CHANNELS);
+        }
+        float* output = scratch->data();
+
+        if (directConvert) {
+            const size_t samples = static_cast<size_t>(frames) * CHANNELS;
+            switch (codecContext->sample_fmt) {
+            case AV_SAMPLE_FMT_S16:
+                AudioKernels::s16ToFloat(reinterpret_cast<const qint16*>(frame->data[0]), output, samples);
+                break;
+            case AV_SAMPLE_FMT_S32:
+                AudioKernels::s32ToFloat(reinterpret_cast<const qint32*>(frame->data[0]), output, samples);
+                break;
+            default:
+                std::copy_n(reinterpret_cast<const float*>(frame->data[0]), samples, output);
+                break;
+            }
+            return frames;
+        }
+
+        uint8_t* outputBytes = reinterpret_cast<uint8_t*>(output);
+        return qMax(0, swr_convert(swrContext, &outputBytes, frames,
+                                   const_cast<const uint8_t**>(frame->extended_data), frames));
+    }
+
+    AVFormatContext* formatContext = nullptr;
+    AVCodecContext* codecContext = nullptr;
+    SwrContext* swrContext = nullptr;
+    AVPacket* packet = nullptr;
+    AVFrame* frame = nullptr;
+    int streamIndex = -1;
+    bool directConvert = false;
+};
+
+constexpr qint64 UNBOUNDED = std::numeric_limits<qint64>::max();
+
+struct Segment {
+    int firstPacket = 0; // Decoding starts here, preroll included
+    qint64 begin = 0;    // Kept range in index samples; the first segment keeps everything before end
+    qint64 end = UNBOUNDED;
+    QVector<float> samples;
+    qint64 next = 0; // Position after the last kept sample
+    bool started = false;
+    AudioResult result;
+    int sourceRate = 0;
+    ParallelDecoder::Sink sink; // Takes the kept audio instead of samples, if set
+};
+
+bool packetMatches(const AVPacket* packet, const AudioSeekIndex::Entry& entry)
+{
+    return entry.position >= 0 && packet->pos >= 0 ? packet->pos == entry.position : packet->pts == entry.timestamp;
+}
+
+bool packetBeyond(const AVPacket* packet, const AudioSeekIndex::Entry& entry)
+{
+    return entry.position >= 0 && packet->pos >= 0 ? packet->pos > entry.position : packet->pts > entry.timestamp;
+}
+
+// Decodes one segment. Without an index the whole file is decoded and
+// positions are simply counted (the serial path). With one, every packet is
+// matched against the index and stamped with its indexed timestamp, so frame
+// positions are exact even where the demuxer's timestamps are estimates.
+void decodeSegment(const QString& filePath, const AudioSeekIndex* index, const ParallelDecoder::Progress& progress,
+                   Segment* segment)
+{
+    SourceDecoder decoder;
+    segment->result = decoder.open(filePath);
+    if (!segment->result.isSuccess()) {
+        return;
+    }
+    segment->sourceRate = decoder.codecContext->sample_rate;
+
+    AVStream* stream = decoder.formatContext->streams[decoder.streamIndex];
+    const AVRational sampleBase{ 1, index ? index->sampleRate() : decoder.codecContext->sample_rate };
+    auto fail = [segment](const char* message) { segment->result = AudioResult(AudioError::DecodingFailed, message); };
+
+    int nextEntry = segment->firstPacket;
+    bool synced = nextEntry == 0;
+    if (!synced) {
+        const AudioSeekIndex::Entry& entry = index->entry(nextEntry);
+        const bool byteSeek = entry.position >= 0 && !(decoder.formatContext->iformat->flags & AVFMT_NO_BYTE_SEEK);
+        const int ret = byteSeek ? av_seek_frame(decoder.formatContext, decoder.streamIndex, entry.position, AVSEEK_FLAG_BYTE)
+                                 : av_seek_frame(decoder.formatContext, decoder.streamIndex, entry.timestamp, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            fail("Seek failed");
+            return;
+        }
+    }
+
+    // Reserve the expected length so a long segment is not regrown repeatedly
+    qint64 expectedFrames = 0;
+    if (segment->end != UNBOUNDED) {
+        expectedFrames = segment->end - segment->begin;
+    } else if (decoder.formatContext->duration != AV_NOPTS_VALUE) {
+        expectedFrames = av_rescale(decoder.formatContext->duration, segment->sourceRate, AV_TIME_BASE) - segment->begin;
+    }
+    if (expectedFrames > 0 && !segment->sink) {
+        segment->samples.reserve((expectedFrames + segment->sourceRate) * CHANNELS);
+    }
+
+    QVector<float> scratch;
+    qint64 expected = 0;
+    bool haveExpected = false;
+    bool done = false;
+
+    auto receiveFrames = [&]() {
+        while (avcodec_receive_frame(decoder.codecContext, decoder.frame) >= 0) {
+            if (done || !segment->result.isSuccess()) {
+                continue; // Drain
+            }
+
+            const int frames = decoder.convert(&scratch);
+            qint64 start = expected;
+            if (index) {
+                if (decoder.frame->pts == AV_NOPTS_VALUE) {
+                    fail("Frame without timestamp");
+                    continue;
+                }
+                start = av_rescale_q(decoder.frame->pts, stream->time_base, sampleBase);
+                if (haveExpected && start != expected) {
+                    fail("Discontinuous timestamps");
+                    continue;
+                }
+            }
+            expected = start + frames;
+            haveExpected = true;
+
+            const bool first = segment->firstPacket == 0;
+            const qint64 from = first ? 0 : qBound<qint64>(0, segment->begin - start, frames);
+            const qint64 to = segment->end == UNBOUNDED ? frames : qBound<qint64>(0, segment->end - start, frames);
+            if (to > from) {
+                if (!segment->started) {
+                    // A later segment must start exactly on its boundary
+                    if (!first && start + from != segment->begin) {
+                        fail("Segment does not start on its boundary");
+                        continue;
+                    }
+                    segment->started = true;
+                }
+                if (segment->sink) {
+                    if (!segment->sink(scratch.constData() + from * CHANNELS, static_cast<int>(to - from))) {
+                        segment->result = AudioResult(AudioError::Cancelled, "Decoding cancelled");
+                        continue;
+                    }
+                } else {
+                    const qsizetype offset = segment->samples.size();
+                    segment->samples.resize(offset + (to - from) * CHANNELS);
+                    std::copy_n(scratch.constData() + from * CHANNELS, (to - from) * CHANNELS,
+                                segment->samples.data() + offset);
+                }
+                segment->next = start + to;
+
+                const qint64 origin = index ? index->firstSample() : 0;
+                if (progress && !progress(start + from - origin, scratch.constData() + from * CHANNELS,
+                                          static_cast<int>(to - from))) {
+                    segment->result = AudioResult(AudioError::Cancelled, "Decoding cancelled");
+                    continue;
+                }
+            }
+            if (segment->end != UNBOUNDED && start + frames >= segment->end) {
+                done = true;
+            }
+        }
+    };
+
+    AVPacket* packet = decoder.packet;
+    while (!done && segment->result.isSuccess() && av_read_frame(decoder.formatContext, packet) >= 0) {
+        if (packet->stream_index != decoder.streamIndex) {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        if (index) {
+            if (!synced) {
+                // The seek may land a little early; skip up to the first packet of the segment
+                const AudioSeekIndex::Entry& entry = index->entry(nextEntry);
+                if (packetBeyond(packet, entry)) {
+                    fail("Seek overshot the segment");
+                    av_packet_unref(packet);
+                    break;
+                }
+                synced = packetMatches(packet, entry);
+                if (!synced) {
+                    av_packet_unref(packet);
+                    continue;
+                }
+            }
+            if (nextEntry >= index->size() || !packetMatches(packet, index->entry(nextEntry))) {
+                fail("Packet not in the index");
+                av_packet_unref(packet);
+                break;
+            }
+            packet->pts = packet->dts = index->entry(nextEntry).timestamp;
+            ++nextEntry;
+        }
+
+        if (avcodec_send_packet(decoder.codecContext, packet) >= 0) {
+            receiveFrames();
+        }
+        av_packet_unref(packet);
+    }
+
+    if (!done && segment->result.isSuccess()) {
+        avcodec_send_packet(decoder.codecContext, nullptr);
+        receiveFrames();
+    }
+
+    if (segment->result.isSuccess() && segment->end != UNBOUNDED && segment->next != segment->end) {
+        fail("Segment ended before its boundary");
+    }
+}
+
+// Picks segment boundaries on indexed packets; empty if the file is too short
+QVector<Segment> planSegments(const AudioSeekIndex& index, int segments, AVCodecID codecId)
+{
+    const qint64 total = index.totalSamples();
+    const qint64 minimum = static_cast<qint64>(ParallelDecoder::MIN_SEGMENT_SECONDS) * index.sampleRate();
+    segments = static_cast<int>(qMin<qint64>(segments, total / qMax<qint64>(1, minimum)));
+    if (segments < 2) {
+        return {};
+    }
+
+    const int basePreroll = AudioSeekIndex::prerollPackets(codecId);
+    const int preroll = basePreroll > 0 ? basePreroll + ParallelDecoder::SEGMENT_EXTRA_PREROLL : 0;
+
+    QVector<Segment> plan(1);
+    int previousPacket = 0;
+    for (int k = 1; k < segments; ++k) {
+        const int packet = index.findPacket(index.firstSample() + total * k / segments);
+        if (packet <= previousPacket || packet - preroll <= 0) {
+            continue;
+        }
+        previousPacket = packet;
+        plan.last().end = index.entry(packet).sample;
+
+        Segment segment;
+        segment.firstPacket = qMax(0, packet - preroll);
+        segment.begin = index.entry(packet).sample;
+        plan.append(segment);
+    }
+    return plan.size() > 1 ? plan : QVector<Segment>();
+}
+
+AudioResult resample(const QVector<float>& input, int inputRate, int outputRate, QVector<float>* output)
+{
+    SwrContext* swrContext = nullptr;
+    AVChannelLayout stereoLayout = AV_CHANNEL_LAYOUT_STEREO;
+    if (swr_alloc_set_opts2(&swrContext, &stereoLayout, AV_SAMPLE_FMT_FLT, outputRate,
+                            &stereoLayout, AV_SAMPLE_FMT_FLT, inputRate, 0, nullptr) < 0
+        || swr_init(swrContext) < 0) {
+        swr_free(&swrContext);
+        return AudioResult(AudioError::DecodingFailed, "Could not initialize resampler");
+    }
+
+    const qint64 inputFrames = input.size() / CHANNELS;
+    output->clear();
+    output->reserve((av_rescale(inputFrames, outputRate, inputRate) + 1024) * CHANNELS);
+
+    constexpr int CHUNK_FRAMES = 65536;
+    for (qint64 position = 0; ; position += CHUNK_FRAMES) {
+        // The pass after the last chunk has no input and flushes the resampler
+        const int frames = static_cast<int>(qBound<qint64>(0, inputFrames - position, CHUNK_FRAMES));
+        const uint8_t* inputBytes = frames > 0 ? reinterpret_cast<const uint8_t*>(input.constData() + position * CHANNELS) : nullptr;
+        const int capacity = swr_get_out_samples(swrContext, frames);
+        if (capacity <= 0) {
+            if (frames == 0) {
+                break;
+            }
+            continue;
+        }
+
+        const qsizetype offset = output->size();
+        output->resize(offset + static_cast<qsizetype>(capacity) * CHANNELS);
+        uint8_t* outputBytes = reinterpret_cast<uint8_t*>(output->data() + offset);
+        const int converted = swr_convert(swrContext, &outputBytes, capacity, frames > 0 ? &inputBytes : nullptr, frames);
+        output->resize(offset + static_cast<qsizetype>(qMax(0, converted)) * CHANNELS);
+        if (frames == 0) {
+            break;
+        }
+    }
+
+    swr_free(&swrContext);
+    return AudioResult::success();
+}
+
+// Resamples a stream chunk by chunk and hands each result on
+class StreamResampler
+{
+public:
+    ~StreamResampler() { swr_free(&m_context); }
+
+    AudioResult open(int inputRate, int outputRate)
+    {
+        AVChannelLayout stereoLayout = AV_CHANNEL_LAYOUT_STEREO;
+        if (swr_alloc_set_opts2(&m_context, &stereoLayout, AV_SAMPLE_FMT_FLT, outputRate,
+                                &stereoLayout, AV_SAMPLE_FMT_FLT, inputRate, 0, nullptr) < 0
+            || swr_init(m_context) < 0) {
+            return AudioResult(AudioError::DecodingFailed, "Could not initialize resampler");
+        }
+        return AudioResult::success();
+    }
+
+    // No input flushes what the resampler still holds
+    bool push(const float* samples, int frames, const ParallelDecoder::Sink& sink)
+    {
+        const int capacity = swr_get_out_samples(m_context, frames);
+        if (capacity <= 0) {
+            return true;
+        }
+        if (m_output.size() < static_cast<qsizetype>(capacity) * CHANNELS) {
+            m_output.resize(static_cast<qsizetype>(capacity) * CHANNELS);
+        }
+        uint8_t* outputBytes = reinterpret_cast<uint8_t*>(m_output.data());
+        const uint8_t* inputBytes = reinterpret_cast<const uint8_t*>(samples);
+        const int converted = swr_convert(m_context, &outputBytes, capacity, frames > 0 ? &inputBytes : nullptr, frames);
+        return converted <= 0 || sink(m_output.constData(), converted);
+    }
+
+private:
+    SwrContext* m_context = nullptr;
+    QVector<float> m_output;
+};
+
+} // namespace
+#endif // HAVE_FFMPEG
+
+AudioResult ParallelDecoder::decode(const QString& filePath, int sampleRate, int segments, QVector<float>* output,
+                                    int* segmentsUsed, const Progress& progress)
+{
+    if (segmentsUsed) {
+        *segmentsUsed = 1;
+    }
+
+#if HAVE_FFMPEG
+    if (segments <= 0) {
+        segments = QThread::idealThreadCount();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<Segment> plan;
+    int sourceRate = 0;
+    int used = 1;
+    AudioSeekIndex index;
+
+    if (segments > 1) {
+        // Packet boundaries come from reading the headers of every packet once,
+        // which is cheap next to decoding them
+        AVCodecID codecId = AV_CODEC_ID_NONE;
+        {
+            SourceDecoder probe;
+            if (probe.open(filePath).isSuccess()) {
+                codecId = probe.codecContext->codec_id;
+            }
+        }
+        index.reset(filePath);
+        while (!index.scan(4096)) {
+        }
+        if (index.isValid()) {
+            plan = planSegments(index, segments, codecId);
+        }
+    }
+
+    QVector<float> native;
+    if (!plan.isEmpty()) {
+        QThreadPool pool;
+        pool.setMaxThreadCount(plan.size());
+        for (Segment& segment : plan) {
+            Segment* target = &segment;
+            const AudioSeekIndex* segmentIndex = &index;
+            pool.start([filePath, segmentIndex, &progress, target]() {
+                decodeSegment(filePath, segmentIndex, progress, target);
+            });
+        }
+        pool.waitForDone();
+
+        bool stitched = true;
+        qsizetype totalSamples = 0;
+        for (const Segment& segment : plan) {
+            if (segment.result.getError() == AudioError::Cancelled) {
+                return segment.result;
+            }
+            if (!segment.result.isSuccess()) {
+                LOG_DEBUG(lcAudioDecoder) << "ParallelDecoder: Falling back to serial decode -"
+                                          << segment.result.getErrorMessage();
+                stitched = false;
+                break;
+            }
+            totalSamples += segment.samples.size();
+        }
+
+        if (stitched) {
+            native.reserve(totalSamples);
+            for (Segment& segment : plan) {
+                native.append(segment.samples);
+                segment.samples = QVector<float>();
+            }
+            sourceRate = plan.first().sourceRate;
+            used = plan.size();
+        }
+    }
+
+    if (sourceRate == 0) {
+        Segment whole;
+        decodeSegment(filePath, nullptr, progress, &whole);
+        if (!whole.result.isSuccess()) {
+            return whole.result;
+        }
+        native = std::move(whole.samples);
+        sourceRate = whole.sourceRate;
+    }
+
+    if (segmentsUsed) {
+        *segmentsUsed = used;
+    }
+    LOG_DEBUG(lcAudioDecoder) << "ParallelDecoder: Decoded" << native.size() / CHANNELS << "frames in" << used
+                              << "segment(s) in" << timer.elapsed() << "ms";
+
+    if (sourceRate == sampleRate) {
+        *output = std::move(native);
+        return AudioResult::success();
+    }
+    return resample(native, sourceRate, sampleRate, output);
+#else
+    Q_UNUSED(filePath)
+    Q_UNUSED(sampleRate)
+    Q_UNUSED(segments)
+    Q_UNUSED(output)
+    Q_UNUSED(progress)
+    return AudioResult(AudioError::UnsupportedFormat, "FFmpeg not available");
+#endif
+}
+
+AudioResult ParallelDecoder::decodeTo(const QString& filePath, int sampleRate, const Sink& sink, const Progress& progress)
+{
+#if HAVE_FFMPEG
+    QElapsedTimer timer;
+    timer.start();
+
+    // The source rate is known once the segment has opened the file, before
+    // its first output
+    Segment whole;
+    StreamResampler resampler;
+    AudioResult resamplerResult = AudioResult::success();
+    bool started = false;
+    bool direct = false;
+    whole.sink = [&](const float* samples, int frames) {
+        if (!started) {
+            started = true;
+            direct = whole.sourceRate == sampleRate;
+            if (!direct) {
+                resamplerResult = resampler.open(whole.sourceRate, sampleRate);
+                if (!resamplerResult.isSuccess()) {
+                    return false;
+                }
+            }
+        }
+        return direct ? sink(samples, frames) : resampler.push(samples, frames, sink);
+    };
+
+    decodeSegment(filePath, nullptr, progress, &whole);
+    if (!resamplerResult.isSuccess()) {
+        return resamplerResult;
+    }
+    if (!whole.result.isSuccess()) {
+        return whole.result;
+    }
+    if (started && !direct && !resampler.push(nullptr, 0, sink)) {
+        return AudioResult(AudioError::Cancelled, "Decoding cancelled");
+    }
+
+    LOG_DEBUG(lcAudioDecoder) << "ParallelDecoder: Streamed" << whole.next << "frames in" << timer.elapsed() << "ms";
+    return AudioResult::success();
+#else
+    Q_UNUSED(filePath)
+    Q_UNUSED(sampleRate)
+    Q_UNUSED(sink)
+    Q_UNUSED(progress)
+    return AudioResult(AudioError::UnsupportedFormat, "FFmpeg not available");
+#endif
+}
+
+AudioResult ParallelDecoder::probe(const QString& filePath, int* sourceRate, qint64* estimatedFrames)
+{
+#if HAVE_FFMPEG
+    SourceDecoder decoder;
+    AudioResult result = decoder.open(filePath);
+    if (!result.isSuccess()) {
+        return result;
+    }
+
+    const int rate = decoder.codecContext->sample_rate;
+    const AVStream* stream = decoder.formatContext->streams[decoder.streamIndex];
+    qint64 frames = 0;
+    if (stream->duration != AV_NOPTS_VALUE) {
+        frames = av_rescale_q(stream->duration, stream->time_base, AVRational{ 1, rate });
+    } else if (decoder.formatContext->duration != AV_NOPTS_VALUE) {
+        frames = av_rescale(decoder.formatContext->duration, rate, AV_TIME_BASE);
+    }
+
+    if (sourceRate) {
+        *sourceRate = rate;
+    }
+    if (estimatedFrames) {
+        *estimatedFrames = frames;
+    }
+    return AudioResult::success();
+#else
+    Q_UNUSED(filePath)
+    Q_UNUSED(sourceRate)
+    Q_UNUSED(estimatedFrames)
+    return AudioResult(AudioError::UnsupportedFormat, "FFmpeg not available");
+#endif
+}
@@ -0,0 +1,57 @@
+#ifndef PARALLELDECODER_H
+#define PARALLELDECODER_H
+
+#include <QString>
+#include <QVector>
+#include <functional>
+#include "audioerror.h"
+
+// Decodes a whole file to interleaved stereo float32 at a given rate.
+//
+// Long files are split at packet boundaries taken from an AudioSeekIndex
+// and the segments are decoded concurrently, each with its own demuxer and
+// codec. A segment starts decoding a few packets early so the codec state
+// (MP3's bit reservoir, MDCT overlap, filterbank history) has settled by its
+// first output sample, and is trimmed to its range by sample position. The
+// first segment keeps the encoder priming handling and the last one the end
+// padding, exactly as a serial decode does. Resampling to the output rate is
+// one pass over the stitched result, so the output matches the serial decode
+// bit for bit whenever the preroll is long enough.
+//
+// Files without a usable index, or segments whose packets or timestamps do
+// not line up with it, fall back to a serial decode.
+class ParallelDecoder
+{
+public:
+    // Receives audio as it is decoded: frames of interleaved stereo at the
+    // source rate, starting at frame. Positions are exact for a serial decode
+    // and within a few milliseconds for a parallel one. Called from the
+    // decoding threads, possibly concurrently; returning false cancels the
+    // decode, which then fails with AudioError::Cancelled.
+    using Progress = std::function<bool(qint64 frame, const float* samples, int frames)>;
+
+    // Receives the output of decodeTo() in order: frames of interleaved stereo
+    // at the output rate. Returning false cancels the decode.
+    using Sink = std::function<bool(const float* samples, int frames)>;
+
+    // segments <= 0 uses one per core; 1 decodes serially. segmentsUsed
+    // receives the number of segments actually decoded in parallel (1 when
+    // serial).
+    static AudioResult decode(const QString& filePath, int sampleRate, int segments, QVector<float>* output,
+                              int* segmentsUsed = nullptr, const Progress& progress = Progress());
+
+    // Serial decode that hands the output to sink as it goes instead of
+    // keeping it, for files too long to hold in memory. progress is as for
+    // decode().
+    static AudioResult decodeTo(const QString& filePath, int sampleRate, const Sink& sink,
+                                const Progress& progress = Progress());
+
+    // Source rate and the container's length estimate, without decoding
+    static AudioResult probe(const QString& filePath, int* sourceRate, qint64* estimatedFrames);
+
+    static constexpr int CHANNELS = 2;
+    static constexpr int MIN_SEGMENT_SECONDS = 20; // Shorter segments are not worth a decoder each
+    static constexpr int SEGMENT_EXTRA_PREROLL = 8; // Packets beyond the seek preroll, for bit-exact output
+};
+
+#endif // PARALLELDECODER_H
@@ -0,0 +1,228 @@
+#include "pcmdiskcache.h"
+#include "mediacache.h"
+#include "appconfig.h"
+#include "applog.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+PcmDiskCache::PcmDiskCache()
+    : m_directory(AppConfig::instance().getPcmCachePath())
+    , m_sizeLimit(static_cast<qint64>(AppConfig::instance().getPcmCacheSizeMB()) * 1024 * 1024)
+{
+}
+
+QString PcmDiskCache::directory() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_directory;
+}
+
+void PcmDiskCache::setDirectory(const QString& directory)
+{
+    QMutexLocker locker(&m_mutex);
+    m_directory = directory;
+}
+
+qint64 PcmDiskCache::sizeLimit() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_sizeLimit;
+}
+
+void PcmDiskCache::setSizeLimit(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_sizeLimit = qMax<qint64>(0, bytes);
+}
+
+QString PcmDiskCache::entryPath(const QString& sourcePath, int sampleRate) const
+{
+    // One entry per source and output rate; the source version lives in the header
+    const QByteArray hash = QCryptographicHash::hash((sourcePath + '@' + QString::number(sampleRate)).toUtf8(),
+                                                     QCryptographicHash::Sha1).toHex();
+    return directory() + '/' + QString::fromLatin1(hash) + ".pcm";
+}
+
+QSharedPointer<DecodedMedia> PcmDiskCache::map(const QString& sourcePath, qint64 sourceModified, qint64 sourceSize,
+                                               int sampleRate)
+{
+    const QString path = entryPath(sourcePath, sampleRate);
+    QSharedPointer<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    Header header;
+    const bool headerValid = file->read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header)
+                             && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+                             && header.version == VERSION
+                             && header.channels == DecodedMedia::CHANNELS
+                             && header.sampleRate == static_cast<quint32>(sampleRate)
+                             && header.frames > 0;
+    if (!headerValid || header.sourceSize != sourceSize || header.sourceModified != sourceModified) {
+        LOG_DEBUG(lcAudioDecoder) << "PcmDiskCache: Discarding stale entry for" << sourcePath;
+        file->close();
+        QFile::remove(path);
+        return {};
+    }
+
+    const qint64 pcmBytes = header.frames * DecodedMedia::CHANNELS * static_cast<qint64>(sizeof(float));
+    if (file->size() < DATA_OFFSET + pcmBytes) {
+        file->close();
+        QFile::remove(path);
+        return {};
+    }
+
+    uchar* data = file->map(DATA_OFFSET, pcmBytes);
+    if (!data) {
+        LOG_WARNING(lcAudioDecoder) << "PcmDiskCache: Could not map" << path << "-" << file->errorString();
+        return {};
+    }
+
+    QSharedPointer<DecodedMedia> media(new DecodedMedia);
+    media->filePath = sourcePath;
+    media->sampleRate = sampleRate;
+    media->frames = header.frames;
+    media->pcm = reinterpret_cast<const float*>(data);
+    media->pcmFile = file;
+
+    // Recently used entries are evicted last. The mapping's handle is read
+    // only, and Windows sets file times only through a writable one.
+    QFile touch(path);
+    if (!touch.open(QIODevice::ReadWrite)
+        || !touch.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime)) {
+        LOG_DEBUG(lcAudioDecoder) << "PcmDiskCache: Could not update the access time of" << path << "-"
+                                  << touch.errorString();
+    }
+    return media;
+}
+
+bool PcmDiskCache::store(const DecodedMedia& media, qint64 sourceModified, qint64 sourceSize)
+{
+    if (!media.hasPcm()) {
+        return false;
+    }
+
+    std::unique_ptr<Writer> writer = createWriter(media.filePath, media.sampleRate, sourceModified, sourceSize);
+    return writer && writer->append(media.pcm, media.frames) && writer->commit();
+}
+
+std::unique_ptr<PcmDiskCache::Writer> PcmDiskCache::createWriter(const QString& sourcePath, int sampleRate,
+                                                                 qint64 sourceModified, qint64 sourceSize)
+{
+    if (sizeLimit() <= 0) {
+        return {};
+    }
+
+    const QString path = entryPath(sourcePath, sampleRate);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        return {};
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.channels = DecodedMedia::CHANNELS;
+    header.sampleRate = static_cast<quint32>(sampleRate);
+    header.reserved = 0;
+    header.frames = 0;
+    header.sourceSize = sourceSize;
+    header.sourceModified = sourceModified;
+
+    std::unique_ptr<Writer> writer(new Writer(this, sourcePath, path, header));
+    if (writer->m_failed) {
+        return {};
+    }
+    return writer;
+}
+
+PcmDiskCache::Writer::Writer(PcmDiskCache* cache, const QString& sourcePath, const QString& path, const Header& header)
+    : m_cache(cache)
+    , m_sourcePath(sourcePath)
+    , m_path(path)
+    , m_file(path)
+    , m_header(header)
+    , m_failed(false)
+{
+    // QSaveFile writes a temporary file and renames it into place on commit.
+    // The header block is written again once the length is known.
+    m_failed = !m_file.open(QIODevice::WriteOnly)
+               || m_file.write(QByteArray(DATA_OFFSET, '\0')) != DATA_OFFSET;
+}
+
+bool PcmDiskCache::Writer::append(const float* samples, qint64 frames)
+{
+    const qint64 bytes = frames * DecodedMedia::CHANNELS * static_cast<qint64>(sizeof(float));
+    if (m_failed || m_file.write(reinterpret_cast<const char*>(samples), bytes) != bytes) {
+        m_failed = true;
+        return false;
+    }
+    m_header.frames += frames;
+    return true;
+}
+
+bool PcmDiskCache::Writer::commit()
+{
+    if (m_failed || m_header.frames <= 0 || !m_file.seek(0)
+        || m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header)) != sizeof(m_header)) {
+        m_file.cancelWriting();
+        m_failed = true;
+        return false;
+    }
+    if (!m_file.commit()) {
+        LOG_WARNING(lcAudioDecoder) << "PcmDiskCache: Could not write" << m_path << "-" << m_file.errorString();
+        m_failed = true;
+        return false;
+    }
+
+    const qint64 pcmBytes = m_header.frames * DecodedMedia::CHANNELS * static_cast<qint64>(sizeof(float));
+    LOG_DEBUG(lcAudioDecoder) << "PcmDiskCache: Stored" << m_sourcePath << "(" << pcmBytes / (1024 * 1024) << "MiB)";
+    m_cache->evict(m_path);
+    return true;
+}
+
+void PcmDiskCache::remove(const QString& sourcePath, int sampleRate)
+{
+    QFile::remove(entryPath(sourcePath, sampleRate));
+}
+
+qint64 PcmDiskCache::diskUsage() const
+{
+    qint64 total = 0;
+    const QFileInfoList entries = QDir(directory()).entryInfoList({ "*.pcm" }, QDir::Files);
+    for (const QFileInfo& entry : entries) {
+        total += entry.size();
+    }
+    return total;
+}
+
+void PcmDiskCache::evict(const QString& keepPath)
+{
+    QFileInfoList entries = QDir(directory()).entryInfoList({ "*.pcm" }, QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 total = 0;
+    for (const QFileInfo& entry : entries) {
+        total += entry.size();
+    }
+
+    // Oldest first; mapped entries on Unix stay valid for their users after removal
+    const qint64 limit = sizeLimit();
+    for (const QFileInfo& entry : entries) {
+        if (total <= limit) {
+            break;
+        }
+        if (entry.absoluteFilePath() == QFileInfo(keepPath).absoluteFilePath()) {
+            continue;
+        }
+        if (QFile::remove(entry.absoluteFilePath())) {
+            LOG_DEBUG(lcAudioDecoder) << "PcmDiskCache: Evicted" << entry.fileName();
+            total -= entry.size();
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef PCMDISKCACHE_H
+#define PCMDISKCACHE_H
+
+#include <QMutex>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QString>
+#include <memory>
+
+struct DecodedMedia;
+
+// Decoded PCM kept on disk so files need decoding only once, ever.
+//
+// Each entry is one file: a fixed header and the interleaved float32 PCM (the
+// waveform peaks live in the PeakCache). Later loads memory-map it, so the
+// kernel's page cache does the reading, nothing is decoded or copied, and
+// several running instances share the same pages. Entries record the source's
+// size and modification time and are discarded when the source changes. The
+// directory is kept under a size limit by deleting the least recently used
+// entries (an entry's mtime is bumped whenever it is mapped).
+//
+// Location and limit come from AppConfig. Entries are written to a temporary
+// file and renamed into place, so readers never see a partial entry.
+class PcmDiskCache
+{
+public:
+    PcmDiskCache();
+
+    QString directory() const;
+    void setDirectory(const QString& directory);
+    qint64 sizeLimit() const;
+    void setSizeLimit(qint64 bytes);
+
+    // Maps the entry for the source version, or returns null when there is
+    // none or it is stale
+    QSharedPointer<DecodedMedia> map(const QString& sourcePath, qint64 sourceModified, qint64 sourceSize,
+                                     int sampleRate);
+
+    // Writes an entry, then evicts old ones to stay within the limit
+    bool store(const DecodedMedia& media, qint64 sourceModified, qint64 sourceSize);
+
+    // Writes an entry while it is still being decoded, so the PCM never has to
+    // be held in memory. Null if the cache is disabled or the entry cannot be
+    // created.
+    class Writer;
+    std::unique_ptr<Writer> createWriter(const QString& sourcePath, int sampleRate, qint64 sourceModified,
+                                         qint64 sourceSize);
+
+    void remove(const QString& sourcePath, int sampleRate);
+    qint64 diskUsage() const;
+
+private:
+    struct Header {
+        char magic[8];
+        quint32 version;
+        quint32 channels;
+        quint32 sampleRate;
+        quint32 reserved;
+        qint64 frames;
+        qint64 sourceSize;
+        qint64 sourceModified;
+    };
+
+    QString entryPath(const QString& sourcePath, int sampleRate) const;
+    void evict(const QString& keepPath);
+
+    mutable QMutex m_mutex;
+    QString m_directory;
+    qint64 m_sizeLimit;
+
+    static constexpr char MAGIC[8] = { 'M', 'A', 'P', 'C', 'M', 'F', '3', '2' };
+    static constexpr quint32 VERSION = 3; // 3: peaks moved to the PeakCache
+    static constexpr qint64 DATA_OFFSET = 4096; // PCM starts page aligned
+};
+
+// append() the PCM in order, then commit() once the length is known. Readers
+// see nothing before commit(); a writer destroyed without it leaves no entry.
+class PcmDiskCache::Writer
+{
+public:
+    bool append(const float* samples, qint64 frames);
+    bool commit(); // Then evicts old entries to stay within the limit
+    qint64 frames() const { return m_header.frames; }
+
+private:
+    friend class PcmDiskCache;
+    Writer(PcmDiskCache* cache, const QString& sourcePath, const QString& path, const Header& header);
+
+    PcmDiskCache* m_cache;
+    QString m_sourcePath;
+    QString m_path;
+    QSaveFile m_file;
+    Header m_header; // frames counts what was appended
+    bool m_failed;
+};
+
+#endif // PCMDISKCACHE_H
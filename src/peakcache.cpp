@@ -0,0 +1,283 @@
+#include "peakcache.h"
+#include "appconfig.h"
+#include "applog.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <cstring>
+
+PeakCache::PeakCache()
+    : m_directory(AppConfig::instance().getPeakCachePath())
+    , m_sizeLimit(static_cast<qint64>(AppConfig::instance().getPeakCacheSizeMB()) * 1024 * 1024)
+{
+}
+
+QString PeakCache::directory() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_directory;
+}
+
+void PeakCache::setDirectory(const QString& directory)
+{
+    QMutexLocker locker(&m_mutex);
+    m_directory = directory;
+}
+
+qint64 PeakCache::sizeLimit() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_sizeLimit;
+}
+
+void PeakCache::setSizeLimit(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_sizeLimit = qMax<qint64>(0, bytes);
+}
+
+namespace {
+
+// Bumps the mtime the eviction orders by. Windows only sets file times on
+// handles opened for writing.
+bool touch(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadWrite)
+           && file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+}
+
+} // namespace
+
+QByteArray PeakCache::hashContent(const QString& sourcePath)
+{
+    QFile file(sourcePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QByteArray block;
+    while (!file.atEnd()) {
+        block = file.read(HASH_BLOCK_BYTES);
+        if (block.isEmpty()) {
+            return {}; // Read error
+        }
+        hash.addData(block);
+    }
+    return hash.result().toHex();
+}
+
+QByteArray PeakCache::knownContentKey(const QString& sourcePath) const
+{
+    const QFileInfo fileInfo(sourcePath);
+    if (!fileInfo.exists()) {
+        return {};
+    }
+    const QString path = fileInfo.absoluteFilePath();
+    const qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    const qint64 size = fileInfo.size();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_keys.constFind(path);
+        if (it != m_keys.cend() && it->modified == modified && it->size == size) {
+            return it->key;
+        }
+    }
+
+    // Hashed by an earlier run: the record holds "<mtime> <size> <hash>"
+    QByteArray key;
+    const QString record = recordPath(path);
+    QFile recordFile(record);
+    if (recordFile.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = recordFile.readAll().trimmed().split(' ');
+        recordFile.close();
+        if (fields.size() == 3 && fields[0].toLongLong() == modified && fields[1].toLongLong() == size
+            && fields[2].size() == 2 * QCryptographicHash::hashLength(QCryptographicHash::Sha1)) {
+            key = fields[2];
+            touch(record);
+        }
+    }
+    if (key.isEmpty()) {
+        return {};
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_keys.insert(path, KnownKey{ modified, size, key });
+    return key;
+}
+
+QByteArray PeakCache::contentKey(const QString& sourcePath) const
+{
+    QByteArray key = knownContentKey(sourcePath);
+    if (!key.isEmpty()) {
+        return key;
+    }
+
+    const QFileInfo fileInfo(sourcePath);
+    if (!fileInfo.exists()) {
+        return {};
+    }
+    const QString path = fileInfo.absoluteFilePath();
+    const qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    const qint64 size = fileInfo.size();
+
+    QElapsedTimer timer;
+    timer.start();
+    key = hashContent(path);
+    if (key.isEmpty()) {
+        return {};
+    }
+    LOG_DEBUG(lcWaveform) << "PeakCache: Hashed" << path << "in" << timer.elapsed() << "ms";
+
+    const QString record = recordPath(path);
+    QSaveFile save(record);
+    if (QDir().mkpath(QFileInfo(record).absolutePath()) && save.open(QIODevice::WriteOnly)) {
+        save.write(QByteArray::number(modified) + ' ' + QByteArray::number(size) + ' ' + key + '\n');
+        save.commit();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_keys.insert(path, KnownKey{ modified, size, key });
+    return key;
+}
+
+QString PeakCache::entryPath(const QByteArray& contentKey) const
+{
+    return directory() + '/' + QString::fromLatin1(contentKey) + ".peaks";
+}
+
+QString PeakCache::recordPath(const QString& sourcePath) const
+{
+    const QByteArray hash = QCryptographicHash::hash(sourcePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return directory() + '/' + QString::fromLatin1(hash) + ".key";
+}
+
+PeakPyramid PeakCache::map(const QString& sourcePath, int* sampleRate) const
+{
+    const QByteArray key = knownContentKey(sourcePath);
+    if (key.isEmpty()) {
+        return {};
+    }
+
+    const QString path = entryPath(key);
+    QSharedPointer<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    Header header;
+    const bool valid = file->read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header)
+                       && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+                       && header.version == VERSION
+                       && header.bucketFrames == PeakPyramid::BASE_BUCKET_FRAMES
+                       && header.sampleRate > 0
+                       && header.frames > 0
+                       && header.peakCount == PeakPyramid::totalPeaks(header.frames)
+                       && file->size() >= DATA_OFFSET + header.peakCount * static_cast<qint64>(sizeof(Peak));
+    if (!valid) {
+        LOG_DEBUG(lcWaveform) << "PeakCache: Discarding invalid entry for" << sourcePath;
+        file->close();
+        QFile::remove(path);
+        return {};
+    }
+
+    uchar* data = file->map(DATA_OFFSET, header.peakCount * static_cast<qint64>(sizeof(Peak)));
+    if (!data) {
+        LOG_WARNING(lcWaveform) << "PeakCache: Could not map" << path << "-" << file->errorString();
+        return {};
+    }
+
+    // Recently used entries are evicted last
+    if (!touch(path)) {
+        LOG_DEBUG(lcWaveform) << "PeakCache: Could not update the access time of" << path;
+    }
+
+    if (sampleRate) {
+        *sampleRate = static_cast<int>(header.sampleRate);
+    }
+    return PeakPyramid::fromMapped(file, reinterpret_cast<const Peak*>(data), header.frames);
+}
+
+bool PeakCache::store(const QString& sourcePath, const PeakPyramid& peaks, int sampleRate)
+{
+    if (peaks.isEmpty() || sampleRate <= 0) {
+        return false;
+    }
+
+    const QByteArray key = contentKey(sourcePath);
+    if (key.isEmpty()) {
+        return false;
+    }
+    const QString path = entryPath(key);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.bucketFrames = PeakPyramid::BASE_BUCKET_FRAMES;
+    header.sampleRate = static_cast<quint32>(sampleRate);
+    header.reserved = 0;
+    header.frames = peaks.frames();
+    header.peakCount = PeakPyramid::totalPeaks(peaks.frames());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QByteArray headerBlock(DATA_OFFSET, '\0');
+    std::memcpy(headerBlock.data(), &header, sizeof(header));
+    file.write(headerBlock);
+    file.write(reinterpret_cast<const char*>(peaks.data()), header.peakCount * static_cast<qint64>(sizeof(Peak)));
+    if (!file.commit()) {
+        LOG_WARNING(lcWaveform) << "PeakCache: Could not write" << path << "-" << file.errorString();
+        return false;
+    }
+
+    LOG_DEBUG(lcWaveform) << "PeakCache: Stored" << header.peakCount << "peaks for" << sourcePath;
+    evict(path);
+    return true;
+}
+
+void PeakCache::remove(const QString& sourcePath)
+{
+    // Without a known hash nothing could have been mapped for it
+    const QByteArray key = knownContentKey(sourcePath);
+    if (!key.isEmpty()) {
+        QFile::remove(entryPath(key));
+    }
+}
+
+void PeakCache::evict(const QString& keepPath)
+{
+    QFileInfoList entries = QDir(directory()).entryInfoList({ "*.peaks", "*.key" }, QDir::Files,
+                                                            QDir::Time | QDir::Reversed);
+    qint64 total = 0;
+    for (const QFileInfo& entry : entries) {
+        total += entry.size();
+    }
+
+    // Oldest first; a dropped record only costs hashing its source again
+    const qint64 limit = sizeLimit();
+    for (const QFileInfo& entry : entries) {
+        if (total <= limit) {
+            break;
+        }
+        if (entry.absoluteFilePath() == QFileInfo(keepPath).absoluteFilePath()) {
+            continue;
+        }
+        if (QFile::remove(entry.absoluteFilePath())) {
+            LOG_DEBUG(lcWaveform) << "PeakCache: Evicted" << entry.fileName();
+            total -= entry.size();
+        }
+    }
+}
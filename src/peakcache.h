@@ -0,0 +1,91 @@
+#ifndef PEAKCACHE_H
+#define PEAKCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include "peakpyramid.h"
+
+// Waveform peaks kept on disk so reopening a project draws its clips without
+// reading any audio.
+//
+// Each entry is a small .peaks file: a fixed header followed by every level
+// of the PeakPyramid, finest first, exactly as PeakPyramid lays them out. It
+// is mapped read-only and drawn from in place: only the pages a view touches
+// are ever loaded, however long the audio. Entries are named by a hash of the
+// source's whole content rather than its path, so copies of a file share one
+// entry and any edit gets a new one.
+//
+// Hashing reads the whole source, so only store() does it, on the thread that
+// decoded the file, and once per version of a file: the hash is remembered by
+// path, size and modification time, in memory and in a small .key record next
+// to the entries. map() only looks the hash up; a file it has none for (new,
+// edited or moved) misses and is decoded. Reopening a project reads neither
+// its audio nor its hashes again.
+//
+// Entries are written to a temporary file and renamed into place. The
+// directory is kept under a size limit from AppConfig by deleting the least
+// recently used entries and records (their mtime is bumped when used).
+class PeakCache
+{
+public:
+    PeakCache();
+
+    QString directory() const;
+    void setDirectory(const QString& directory);
+    qint64 sizeLimit() const;
+    void setSizeLimit(qint64 bytes);
+
+    // Maps the peaks for the source's current content; empty if there are
+    // none or its hash is not known yet. Never reads the source, so it is
+    // cheap enough for the GUI thread. sampleRate receives the rate the
+    // peaks' frames are counted at.
+    PeakPyramid map(const QString& sourcePath, int* sampleRate = nullptr) const;
+    // Hashes the source if needed, which reads all of it: call it off the GUI
+    // thread, e.g. after decoding
+    bool store(const QString& sourcePath, const PeakPyramid& peaks, int sampleRate);
+    void remove(const QString& sourcePath);
+
+    // Hash of the file's content; empty if it cannot be read. Hashes the
+    // file unless its current version was hashed before.
+    QByteArray contentKey(const QString& sourcePath) const;
+    // Hash of the file's current version if it was hashed before, otherwise
+    // empty; never reads the source
+    QByteArray knownContentKey(const QString& sourcePath) const;
+    static QByteArray hashContent(const QString& sourcePath);
+
+private:
+    struct Header {
+        char magic[8];
+        quint32 version;
+        quint32 bucketFrames;
+        quint32 sampleRate;
+        quint32 reserved;
+        qint64 frames;
+        qint64 peakCount; // All levels
+    };
+
+    // A content hash and the source version it was computed for
+    struct KnownKey {
+        qint64 modified;
+        qint64 size;
+        QByteArray key;
+    };
+
+    QString entryPath(const QByteArray& contentKey) const;
+    QString recordPath(const QString& sourcePath) const;
+    void evict(const QString& keepPath);
+
+    mutable QMutex m_mutex;
+    QString m_directory;
+    qint64 m_sizeLimit;
+    mutable QHash<QString, KnownKey> m_keys; // By absolute source path
+
+    static constexpr char MAGIC[8] = { 'M', 'A', 'P', 'E', 'A', 'K', 'S', '\0' };
+    static constexpr quint32 VERSION = 1;
+    static constexpr qint64 DATA_OFFSET = 64;
+    static constexpr qint64 HASH_BLOCK_BYTES = 1024 * 1024;
+};
+
+#endif // PEAKCACHE_H
@@ -0,0 +1,149 @@
+#include "peakpyramid.h"
+#include "audiokernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+Peak combine(const Peak& a, const Peak& b)
+{
+    // Buckets of one level cover equal frame counts (bar the last), so RMS
+    // combines as the root of the mean of the squares
+    return Peak{ std::min(a.min, b.min), std::max(a.max, b.max), std::sqrt(0.5f * (a.rms * a.rms + b.rms * b.rms)) };
+}
+
+// Fills every level after the first from the one before it; storage holds
+// all levels back to back
+void buildCoarserLevels(Peak* storage, qint64 baseCount)
+{
+    Peak* finer = storage;
+    qint64 finerCount = baseCount;
+    while (finerCount > 1) {
+        Peak* coarser = finer + finerCount;
+        const qint64 coarserCount = (finerCount + 1) / 2;
+        for (qint64 i = 0; i < coarserCount; ++i) {
+            const qint64 left = 2 * i;
+            coarser[i] = left + 1 < finerCount ? combine(finer[left], finer[left + 1]) : finer[left];
+        }
+        finer = coarser;
+        finerCount = coarserCount;
+    }
+}
+
+qint64 baseCount(qint64 frames)
+{
+    return frames > 0 ? (frames + PeakPyramid::BASE_BUCKET_FRAMES - 1) / PeakPyramid::BASE_BUCKET_FRAMES : 0;
+}
+
+} // namespace
+
+qint64 PeakPyramid::totalPeaks(qint64 frames)
+{
+    qint64 count = baseCount(frames);
+    qint64 total = count;
+    while (count > 1) {
+        count = (count + 1) / 2;
+        total += count;
+    }
+    return total;
+}
+
+void PeakPyramid::setLevels(const Peak* peaks)
+{
+    m_levels.clear();
+    qint64 count = baseCount(m_frames);
+    while (count > 0) {
+        m_levels.append(Level{ peaks, count });
+        peaks += count;
+        count = count > 1 ? (count + 1) / 2 : 0;
+    }
+}
+
+PeakPyramid PeakPyramid::build(const float* samples, qint64 frames)
+{
+    PeakPyramid pyramid;
+    pyramid.m_frames = frames;
+    if (frames <= 0) {
+        return pyramid;
+    }
+
+    QSharedPointer<QVector<Peak>> storage(new QVector<Peak>(totalPeaks(frames)));
+    Peak* base = storage->data();
+    const qint64 buckets = baseCount(frames);
+    for (qint64 bucket = 0; bucket < buckets; ++bucket) {
+        const qint64 first = bucket * BASE_BUCKET_FRAMES;
+        const qint64 count = std::min<qint64>(BASE_BUCKET_FRAMES, frames - first);
+
+        float low;
+        float high;
+        double squares;
+        AudioKernels::peakStats(samples + first * 2, static_cast<size_t>(count * 2), &low, &high, &squares);
+        base[bucket] = Peak{ low, high, static_cast<float>(std::sqrt(squares / (count * 2))) };
+    }
+
+    buildCoarserLevels(base, buckets);
+    pyramid.m_storage = storage;
+    pyramid.setLevels(storage->constData());
+    return pyramid;
+}
+
+PeakPyramid PeakPyramid::fromBaseLevel(const QVector<Peak>& base, qint64 frames)
+{
+    PeakPyramid pyramid;
+    pyramid.m_frames = frames;
+    const qint64 buckets = baseCount(frames);
+    if (buckets == 0 || base.isEmpty()) {
+        return pyramid;
+    }
+
+    // Missing buckets stay silent, extra ones are dropped
+    QSharedPointer<QVector<Peak>> storage(new QVector<Peak>(totalPeaks(frames)));
+    std::fill_n(storage->data(), buckets, Peak{ 0.0f, 0.0f, 0.0f });
+    std::copy_n(base.constData(), std::min<qint64>(buckets, base.size()), storage->data());
+    buildCoarserLevels(storage->data(), buckets);
+    pyramid.m_storage = storage;
+    pyramid.setLevels(storage->constData());
+    return pyramid;
+}
+
+PeakPyramid PeakPyramid::fromMapped(const QSharedPointer<QFile>& file, const Peak* peaks, qint64 frames)
+{
+    PeakPyramid pyramid;
+    pyramid.m_frames = frames;
+    pyramid.m_file = file;
+    pyramid.setLevels(peaks);
+    return pyramid;
+}
+
+int PeakPyramid::levelFor(double framesPerPixel) const
+{
+    int level = 0;
+    while (level + 1 < m_levels.size() && bucketFrames(level + 1) <= framesPerPixel) {
+        ++level;
+    }
+    return level;
+}
+
+Peak PeakPyramid::range(int level, qint64 firstFrame, qint64 endFrame) const
+{
+    const Peak* buckets = m_levels[level].peaks;
+    const qint64 count = m_levels[level].count;
+    const qint64 width = bucketFrames(level);
+    const qint64 first = std::clamp<qint64>(firstFrame / width, 0, count - 1);
+    const qint64 end = std::clamp<qint64>((endFrame + width - 1) / width, first + 1, count);
+
+    Peak peak = buckets[first];
+    float squares = peak.rms * peak.rms;
+    for (qint64 i = first + 1; i < end; ++i) {
+        peak.min = std::min(peak.min, buckets[i].min);
+        peak.max = std::max(peak.max, buckets[i].max);
+        squares += buckets[i].rms * buckets[i].rms;
+    }
+    peak.rms = std::sqrt(squares / (end - first));
+    return peak;
+}
+
+Peak PeakPyramid::overall() const
+{
+    return isEmpty() ? Peak{ 0.0f, 0.0f, 0.0f } : m_levels.last().peaks[0];
+}
@@ -0,0 +1,75 @@
+#ifndef PEAKPYRAMID_H
+#define PEAKPYRAMID_H
+
+#include <QFile>
+#include <QSharedPointer>
+#include <QVector>
+
+// Min/max/RMS summary of one bucket of frames (both channels)
+struct Peak {
+    float min;
+    float max;
+    float rms;
+};
+
+// Multi-resolution waveform summary of a file.
+//
+// Level 0 holds one Peak per BASE_BUCKET_FRAMES frames; every further level
+// halves the previous one, up to a single bucket for the whole file. A view
+// picks the coarsest level that still has at least one bucket per pixel, so
+// drawing any zoom costs O(visible pixels) and still shows the true peaks
+// (min/max are exact at every level, not sampled).
+//
+// The levels are stored back to back, finest first, either on the heap or in
+// a mapped PeakCache file; mapped levels are paged in only where they are
+// drawn. Either way copies are cheap and share the storage.
+class PeakPyramid
+{
+public:
+    static constexpr int BASE_BUCKET_FRAMES = 256;
+
+    // From interleaved stereo float32
+    static PeakPyramid build(const float* samples, qint64 frames);
+    // From a level 0; the coarser levels are built from it
+    static PeakPyramid fromBaseLevel(const QVector<Peak>& base, qint64 frames);
+    // All levels of frames, stored back to back at peaks inside a mapping of file
+    static PeakPyramid fromMapped(const QSharedPointer<QFile>& file, const Peak* peaks, qint64 frames);
+
+    bool isEmpty() const { return m_levels.isEmpty(); }
+    bool isMapped() const { return !m_file.isNull(); }
+    qint64 frames() const { return m_frames; }
+    int levelCount() const { return m_levels.size(); }
+    const Peak* levelData(int level) const { return m_levels[level].peaks; }
+    qint64 levelSize(int level) const { return m_levels[level].count; }
+    static qint64 bucketFrames(int level) { return static_cast<qint64>(BASE_BUCKET_FRAMES) << level; }
+
+    // Peaks in all levels of a file of the given length
+    static qint64 totalPeaks(qint64 frames);
+    // All levels, back to back, as stored
+    const Peak* data() const { return isEmpty() ? nullptr : m_levels.first().peaks; }
+
+    // Coarsest level whose buckets are no wider than framesPerPixel
+    int levelFor(double framesPerPixel) const;
+
+    // Combined peak of frames [firstFrame, endFrame) at the given level,
+    // widened to whole buckets
+    Peak range(int level, qint64 firstFrame, qint64 endFrame) const;
+
+    // Whole file
+    Peak overall() const;
+
+private:
+    struct Level {
+        const Peak* peaks;
+        qint64 count;
+    };
+
+    void setLevels(const Peak* peaks); // Points m_levels into storage laid out for m_frames
+
+    QVector<Level> m_levels;
+    qint64 m_frames = 0;
+    QSharedPointer<const QVector<Peak>> m_storage; // Heap levels, if built here
+    QSharedPointer<QFile> m_file;                  // Mapping the levels point into, if mapped
+};
+
+#endif // PEAKPYRAMID_H
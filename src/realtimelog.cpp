@@ -0,0 +1,85 @@
+#include "realtimelog.h"
+#include "applog.h"
+#include "wakeupcounter.h"
+#include <QDebug>
+#include <algorithm>
+
+RealtimeLog& RealtimeLog::instance()
+{
+    static RealtimeLog log;
+    return log;
+}
+
+RealtimeLog::RealtimeLog()
+    : m_ring(RING_CAPACITY)
+    , m_dropped(0)
+    , m_stopRequested(false)
+    , m_reportedDropped(0)
+{
+    m_clock.start();
+    start(QThread::LowestPriority);
+}
+
+RealtimeLog::~RealtimeLog()
+{
+    shutdown();
+}
+
+void RealtimeLog::post(const QLoggingCategory& category, QtMsgType type, const char* message,
+                       std::initializer_list<double> arguments)
+{
+    Record record;
+    record.category = &category;
+    record.type = type;
+    record.message = message;
+    record.timestampNs = m_clock.nsecsElapsed();
+    record.argumentCount = static_cast<int>(std::min<size_t>(arguments.size(), MAX_ARGUMENTS));
+    std::copy_n(arguments.begin(), record.argumentCount, record.arguments);
+
+    if (m_ring.write(&record, 1) == 0) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_posted.signal();
+}
+
+void RealtimeLog::shutdown()
+{
+    if (!isRunning()) {
+        return;
+    }
+    m_stopRequested = true;
+    m_posted.signal();
+    wait();
+    flush();
+}
+
+void RealtimeLog::run()
+{
+    while (!m_stopRequested) {
+        m_posted.wait();
+        WakeupCounter::countThreadWakeup();
+        // One flush prints every record posted so far
+        flush();
+    }
+}
+
+void RealtimeLog::flush()
+{
+    Record record;
+    while (m_ring.read(&record, 1) == 1) {
+        QMessageLogger logger;
+        QDebug stream = record.type == QtWarningMsg ? logger.warning(*record.category)
+                        : record.type == QtInfoMsg  ? logger.info(*record.category)
+                                                    : logger.debug(*record.category);
+        stream.noquote() << QString("[audio +%1 ms]").arg(record.timestampNs / 1.0e6, 0, 'f', 3) << record.message;
+        for (int i = 0; i < record.argumentCount; ++i) {
+            stream << record.arguments[i];
+        }
+    }
+
+    const quint64 dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_reportedDropped) {
+        LOG_WARNING(lcAudioEngine) << "RealtimeLog: Dropped" << dropped - m_reportedDropped << "audio thread messages";
+        m_reportedDropped = dropped;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef REALTIMELOG_H
+#define REALTIMELOG_H
+
+#include <QThread>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <atomic>
+#include <initializer_list>
+#include "audioringbuffer.h"
+#include "realtimewake.h"
+
+// Log channel for the audio callback.
+//
+// post() copies a pointer to a static message and a few numbers into a
+// preallocated lock-free ring; a background thread formats them and hands
+// them to the Qt message handler. When the ring is full, records are dropped
+// and counted rather than blocking the audio thread. There is one producer:
+// the audio callback. Other threads log through the LOG_* macros directly.
+// The thread sleeps until a record is posted. post() wakes it through a
+// RealtimeWake: an atomic exchange, plus a system call only for the first
+// record after the thread fell asleep.
+class RealtimeLog : public QThread
+{
+    Q_OBJECT
+
+public:
+    static RealtimeLog& instance();
+
+    static constexpr int MAX_ARGUMENTS = 4;
+
+    // Audio thread. message must be a string literal (it is printed later).
+    void post(const QLoggingCategory& category, QtMsgType type, const char* message,
+              std::initializer_list<double> arguments = {});
+
+    quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Prints everything still queued and stops the thread
+    void shutdown();
+
+protected:
+    void run() override;
+
+private:
+    struct Record {
+        const QLoggingCategory* category;
+        QtMsgType type;
+        const char* message;
+        qint64 timestampNs;
+        int argumentCount;
+        double arguments[MAX_ARGUMENTS];
+    };
+
+    RealtimeLog();
+    ~RealtimeLog() override;
+
+    void flush();
+
+    AudioRingBuffer<Record> m_ring;
+    QElapsedTimer m_clock;
+    std::atomic<quint64> m_dropped;
+    std::atomic<bool> m_stopRequested;
+    RealtimeWake m_posted; // Signalled by post(), and to stop
+    quint64 m_reportedDropped; // Flush thread only
+
+    static constexpr int RING_CAPACITY = 1024;
+};
+
+#endif // REALTIMELOG_H
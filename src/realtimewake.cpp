@@ -0,0 +1,98 @@
+#include "realtimewake.h"
+#include <QThread>
+
+#if defined(Q_OS_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_MACOS)
+#include <dispatch/dispatch.h>
+#endif
+
+RealtimeWake::RealtimeWake()
+    : m_state(IDLE)
+{
+#if defined(Q_OS_WIN)
+    m_handle = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+#elif defined(Q_OS_MACOS)
+    m_handle = dispatch_semaphore_create(0);
+#endif
+}
+
+RealtimeWake::~RealtimeWake()
+{
+#if defined(Q_OS_WIN)
+    if (m_handle) {
+        CloseHandle(m_handle);
+    }
+#elif defined(Q_OS_MACOS)
+    if (m_handle) {
+        dispatch_release(static_cast<dispatch_semaphore_t>(m_handle));
+    }
+#endif
+}
+
+void RealtimeWake::signal()
+{
+    if (m_state.exchange(SIGNALLED) == SLEEPING) {
+        wakeSleeper();
+    }
+}
+
+void RealtimeWake::wait()
+{
+    int expected = SIGNALLED;
+    if (m_state.compare_exchange_strong(expected, IDLE)) {
+        return;
+    }
+
+    // A signal from here on sees SLEEPING and wakes the thread. The kernel
+    // side may carry a wakeup over from an earlier sleep, so it is only
+    // trusted once the flag has changed.
+    expected = IDLE;
+    if (m_state.compare_exchange_strong(expected, SLEEPING)) {
+        while (m_state.load() == SLEEPING) {
+            sleep();
+        }
+    }
+    m_state.store(IDLE);
+}
+
+void RealtimeWake::sleep()
+{
+#if defined(Q_OS_LINUX)
+    static_assert(sizeof(m_state) == sizeof(int), "futex word must be an int");
+    syscall(SYS_futex, reinterpret_cast<int*>(&m_state), FUTEX_WAIT_PRIVATE, SLEEPING, nullptr, nullptr, 0);
+#elif defined(Q_OS_WIN)
+    if (m_handle) {
+        WaitForSingleObject(m_handle, INFINITE);
+    } else {
+        QThread::msleep(POLL_INTERVAL_MS);
+    }
+#elif defined(Q_OS_MACOS)
+    if (m_handle) {
+        dispatch_semaphore_wait(static_cast<dispatch_semaphore_t>(m_handle), DISPATCH_TIME_FOREVER);
+    } else {
+        QThread::msleep(POLL_INTERVAL_MS);
+    }
+#else
+    QThread::msleep(POLL_INTERVAL_MS);
+#endif
+}
+
+void RealtimeWake::wakeSleeper()
+{
+#if defined(Q_OS_LINUX)
+    syscall(SYS_futex, reinterpret_cast<int*>(&m_state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#elif defined(Q_OS_WIN)
+    if (m_handle) {
+        SetEvent(m_handle);
+    }
+#elif defined(Q_OS_MACOS)
+    if (m_handle) {
+        dispatch_semaphore_signal(static_cast<dispatch_semaphore_t>(m_handle));
+    }
+#endif
+}
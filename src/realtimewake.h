@@ -0,0 +1,53 @@
+#ifndef REALTIMEWAKE_H
+#define REALTIMEWAKE_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Wakes a sleeping worker thread from the audio callback.
+//
+// A binary event: signal() sets it, and wait() returns once it is set and
+// clears it. signal() is an atomic exchange on a flag; only if the waiter is
+// asleep does it also make the system call that wakes it (a futex on Linux,
+// an auto-reset event on Windows, a dispatch semaphore on macOS). So of a run
+// of signals, only the first after the waiter went to sleep reaches the
+// kernel, and no signal waits for a lock the waiter might hold, as releasing a
+// QSemaphore or waking a QWaitCondition would. On other platforms the waiter
+// polls the flag instead.
+//
+// One waiting thread; any number of signalling threads.
+class RealtimeWake
+{
+public:
+    RealtimeWake();
+    ~RealtimeWake();
+    RealtimeWake(const RealtimeWake&) = delete;
+    RealtimeWake& operator=(const RealtimeWake&) = delete;
+
+    void signal();
+    // Returns at once if signalled since the last wait() returned
+    void wait();
+    // Drops a signal nobody waited for; only while no thread waits
+    void reset() { m_state.store(IDLE); }
+
+private:
+    enum State : int {
+        IDLE,
+        SIGNALLED,
+        SLEEPING // The waiter is in, or about to enter, sleep()
+    };
+
+    // Until wakeSleeper() or spuriously; returns at once if m_state is no
+    // longer SLEEPING
+    void sleep();
+    void wakeSleeper();
+
+    std::atomic<int> m_state;
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
+    void* m_handle; // Event or dispatch semaphore
+#endif
+
+    static constexpr int POLL_INTERVAL_MS = 5; // Where there is no wake primitive
+};
+
+#endif // REALTIMEWAKE_H
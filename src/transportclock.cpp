@@ -0,0 +1,105 @@
+#include "transportclock.h"
+#include <chrono>
+
+TransportClock::TransportClock(int sampleRate)
+    : m_sampleRate(sampleRate)
+    , m_renderFrame(0)
+    , m_latency(0)
+    , m_sequence(0)
+    , m_startFrame(0)
+    , m_advancedAt(0)
+    , m_lastBlock(0)
+{
+}
+
+void TransportClock::locate(qint64 frame)
+{
+    const qint64 start = qMax<qint64>(0, frame);
+    const quint32 sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_startFrame.store(start, std::memory_order_relaxed);
+    m_renderFrame.store(start, std::memory_order_relaxed);
+    m_latency.store(0, std::memory_order_relaxed);
+    m_advancedAt.store(0, std::memory_order_relaxed);
+    m_lastBlock.store(0, std::memory_order_relaxed);
+    m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void TransportClock::advance(qint64 frames)
+{
+    const qint64 now = nowNanoseconds();
+    const quint32 sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_advancedAt.store(now, std::memory_order_relaxed);
+    m_lastBlock.store(frames, std::memory_order_relaxed);
+    m_renderFrame.fetch_add(frames, std::memory_order_release);
+    m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void TransportClock::setOutputLatency(qint64 frames)
+{
+    m_latency.store(qMax<qint64>(0, frames), std::memory_order_relaxed);
+}
+
+TransportClock::Snapshot TransportClock::snapshot() const
+{
+    Snapshot snapshot;
+    for (;;) {
+        const quint32 before = m_sequence.load(std::memory_order_acquire);
+        snapshot.startFrame = m_startFrame.load(std::memory_order_relaxed);
+        snapshot.renderFrame = m_renderFrame.load(std::memory_order_relaxed);
+        snapshot.advancedAt = m_advancedAt.load(std::memory_order_relaxed);
+        snapshot.lastBlock = m_lastBlock.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((before & 1) == 0 && m_sequence.load(std::memory_order_relaxed) == before) {
+            return snapshot;
+        }
+    }
+}
+
+qint64 TransportClock::renderFrame() const
+{
+    return m_renderFrame.load(std::memory_order_acquire);
+}
+
+qint64 TransportClock::playbackFrame() const
+{
+    // Never earlier than the last locate(): the latency is measured for the
+    // audio delivered since then
+    const Snapshot clock = snapshot();
+    const qint64 delivered = clock.renderFrame - clock.startFrame;
+    return clock.renderFrame - qMin(delivered, m_latency.load(std::memory_order_relaxed));
+}
+
+double TransportClock::playbackSeconds() const
+{
+    return static_cast<double>(playbackFrame()) / m_sampleRate;
+}
+
+qint64 TransportClock::deliveredFrames() const
+{
+    const Snapshot clock = snapshot();
+    return clock.renderFrame - clock.startFrame;
+}
+
+qint64 TransportClock::playbackFrameAt(qint64 nanoseconds) const
+{
+    const Snapshot clock = snapshot();
+    const qint64 delivered = clock.renderFrame - clock.startFrame;
+    const qint64 frame = clock.renderFrame - qMin(delivered, m_latency.load(std::memory_order_relaxed));
+
+    if (clock.advancedAt == 0 || nanoseconds <= clock.advancedAt) {
+        return frame;
+    }
+    const qint64 elapsed = (nanoseconds - clock.advancedAt) * m_sampleRate / 1000000000;
+    return frame + qMin(elapsed, clock.lastBlock);
+}
+
+qint64 TransportClock::nowNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
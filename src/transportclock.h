@@ -0,0 +1,76 @@
+#ifndef TRANSPORTCLOCK_H
+#define TRANSPORTCLOCK_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Sample-accurate transport position shared by the audio callback, the mixer
+// and the UI.
+//
+// The audio callback advances the clock by the frames it hands to the sink;
+// that count is where the mixer renders next. What is actually audible lags
+// behind by the audio still queued in the sink, which the engine measures on
+// the GUI thread and stores as the output latency. The render position is a
+// single atomic frame count the callback advances; everything derived from it
+// and the locate() point is read under a sequence count, so any thread can
+// read either position without locking and never pairs one locate() with
+// another's delivered count.
+//
+// Between callbacks the delivered count stands still while the audio keeps
+// playing. playbackFrameAt() fills the gap from the time of the last callback,
+// so the UI can place the playhead once per display frame rather than once
+// per callback.
+class TransportClock
+{
+public:
+    explicit TransportClock(int sampleRate);
+
+    int sampleRate() const { return m_sampleRate; }
+
+    // Moves the transport. Only while the audio callback is not running; the
+    // engine parks it first (AudioIODevice::park()).
+    void locate(qint64 frame);
+
+    // Audio thread: frames handed to the sink
+    void advance(qint64 frames);
+
+    // GUI thread: frames delivered to the sink but not yet audible
+    void setOutputLatency(qint64 frames);
+
+    // Any thread
+    qint64 renderFrame() const;   // Next frame the mixer renders
+    qint64 playbackFrame() const; // Frame currently leaving the speakers
+    double playbackSeconds() const;
+    qint64 deliveredFrames() const; // Frames delivered since the last locate()
+
+    // playbackFrame() advanced by the time since the last callback, at most
+    // by that callback's block (a stalled device stops the estimate)
+    qint64 playbackFrameAt(qint64 nanoseconds) const;
+
+    // Monotonic time base of playbackFrameAt()
+    static qint64 nowNanoseconds();
+
+private:
+    struct Snapshot
+    {
+        qint64 startFrame;
+        qint64 renderFrame;
+        qint64 advancedAt;
+        qint64 lastBlock;
+    };
+    Snapshot snapshot() const;
+
+    const int m_sampleRate;
+    std::atomic<qint64> m_renderFrame; // Next frame the mixer renders
+    std::atomic<qint64> m_latency;
+
+    // Written by locate() and the callback, never at once (the callback is
+    // parked for locate()), guarded by a sequence count (odd while written)
+    // so readers see the start, position, block and time together
+    std::atomic<quint32> m_sequence;
+    std::atomic<qint64> m_startFrame; // Frame of the last locate()
+    std::atomic<qint64> m_advancedAt; // nowNanoseconds(); 0 before the first callback
+    std::atomic<qint64> m_lastBlock;
+};
+
+#endif // TRANSPORTCLOCK_H
@@ -1,4 +1,5 @@
 #include "transportdock.h"
+#include "applog.h"
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QLabel>
@@ -6,7 +7,6 @@
 #include <QSlider>
 #include <QSpinBox>
 #include <QFrame>
-#include <QTimer>
 #include <QStyle>
 #include <QDebug>
 #include <QMenu>
@@ -18,14 +18,9 @@ TransportDock::TransportDock(QWidget *parent)
     , m_isPlaying(false)
     , m_isRecording(false)
     , m_currentPosition(0.0)
-    , m_updateTimer(new QTimer(this))
 {
     setupUI();
     applyModernStyling();
-    
-    // Connect timer for position updates
-    connect(m_updateTimer, &QTimer::timeout, this, &TransportDock::updateTimer);
-    m_updateTimer->setInterval(100); // Update every 100ms
 }
 
 void TransportDock::setupUI() {
@@ -345,7 +340,6 @@ void TransportDock::play() {
     m_playStopButton->setIcon(style()->standardIcon(QStyle::SP_MediaPause));
     m_playStopButton->setToolTip("Pause");
     m_playStopButton->setChecked(true);
-    m_updateTimer->start(50); // Update every 50ms for smooth playback
     emit playRequested();
 }
 
@@ -354,7 +348,6 @@ void TransportDock::stop() {
     m_playStopButton->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
     m_playStopButton->setToolTip("Play");
     m_playStopButton->setChecked(false);
-    m_updateTimer->stop();
     emit stopRequested();
 }
 
@@ -363,7 +356,6 @@ void TransportDock::pause() {
     m_playStopButton->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
     m_playStopButton->setToolTip("Play");
     m_playStopButton->setChecked(false);
-    m_updateTimer->stop();
     emit pauseRequested();
 }
 
@@ -396,7 +388,6 @@ void TransportDock::stopAndReturn() {
     m_playStopButton->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
     m_playStopButton->setToolTip("Play");
     m_playStopButton->setChecked(false);
-    m_updateTimer->stop();
     
     // Return to start position (0.0 seconds)
     setPosition(0.0);
@@ -405,21 +396,18 @@ void TransportDock::stopAndReturn() {
 }
 
 void TransportDock::setPosition(double seconds) {
-    qDebug() << "TransportDock::setPosition called with seconds:" << seconds;
-    qDebug() << "  - Current position was:" << m_currentPosition;
+    // Every position update of playback comes through here
+    LOG_TRACE(lcTransport) << "TransportDock: Position" << m_currentPosition << "->" << seconds << "seconds";
     
     m_currentPosition = seconds;
     updateTimeDisplay();
-    qDebug() << "  - Time display updated";
     
     // Update slider without triggering signal
     m_positionSlider->blockSignals(true);
     m_positionSlider->setValue(static_cast<int>(seconds * 100)); // Convert to slider scale
     m_positionSlider->blockSignals(false);
-    qDebug() << "  - Position slider updated to value:" << static_cast<int>(seconds * 100);
     
     emit positionChanged(seconds);
-    qDebug() << "  - positionChanged signal emitted";
 }
 
 void TransportDock::onPositionSliderChanged(int value) {
@@ -445,21 +433,6 @@ void TransportDock::onBPMChanged(int bpm) {
     emit bpmChanged(bpm);
 }
 
-void TransportDock::updateTimer() {
-    if (m_isPlaying) {
-        m_currentPosition += 0.05; // Increment by 50ms to match timer interval
-        updateTimeDisplay();
-        
-        // Update slider
-        m_positionSlider->blockSignals(true);
-        m_positionSlider->setValue(static_cast<int>(m_currentPosition * 100));
-        m_positionSlider->blockSignals(false);
-        
-        // Emit position change for timeline sync
-        emit positionChanged(m_currentPosition);
-    }
-}
-
 void TransportDock::updateTimeDisplay() {
     m_timeLabel->setText(formatTime(m_currentPosition));
 }
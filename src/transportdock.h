@@ -10,7 +10,6 @@
 #include <QSpinBox>
 #include <QToolButton>
 #include <QButtonGroup>
-#include <QTimer>
 #include <QFrame>
 #include "appconfig.h"
 
@@ -78,7 +77,6 @@ private slots:
     void onRecordClicked();
     void onPositionSliderChanged(int value);
     void onBPMChanged(int bpm);
-    void updateTimer();
 
 private:
     void setupUI();
@@ -94,8 +92,7 @@ private:
     // Transport state
     bool m_isPlaying;
     bool m_isRecording;
-    double m_currentPosition;
-    QTimer* m_updateTimer;
+    double m_currentPosition; // Set by the engine's positionChanged while playing
     
     // UI Components - Transport
     QFrame* m_transportFrame;
@@ -0,0 +1,85 @@
+#include "wakeupcounter.h"
+#include "applog.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QTimer>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+WakeupCounter& WakeupCounter::instance()
+{
+    static WakeupCounter counter;
+    return counter;
+}
+
+void WakeupCounter::install()
+{
+    QCoreApplication* app = QCoreApplication::instance();
+    if (!app) {
+        return;
+    }
+    app->installEventFilter(this);
+    m_sinceReport.start();
+
+    if (!qEnvironmentVariableIsSet("MUSIC_APP_WAKEUP_REPORT")) {
+        return;
+    }
+    m_reportAtInfo = true;
+    const int intervalSeconds = qEnvironmentVariableIntValue("MUSIC_APP_WAKEUP_REPORT");
+    if (intervalSeconds > 0) {
+        QTimer* timer = new QTimer(app);
+        connect(timer, &QTimer::timeout, app, [this]() { report(); });
+        timer->start(intervalSeconds * 1000);
+        m_reportTimer = timer;
+    }
+}
+
+bool WakeupCounter::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() == QEvent::Timer && watched != m_reportTimer) {
+        ++m_timerWakeups;
+        // A QTimer says little; whoever owns it is the one to look at
+        const QObject* source = qobject_cast<QTimer*>(watched) && watched->parent() ? watched->parent() : watched;
+        ++m_bySource[source->metaObject()->className()];
+    }
+    return false;
+}
+
+void WakeupCounter::report()
+{
+    const quint64 wakeups = m_timerWakeups - m_reportedWakeups;
+    const quint64 threadWakeups = this->threadWakeups() - m_reportedThreadWakeups;
+    const double seconds = m_sinceReport.isValid() ? m_sinceReport.elapsed() / 1000.0 : 0.0;
+    const QString summary = QStringLiteral("WakeupCounter: %1 timer wakeups in %2 s, %3 per second; "
+                                           "%4 worker thread wakeups, %5 per second")
+                                .arg(wakeups)
+                                .arg(seconds)
+                                .arg(seconds > 0.0 ? wakeups / seconds : 0.0)
+                                .arg(threadWakeups)
+                                .arg(seconds > 0.0 ? threadWakeups / seconds : 0.0);
+    // Asked for explicitly, so past the compile-time level that silences LOG_DEBUG in release
+    if (m_reportAtInfo) {
+        qCInfo(lcEventLoop).noquote() << summary;
+    } else {
+        LOG_DEBUG(lcEventLoop).noquote() << summary;
+    }
+
+    std::vector<std::pair<quint64, const char*>> sources;
+    for (auto it = m_bySource.cbegin(); it != m_bySource.cend(); ++it) {
+        sources.emplace_back(it.value(), it.key());
+    }
+    std::sort(sources.rbegin(), sources.rend());
+    for (const auto& [count, className] : sources) {
+        if (m_reportAtInfo) {
+            qCInfo(lcEventLoop) << "WakeupCounter:  " << className << count;
+        } else {
+            LOG_DEBUG(lcEventLoop) << "WakeupCounter:  " << className << count;
+        }
+    }
+
+    m_reportedWakeups = m_timerWakeups;
+    m_reportedThreadWakeups += threadWakeups;
+    m_bySource.clear();
+    m_sinceReport.restart();
+}
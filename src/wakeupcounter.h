@@ -0,0 +1,54 @@
+#ifndef WAKEUPCOUNTER_H
+#define WAKEUPCOUNTER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <atomic>
+
+// Counts the times the app wakes up, to check that it sleeps when idle: with
+// nothing playing, dragging, scrolling or animating, the counts should stay
+// where they are. On the GUI thread it filters the application's events and
+// counts the QEvent::Timer ones by where they came from: the receiver's class,
+// or a QTimer's parent's. Worker threads that sleep until signalled (decoders,
+// the real-time log) count their own wakeups through countThreadWakeup().
+//
+// Reports go to lcEventLoop at debug level. Setting MUSIC_APP_WAKEUP_REPORT
+// logs them at info level instead, which release builds keep, and a value of
+// N > 0 also reports every N seconds rather than only at exit and on
+// play/stop: MUSIC_APP_WAKEUP_REPORT=10 ./Music_App
+class WakeupCounter : public QObject
+{
+public:
+    static WakeupCounter& instance();
+
+    // Starts counting, and the periodic report if asked for; call once the
+    // QApplication exists
+    void install();
+
+    quint64 timerWakeups() const { return m_timerWakeups; }
+    quint64 threadWakeups() const { return s_threadWakeups.load(std::memory_order_relaxed); }
+
+    // Any thread; lock-free
+    static void countThreadWakeup() { s_threadWakeups.fetch_add(1, std::memory_order_relaxed); }
+
+    // Logs the wakeups since the last report, per second and by source
+    void report();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    WakeupCounter() = default;
+
+    quint64 m_timerWakeups = 0;
+    quint64 m_reportedWakeups = 0;
+    quint64 m_reportedThreadWakeups = 0;
+    static inline std::atomic<quint64> s_threadWakeups{0};
+    QHash<const char*, quint64> m_bySource; // Class names, since the last report
+    QElapsedTimer m_sinceReport;
+    bool m_reportAtInfo = false; // MUSIC_APP_WAKEUP_REPORT is set
+    QObject* m_reportTimer = nullptr; // Its own wakeups aren't counted
+};
+
+#endif // WAKEUPCOUNTER_H
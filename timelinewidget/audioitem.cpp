@@ -1,16 +1,25 @@
 #include "audioitem.h"
 #include <QPainter>
+#include <QGraphicsScene>
 #include <QGraphicsSceneMouseEvent>
-#include <QDebug>
+#include <QGraphicsView>
+#include <QStyleOptionGraphicsItem>
+#include <QPixmapCache>
+#include "../src/applog.h"
+#include "../src/mediacache.h"
 #include <QFileInfo>
 #include <QMenu>
 #include <QAction>
+#include <QtMath>
 #include <cmath>
 #include <cstdlib>
+#include <atomic>
 #include <QAudioFormat>
 #include <QFileInfo>
 #include <cmath>
 
+quint64 AudioItem::s_paintedClips = 0;
+
 AudioItem::AudioItem(int trackNumber, qreal startTime, qreal duration, const QColor& color, int trackHeight, QGraphicsItem* parent)
     : QGraphicsRectItem(parent),
     m_trackNumber(trackNumber),
@@ -21,40 +30,29 @@ AudioItem::AudioItem(int trackNumber, qreal startTime, qreal duration, const QCo
 {
     // Initialize the item's appearance here, if needed
     setZValue(1);
-    setFlags(ItemIsMovable | ItemSendsGeometryChanges|ItemIsSelectable);
+    setFlags(ItemIsMovable | ItemSendsGeometryChanges|ItemIsSelectable|ItemUsesExtendedStyleOption);
     // loadaudiowaveform("/home/gabhy/Documents/CuteFish_apps/Music_App/Music_App/testfile.mp3"); // TODO: Remove hard-coded path
     updateGeometry(startTime, duration);
 
 }
 
 AudioItem::~AudioItem() {
-    // Clear waveform data
-    m_waveform.clear();
-    
-#if HAVE_FFMPEG
-    // FFmpeg resources are cleaned up in processAudioFile() method
-    // No persistent FFmpeg resources to clean up here
-#endif
 }
 AudioResult AudioItem::loadaudiowaveform(const QString &filePath){
-    qDebug() << "AudioItem::loadaudiowaveform called with file:" << filePath;
-    qDebug() << "HAVE_FFMPEG is defined as:" << HAVE_FFMPEG;
-    
-    m_waveform.clear();
+    m_peaks = PeakPyramid();
+    m_peakScale = 1.0;
 #if HAVE_FFMPEG
     if (filePath.isEmpty()) {
         return AudioResult::error(AudioError::InvalidParameters, "File path is empty");
     }
-    qDebug() << "Using FFmpeg to process audio file";
+    LOG_DEBUG(lcWaveform) << "AudioItem: Using the media cache for the waveform";
     return processAudioFile(filePath);
 #else
-    qDebug() << "FFmpeg not available - using Qt Multimedia for basic waveform generation";
-    
     // Use Qt's QMediaPlayer to get basic audio information
     // For now, generate a more realistic-looking waveform based on file size/duration
     QFileInfo fileInfo(filePath);
     if (!fileInfo.exists()) {
-        qDebug() << "Audio file does not exist:" << filePath;
+        LOG_WARNING(lcWaveform) << "AudioItem: Audio file does not exist:" << filePath;
         return AudioResult::error(AudioError::FileNotFound, "Audio file not found: " + filePath);
     }
     
@@ -64,9 +62,9 @@ AudioResult AudioItem::loadaudiowaveform(const QString &filePath){
     int numSamples = qMin(static_cast<int>(fileSize / 1000), 1000); // Rough approximation
     numSamples = qMax(numSamples, 100); // Minimum samples
     
-    qDebug() << "Generating" << numSamples << "waveform samples for file size:" << fileSize << "bytes";
-    
-    // Generate more realistic audio-like waveform
+    // Generate more realistic audio-like waveform, one base bucket per value
+    QVector<Peak> base;
+    base.reserve(numSamples);
     for (int i = 0; i < numSamples; ++i) {
         // Create a more complex waveform that looks like real audio
         double t = static_cast<double>(i) / numSamples;
@@ -84,10 +82,12 @@ AudioResult AudioItem::loadaudiowaveform(const QString &filePath){
         
         // Clamp to reasonable range
         amplitude = qBound(-1.0, amplitude, 1.0);
-        m_waveform.push_back(amplitude);
+        const float level = static_cast<float>(std::abs(amplitude));
+        base.append(Peak{ -level, level, level * 0.7f });
     }
+    m_peaks = PeakPyramid::fromBaseLevel(base, static_cast<qint64>(numSamples) * PeakPyramid::BASE_BUCKET_FRAMES);
     
-    qDebug() << "Generated waveform with" << m_waveform.size() << "samples";
+    LOG_DEBUG(lcWaveform) << "AudioItem: Generated waveform with" << base.size() << "samples";
     update();
     return AudioResult::success();
 #endif
@@ -95,224 +95,181 @@ AudioResult AudioItem::loadaudiowaveform(const QString &filePath){
 
 #if HAVE_FFMPEG
 AudioResult AudioItem::processAudioFile(const QString &filePath) {
-    AVFormatContext *formatContext = avformat_alloc_context();
-    if (!formatContext) {
-        return AudioResult::error(AudioError::MemoryError, "Could not allocate format context");
+    // Peaks stored by an earlier decode are mapped rather than rebuilt
+    if (!MediaCache::instance().find(filePath)) {
+        const PeakPyramid peaks = MediaCache::instance().peakCache().map(filePath);
+        if (!peaks.isEmpty()) {
+            setPeaks(peaks);
+            return AudioResult::success();
+        }
     }
 
-    if (avformat_open_input(&formatContext, filePath.toStdString().c_str(), nullptr, nullptr) != 0) {
-        avformat_free_context(formatContext);
-        return AudioResult::error(AudioError::FileNotFound, "Could not open file: " + filePath);
+    // The file was decoded once at import; reuse its peaks instead of decoding again
+    AudioResult result;
+    QSharedPointer<const DecodedMedia> media = MediaCache::instance().load(filePath, &result);
+    if (!media) {
+        return result;
     }
 
-    if (avformat_find_stream_info(formatContext, nullptr) < 0) {
-        avformat_close_input(&formatContext);
-        return AudioResult::error(AudioError::DecodingFailed, "Could not find stream information");
-    }
+    setPeaks(media->peaks);
+    return AudioResult::success();
+}
+#endif // HAVE_FFMPEG
 
-    const AVCodec *codec = nullptr;
-    int streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
-    if (streamIndex < 0) {
-        avformat_close_input(&formatContext);
-        return AudioResult::error(AudioError::UnsupportedFormat, "Could not find audio stream");
-    }
+void AudioItem::setPeaks(const PeakPyramid &peaks) {
+    m_peaks = peaks;
+    m_peakScale = peakScaleFor(m_peaks);
+    invalidateTiles();
+}
 
-    AVStream *stream = formatContext->streams[streamIndex];
-    AVCodecContext *codecContext = avcodec_alloc_context3(codec);
-    if (!codecContext) {
-        avformat_close_input(&formatContext);
-        return AudioResult::error(AudioError::MemoryError, "Could not allocate codec context");
-    }
+qreal AudioItem::peakScaleFor(const PeakPyramid &peaks) {
+    // Normalize so quiet files still fill the clip
+    const Peak overall = peaks.overall();
+    const qreal maxAbsVal = qMax(std::abs(overall.min), std::abs(overall.max));
+    return maxAbsVal > 0.001 ? 1.0 / maxAbsVal : 1.0; // Avoid division by very small numbers
+}
 
-    if (avcodec_parameters_to_context(codecContext, stream->codecpar) < 0) {
-        avcodec_free_context(&codecContext);
-        avformat_close_input(&formatContext);
-        return AudioResult::error(AudioError::DecodingFailed, "Could not copy codec parameters");
+void AudioItem::setLoading(bool loading) {
+    if (m_loading != loading) {
+        m_loading = loading;
+        invalidateTiles();
     }
+}
 
-    if (avcodec_open2(codecContext, codec, nullptr) < 0) {
-        avcodec_free_context(&codecContext);
-        avformat_close_input(&formatContext);
-        return AudioResult::error(AudioError::DecodingFailed, "Could not open codec");
-    }
+void AudioItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
+    Q_UNUSED(widget)
 
-    // Initialize SwrContext for resampling
-    SwrContext *swrContext = swr_alloc();
-    if (!swrContext) {
-        avcodec_free_context(&codecContext);
-        avformat_close_input(&formatContext);
-        return AudioResult::error(AudioError::MemoryError, "Could not allocate resampler context");
+    const QRectF exposed = option->exposedRect.intersected(rect());
+    if (!m_dragProxy.isNull()) {
+        // Dragged past the proxy: the rest of the clip is drawn plain
+        if (!m_dragProxyRect.contains(exposed)) {
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(m_color);
+            painter->drawRoundedRect(rect(), 10, 10);
+        }
+        painter->drawPixmap(m_dragProxyRect, m_dragProxy, QRectF(m_dragProxy.rect()));
+        return;
     }
+    paintTiles(painter, rect(), exposed, tileKey(), m_peaks, m_peakScale, m_color, m_loading);
+}
 
-    // Handle FFmpeg API changes for channel layout
-    #if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 28, 100)
-        // New API (FFmpeg 5.0+)
-        av_opt_set_chlayout(swrContext, "in_chlayout", &codecContext->ch_layout, 0);
-        AVChannelLayout mono_layout = AV_CHANNEL_LAYOUT_MONO;
-        av_opt_set_chlayout(swrContext, "out_chlayout", &mono_layout, 0);
-    #else
-        // Old API (FFmpeg 4.x)
-        av_opt_set_int(swrContext, "in_channel_layout", codecContext->channel_layout, 0);
-        av_opt_set_int(swrContext, "out_channel_layout", AV_CH_LAYOUT_MONO, 0);
-    #endif
-    
-    av_opt_set_int(swrContext, "in_sample_rate", codecContext->sample_rate, 0);
-    av_opt_set_sample_fmt(swrContext, "in_sample_fmt", codecContext->sample_fmt, 0);
-    av_opt_set_int(swrContext, "out_sample_rate", codecContext->sample_rate, 0);
-    av_opt_set_sample_fmt(swrContext, "out_sample_fmt", AV_SAMPLE_FMT_FLT, 0);
-
-    if (swr_init(swrContext) < 0) {
-        swr_free(&swrContext);
-        avcodec_free_context(&codecContext);
-        avformat_close_input(&formatContext);
-        return AudioResult::error(AudioError::DecodingFailed, "Failed to initialize resampling context");
-    }
+QString AudioItem::tileKey() const {
+    // The width is part of the key, so zooming back finds the tiles drawn before
+    return QStringLiteral("AudioItem/%1/%2").arg(m_renderGeneration).arg(qRound64(rect().width() * 100.0));
+}
 
-    AVPacket *packet = av_packet_alloc();
-    AVFrame *frame = av_frame_alloc();
-    if (!packet || !frame) {
-        if (packet) av_packet_free(&packet);
-        if (frame) av_frame_free(&frame);
-        swr_free(&swrContext);
-        avcodec_free_context(&codecContext);
-        avformat_close_input(&formatContext);
-        return AudioResult::error(AudioError::MemoryError, "Could not allocate packet or frame");
+int AudioItem::paintTiles(QPainter *painter, const QRectF &bounds, const QRectF &exposed, const QString &cacheKey,
+                          const PeakPyramid &peaks, qreal peakScale, const QColor &color, bool loading) {
+    // Only the tiles under the exposed rect are drawn, from QPixmapCache when
+    // this zoom was drawn before; a playhead passing over the clip redraws a
+    // strip of one or two tiles and renders nothing
+    const qreal dpr = painter->device()->devicePixelRatioF();
+    const qreal scaleX = painter->worldTransform().m11() * dpr; // Physical pixels per item unit
+    const qreal scaleY = painter->worldTransform().m22() * dpr;
+    if (bounds.isEmpty() || exposed.isEmpty() || scaleX <= 0 || scaleY <= 0) {
+        return 0;
     }
-
-    int64_t totalSamples = 0;
-
-    while (av_read_frame(formatContext, packet) >= 0) {
-        if (packet->stream_index == streamIndex) {
-            if (avcodec_send_packet(codecContext, packet) == 0) {
-                while (avcodec_receive_frame(codecContext, frame) == 0) {
-                    // Allocate buffer for resampled data
-                    float *convertedSamples = nullptr;
-                    int outSamples = av_rescale_rnd(swr_get_delay(swrContext, codecContext->sample_rate) + frame->nb_samples, codecContext->sample_rate, codecContext->sample_rate, AV_ROUND_UP);
-                    int bufferSize = av_samples_alloc((uint8_t**)&convertedSamples, nullptr, 1, outSamples, AV_SAMPLE_FMT_FLT, 1);
-                    if (bufferSize < 0) {
-                        qDebug() << "Could not allocate resampled buffer";
-                        continue;
-                    }
-
-                    int samplesCount = swr_convert(swrContext, (uint8_t **)&convertedSamples, outSamples, (const uint8_t **)frame->data, frame->nb_samples);
-                    
-                    // Aggressive downsampling for performance - target ~200 samples max
-                    int downsampleFactor = qMax(1, samplesCount / 200); // Much less detail for 60fps performance
-                    for (int i = 0; i < samplesCount; i += downsampleFactor) {
-                        m_waveform.push_back(convertedSamples[i]);
-                    }
-                    totalSamples += samplesCount;
-
-                    // Free the resampled buffer
-                    av_freep(&convertedSamples);
-                }
-            }
+    ++s_paintedClips;
+
+    const qreal tileUnits = TILE_WIDTH / scaleX;
+    const qint64 tileCount = static_cast<qint64>(std::ceil(bounds.width() * scaleX / TILE_WIDTH));
+    const qint64 firstTile = qMax<qint64>(0, static_cast<qint64>(std::floor((exposed.left() - bounds.left()) / tileUnits)));
+    const qint64 endTile = qMin(tileCount, static_cast<qint64>(std::ceil((exposed.right() - bounds.left()) / tileUnits)));
+
+    int rendered = 0;
+    for (qint64 tile = firstTile; tile < endTile; ++tile) {
+        const QString key = QStringLiteral("%1/%2/%3/%4")
+                                .arg(cacheKey)
+                                .arg(qRound64(scaleX * 10000.0))
+                                .arg(qRound64(scaleY * 10000.0))
+                                .arg(tile);
+        QPixmap pixmap;
+        if (!QPixmapCache::find(key, &pixmap)) {
+            pixmap = renderTile(bounds.size(), tile, scaleX, scaleY, peaks, peakScale, color, loading);
+            QPixmapCache::insert(key, pixmap);
+            ++rendered;
         }
-        av_packet_unref(packet);
+        const QRectF target(bounds.left() + tile * tileUnits, bounds.top(), pixmap.width() / scaleX, bounds.height());
+        painter->drawPixmap(target, pixmap, QRectF(pixmap.rect()));
     }
 
-    av_frame_free(&frame);
-    av_packet_free(&packet);
-    swr_free(&swrContext);
-    avcodec_free_context(&codecContext);
-    avformat_close_input(&formatContext);
-
-    // Normalize the waveform using absolute values to handle both positive and negative peaks
-    if (!m_waveform.empty()) {
-        qreal maxAbsVal = 0.0;
-        for (const qreal &val : m_waveform) {
-            maxAbsVal = qMax(maxAbsVal, qAbs(val));
-        }
-        
-        qDebug() << "Waveform before normalization - samples:" << m_waveform.size() << "max absolute value:" << maxAbsVal;
-        
-        if (maxAbsVal > 0.001) { // Avoid division by very small numbers
-            for (qreal &val : m_waveform) {
-                val /= maxAbsVal;
-            }
-            qDebug() << "Waveform normalized successfully";
-        } else {
-            qDebug() << "Warning: Waveform has very low amplitude, may appear as flat line";
-        }
-        
-        // Log first few samples for debugging
-        qDebug() << "First 10 normalized samples:";
-        for (int i = 0; i < qMin(10, static_cast<int>(m_waveform.size())); ++i) {
-            qDebug() << "  Sample" << i << ":" << m_waveform[i];
-        }
-    }
-    
-    update();
-    return AudioResult::success();
+    LOG_TRACE(lcWaveform) << "AudioItem: Drew" << endTile - firstTile << "tiles," << rendered << "rendered";
+    return rendered;
 }
-#endif // HAVE_FFMPEG
 
-void AudioItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
-    Q_UNUSED(option)
-    Q_UNUSED(widget)
-
-    // Set the pen for the border of the rectangle
-    QPen pen(Qt::NoPen); // No border
-    painter->setPen(pen);
-
-    // Set the brush for the inside color of the rectangle
-    QBrush brush(m_color);
-    painter->setBrush(brush);
-
-    // Draw a rounded rectangle
-    qreal borderRadius = 10; // Adjust for desired border radius
-    QRectF roundedRect = rect();
-    painter->drawRoundedRect(roundedRect, borderRadius, borderRadius);
-
-    // Clip the drawing area to the rounded rectangle
+QPixmap AudioItem::renderTile(const QSizeF &size, qint64 tile, qreal scaleX, qreal scaleY, const PeakPyramid &peaks,
+                              qreal peakScale, const QColor &color, bool loading) {
+    // The tile covers physical pixel columns [tile * TILE_WIDTH, + TILE_WIDTH)
+    // of the clip; everything is drawn in those pixels, with the clip's left
+    // edge at x = -tile * TILE_WIDTH
+    const qreal clipWidth = size.width() * scaleX;
+    const qreal left = -static_cast<qreal>(tile) * TILE_WIDTH;
+    const int width = static_cast<int>(qMin<qreal>(TILE_WIDTH, std::ceil(clipWidth + left)));
+    const int height = qMax(1, static_cast<int>(std::ceil(size.height() * scaleY)));
+
+    QPixmap pixmap(qMax(1, width), height);
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // Draw a rounded rectangle and clip the waveform to it
+    const qreal borderRadius = 10; // In item units
+    const QRectF roundedRect(left, 0, clipWidth, height);
     QPainterPath clipPath;
-    clipPath.addRoundedRect(roundedRect, borderRadius, borderRadius);
-    painter->setClipPath(clipPath);
-
-    // Draw the waveform
-    if (!m_waveform.empty()) {
-        painter->setPen(QPen(Qt::black, 1));
-        painter->setBrush(Qt::NoBrush);
-
-        qreal width = roundedRect.width();
-        qreal height = roundedRect.height();
-        qreal centerY = roundedRect.top() + height / 2;
-
-        // Remove debug output for performance
-        // qDebug() << "Drawing waveform - width:" << width << "height:" << height << "centerY:" << centerY;
-        // qDebug() << "Waveform samples:" << m_waveform.size();
-
-        // Optimized waveform rendering - draw fewer lines for performance
-        int maxLines = qMin(static_cast<int>(width / 2), 100); // Max 100 lines or 1 line per 2 pixels
-        qreal step = width / maxLines;
-        int sampleStep = qMax(1, static_cast<int>(m_waveform.size()) / maxLines);
-        
-        for (int i = 0; i < maxLines && i * sampleStep < static_cast<int>(m_waveform.size()); ++i) {
-            qreal x = roundedRect.left() + i * step;
-            qreal amplitude = m_waveform[i * sampleStep];
-            
-            // Scale amplitude to use more of the available height
-            qreal scaledAmplitude = amplitude * (height * 0.3); // Use 30% of height for each direction
-            
-            // Draw vertical line from center
-            qreal y1 = centerY - scaledAmplitude;
-            qreal y2 = centerY + scaledAmplitude;
-            
-            painter->drawLine(QPointF(x, y1), QPointF(x, y2));
-            
-            // Remove debug output for performance
-            // if (i < 5) {
-            //     qDebug() << "Sample" << i << ": amplitude=" << amplitude << "scaledAmplitude=" << scaledAmplitude << "y1=" << y1 << "y2=" << y2;
-            // }
+    clipPath.addRoundedRect(roundedRect, borderRadius * scaleX, borderRadius * scaleY);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(color);
+    painter.drawPath(clipPath);
+    painter.setClipPath(clipPath);
+    painter.setRenderHint(QPainter::Antialiasing, false);
+
+    const qreal halfHeight = height * 0.45;
+    const qreal centerY = height / 2.0;
+    if (!peaks.isEmpty()) {
+        // One column per physical pixel, from the pyramid level that matches the zoom
+        const double framesPerPixel = peaks.frames() / clipWidth;
+        const int level = peaks.levelFor(framesPerPixel);
+        const qint64 firstPixel = static_cast<qint64>(tile) * TILE_WIDTH;
+
+        QVector<QLineF> peakLines;
+        QVector<QLineF> rmsLines;
+        peakLines.reserve(width);
+        rmsLines.reserve(width);
+        for (int column = 0; column < width; ++column) {
+            const qint64 pixel = firstPixel + column;
+            const qint64 firstFrame = static_cast<qint64>(pixel * framesPerPixel);
+            if (firstFrame >= peaks.frames()) {
+                break;
+            }
+            const qint64 endFrame = qMax(firstFrame + 1, static_cast<qint64>((pixel + 1) * framesPerPixel));
+            const Peak peak = peaks.range(level, firstFrame, endFrame);
+
+            const qreal x = column + 0.5;
+            const qreal high = qBound<qreal>(-1.0, peak.max * peakScale, 1.0);
+            const qreal low = qBound<qreal>(-1.0, peak.min * peakScale, 1.0);
+            const qreal rms = qMin<qreal>(peak.rms * peakScale, 1.0);
+            peakLines.append(QLineF(x, centerY - high * halfHeight, x, centerY - low * halfHeight));
+            rmsLines.append(QLineF(x, centerY - rms * halfHeight, x, centerY + rms * halfHeight));
         }
-        
-        qDebug() << "Waveform drawing completed";
-    } else {
-        qDebug() << "No waveform data to draw";
+
+        painter.setPen(QPen(Qt::black, 0));
+        painter.drawLines(peakLines);
+        painter.setPen(QPen(color.lighter(150), 0));
+        painter.drawLines(rmsLines);
+    } else if (loading) {
+        // Placeholder until the first decoded peaks arrive
+        painter.setPen(QPen(color.darker(150), 0, Qt::DashLine));
+        painter.drawLine(QLineF(0, centerY, width, centerY));
     }
 
-    // Reset clipping
-    painter->setClipping(false);
+    return pixmap;
+}
+
+void AudioItem::invalidateTiles() {
+    // Tiles are keyed by generation; stale ones age out of QPixmapCache
+    static std::atomic<quint64> nextGeneration{ 0 };
+    m_renderGeneration = ++nextGeneration;
+    update();
 }
 
 
@@ -324,8 +281,7 @@ QVariant AudioItem::itemChange(GraphicsItemChange change, const QVariant &value)
         qreal y = newPos.y();
         
         // Restrict the x-coordinate to 0 (left boundary)
-        qreal minX = -m_startTime;
-        x = qMax(x, minX);
+        x = qMax(x, 0.0);
         
         // Only restrict to not go above time indicator area
         y = qMax(y, static_cast<qreal>(m_timeIndicatorHeight));
@@ -353,12 +309,7 @@ void AudioItem::mousePressEvent(QGraphicsSceneMouseEvent *event)
         return;
     }
     
-    qDebug() << "\n=== MOUSE PRESS EVENT ===";
-    qDebug() << "Mouse press at scene position:" << event->scenePos();
-    qDebug() << "Item position before press:" << pos();
-    qDebug() << "Item scene position before press:" << scenePos();
-    qDebug() << "Item bounding rect:" << boundingRect();
-    qDebug() << "Current track number:" << m_trackNumber;
+    LOG_TRACE(lcTimeline) << "AudioItem: Pressed at" << event->scenePos() << "on track" << m_trackNumber << "at" << pos();
     
     // Capture the initial scene position of the item
     m_initialPos = scenePos();
@@ -366,35 +317,20 @@ void AudioItem::mousePressEvent(QGraphicsSceneMouseEvent *event)
     m_pressPos = event->scenePos();
     QGraphicsItem::mousePressEvent(event);
     emit currentItem(this);
-    
-    qDebug() << "=== END MOUSE PRESS ===\n";
 }
 
 void AudioItem::showContextMenu(const QPoint& globalPos) {
-    qDebug() << "=== SHOWING CONTEXT MENU - DEEP DEBUG ===";
-    qDebug() << "Item requesting context menu:" << (void*)this;
-    qDebug() << "Item track number:" << m_trackNumber;
-    qDebug() << "Item position:" << pos();
-    qDebug() << "Item scene:" << (void*)scene();
-    qDebug() << "Item parent:" << (void*)parentItem();
-    
     QMenu contextMenu;
     
     QAction* removeAction = contextMenu.addAction("Remove Audio Track");
     removeAction->setIcon(QIcon(":/icons/delete")); // Optional icon
     
-    qDebug() << "Context menu created, executing...";
     QAction* selectedAction = contextMenu.exec(globalPos);
     
     if (selectedAction == removeAction) {
-        qDebug() << "Remove action selected, emitting removeRequested signal...";
+        LOG_DEBUG(lcTimeline) << "AudioItem: Remove requested for the clip on track" << m_trackNumber;
         emit removeRequested(this);
-        qDebug() << "removeRequested signal emitted";
-    } else {
-        qDebug() << "No action selected or different action selected";
     }
-    
-    qDebug() << "=== CONTEXT MENU COMPLETE - DEEP DEBUG ===";
 }
 
 void AudioItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
@@ -403,115 +339,103 @@ void AudioItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
     moveCounter++;
     
     if (moveCounter % 10 == 0) {
-        qDebug() << "=== MOUSE MOVE EVENT #" << moveCounter << "===";
-        qDebug() << "Mouse scene position:" << event->scenePos();
-        qDebug() << "Item position before move:" << pos();
-        qDebug() << "Item scene position before move:" << scenePos();
+        LOG_TRACE(lcTimeline) << "=== MOUSE MOVE EVENT #" << moveCounter << "===";
+        LOG_TRACE(lcTimeline) << "Mouse scene position:" << event->scenePos();
+        LOG_TRACE(lcTimeline) << "Item position before move:" << pos();
+        LOG_TRACE(lcTimeline) << "Item scene position before move:" << scenePos();
     }
     
+    if (!m_dragging && (event->buttons() & Qt::LeftButton)) {
+        beginDrag();
+    }
     QGraphicsItem::mouseMoveEvent(event);
     
     if (moveCounter % 10 == 0) {
-        qDebug() << "Item position after move:" << pos();
-        qDebug() << "Item scene position after move:" << scenePos();
-        qDebug() << "=== END MOUSE MOVE #" << moveCounter << "===\n";
+        LOG_TRACE(lcTimeline) << "Item position after move:" << pos();
+        LOG_TRACE(lcTimeline) << "Item scene position after move:" << scenePos();
+        LOG_TRACE(lcTimeline) << "=== END MOUSE MOVE #" << moveCounter << "===\n";
     }
     
     if(this->pos().x()<0)
     {
         setPos(0,pos().y());
     }
-    update();
-    emit itemMoved(this);
+    // Moving the item repaints where it was and where it is; nothing else to
+    // update until release
+}
+
+void AudioItem::beginDrag()
+{
+    m_dragging = true;
+    QGraphicsView* view = scene() && !scene()->views().isEmpty() ? scene()->views().first() : nullptr;
+    if (!view) {
+        return; // Drawn from tiles as usual
+    }
+
+    // The part of the clip on screen and a screen's width either side of it
+    const QRectF visible = mapFromScene(view->mapToScene(view->viewport()->rect()).boundingRect()).boundingRect();
+    const qreal left = qMax(rect().left(), visible.left() - visible.width());
+    const qreal right = qMin(rect().right(), visible.right() + visible.width());
+    if (right <= left) {
+        return;
+    }
+    const QRectF proxyRect(left, rect().top(), right - left, rect().height());
+
+    // Rendered at the view's scale, so the tiles it is drawn from are the cached ones
+    const QTransform toDevice = deviceTransform(view->viewportTransform());
+    const qreal dpr = view->devicePixelRatioF();
+    const qreal scaleX = std::abs(toDevice.m11());
+    const qreal scaleY = std::abs(toDevice.m22());
+    QPixmap proxy(qMax(1, qCeil(proxyRect.width() * scaleX * dpr)), qMax(1, qCeil(proxyRect.height() * scaleY * dpr)));
+    proxy.setDevicePixelRatio(dpr);
+    proxy.fill(Qt::transparent);
+    QPainter painter(&proxy);
+    painter.scale(scaleX, scaleY);
+    painter.translate(-proxyRect.topLeft());
+    const int rendered = paintTiles(&painter, rect(), proxyRect, tileKey(), m_peaks, m_peakScale, m_color, m_loading);
+    painter.end();
+
+    m_dragProxy = proxy;
+    m_dragProxyRect = proxyRect;
+    LOG_TRACE(lcTimeline) << "AudioItem: Drag proxy of" << proxy.width() << "x" << proxy.height() << "px,"
+                          << rendered << "tiles rendered";
+}
+
+void AudioItem::endDrag()
+{
+    if (m_dragging) {
+        m_dragging = false;
+        m_dragProxy = QPixmap();
+        update(); // Back to the tiles
+    }
 }
 
 void AudioItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
-    qDebug() << "\n=== MOUSE RELEASE EVENT - DETAILED ANALYSIS ===";
-    
     QGraphicsItem::mouseReleaseEvent(event);
     
-    // Get all position information
-    QPointF currentPos = pos();
-    QPointF currentScenePos = scenePos();
-    QRectF itemRect = boundingRect();
-    
-    qDebug() << "CURRENT POSITIONS:";
-    qDebug() << "  - Item pos():" << currentPos;
-    qDebug() << "  - Item scenePos():" << currentScenePos;
-    qDebug() << "  - Mouse release scene pos:" << event->scenePos();
-    qDebug() << "  - Item bounding rect:" << itemRect;
-    qDebug() << "  - Item height:" << itemRect.height();
-    qDebug() << "  - Current track number:" << m_trackNumber;
-    
-    // Use scene position for calculations (more reliable)
-    qreal currentY = currentScenePos.y();
-    qreal itemTop = currentY;
-    qreal itemBottom = currentY + itemRect.height();
-    qreal itemCenterY = currentY + (itemRect.height() / 2);
-    
-    qDebug() << "ITEM BOUNDARIES:";
-    qDebug() << "  - Item top Y:" << itemTop;
-    qDebug() << "  - Item center Y:" << itemCenterY;
-    qDebug() << "  - Item bottom Y:" << itemBottom;
-    
-    // Get timeline measurements (we need to access these from parent somehow)
-    // For now, use hardcoded values but log them clearly
-    qreal timeIndicatorHeight = 25.0; // This should come from timeline
-    qreal trackHeight = m_trackHeight;
-    
-    qDebug() << "TIMELINE MEASUREMENTS:";
-    qDebug() << "  - Time indicator height:" << timeIndicatorHeight;
-    qDebug() << "  - Track height:" << trackHeight;
-    
-    // Calculate which tracks the item overlaps
-    qDebug() << "TRACK OVERLAP ANALYSIS:";
-    for (int trackIdx = 0; trackIdx < 10; ++trackIdx) { // Check first 10 tracks
-        qreal trackStartY = timeIndicatorHeight + (trackIdx * trackHeight);
-        qreal trackEndY = trackStartY + trackHeight;
-        qreal trackCenterY = trackStartY + (trackHeight / 2);
-        
-        // Calculate overlap
-        qreal overlapStart = qMax(itemTop, trackStartY);
-        qreal overlapEnd = qMin(itemBottom, trackEndY);
-        qreal overlapHeight = qMax(0.0, overlapEnd - overlapStart);
-        qreal overlapPercentage = (overlapHeight / itemRect.height()) * 100.0;
-        
-        qDebug() << "  Track" << trackIdx << ":";
-        qDebug() << "    - Track Y range:" << trackStartY << "to" << trackEndY << "(center:" << trackCenterY << ")";
-        qDebug() << "    - Overlap height:" << overlapHeight << "(" << overlapPercentage << "%)";
-        
-        if (overlapPercentage > 50.0) {
-            qDebug() << "    *** MAJORITY OVERLAP - SHOULD SNAP TO THIS TRACK ***";
-            
-            // Snap to this track
-            qreal newY = trackStartY;
-            QPointF newPos(currentPos.x(), newY);
-            
-            qDebug() << "SNAPPING ACTION:";
-            qDebug() << "  - Snapping to track" << trackIdx;
-            qDebug() << "  - New position:" << newPos;
-            qDebug() << "  - Old track number:" << m_trackNumber << "-> New track number:" << trackIdx;
-            
-            setPos(newPos);
-            m_trackNumber = trackIdx;
-            break;
-        }
+    // Snap to the track holding most of the clip, i.e. the one under its centre
+    const QPointF currentPos = pos();
+    const qreal itemCenterY = scenePos().y() + boundingRect().height() / 2;
+    if (m_trackHeight > 0 && itemCenterY >= m_timeIndicatorHeight) {
+        const int trackIdx = static_cast<int>((itemCenterY - m_timeIndicatorHeight) / m_trackHeight);
+        const QPointF newPos(currentPos.x(), m_timeIndicatorHeight + trackIdx * m_trackHeight);
+        LOG_TRACE(lcTimeline) << "AudioItem: Released at" << event->scenePos() << ", snapping from track" << m_trackNumber
+                              << "to" << trackIdx << "at" << newPos;
+        setPos(newPos);
+        m_trackNumber = trackIdx;
     }
     
     // Ensure X position doesn't go negative
     if (pos().x() < 0) {
-        qDebug() << "CORRECTING NEGATIVE X POSITION";
         setPos(0, pos().y());
     }
     
-    qDebug() << "FINAL POSITION:" << pos();
-    qDebug() << "FINAL SCENE POSITION:" << scenePos();
-    
-    setStartTime(pos().x());
+    setStartTime(pos().x() / m_pixelsPerSecond);
+    endDrag();
     emit positionChanged(pos());
     
-    qDebug() << "=== END MOUSE RELEASE EVENT ===\n";
+    LOG_DEBUG(lcTimeline) << "AudioItem: Moved to track" << m_trackNumber << "at" << m_startTime << "seconds";
 }
 
 
@@ -544,6 +468,7 @@ int AudioItem::trackNumber() const {
 void AudioItem::setColor(const QColor &color) {
     m_color = color;
     setBrush(color);
+    invalidateTiles();
 }
 
 QColor AudioItem::color() const {
@@ -555,11 +480,20 @@ void AudioItem::updateGeometry(qreal startTime, qreal duration) {
     m_duration = duration;
     setColor(m_color);
     
-    // Convert duration from seconds to pixels (100 pixels = 1 second)
-    qreal widthInPixels = m_duration * 100.0;
+    // Convert duration from seconds to pixels at the current zoom
+    qreal widthInPixels = m_duration * m_pixelsPerSecond;
     
-    qDebug() << "AudioItem::updateGeometry - Duration:" << m_duration << "seconds, Width:" << widthInPixels << "pixels";
+    LOG_TRACE(lcTimeline) << "AudioItem: Duration" << m_duration << "seconds, width" << widthInPixels << "pixels";
     
-    setRect(startTime, 0, widthInPixels, m_trackHeight);
+    setRect(0, 0, widthInPixels, m_trackHeight);
+    setPos(m_startTime * m_pixelsPerSecond, pos().y());
     update();
 }
+
+void AudioItem::setPixelsPerSecond(qreal pixelsPerSecond) {
+    // Re-laid out, not re-rendered: tiles at this width may still be cached
+    m_pixelsPerSecond = pixelsPerSecond;
+    m_dragProxy = QPixmap(); // Drawn for the old width
+    setRect(0, 0, m_duration * m_pixelsPerSecond, m_trackHeight);
+    setPos(m_startTime * m_pixelsPerSecond, pos().y());
+}
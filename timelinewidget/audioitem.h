@@ -8,18 +8,10 @@
 #include <QBrush>
 #include <QMenu>
 #include <QAction>
-#include <vector>
+#include <QPixmap>
 #include "../src/audioerror.h"
-
-#if HAVE_FFMPEG
-extern "C" {
-#include <libavformat/avformat.h>
-#include <libavcodec/avcodec.h>
-#include <libavutil/avutil.h>
-#include <libswresample/swresample.h>
-#include <libavutil/opt.h>
-}
-#endif
+#include "../src/peakpyramid.h"
+#include "timescale.h"
 
 class AudioItem : public QObject,public QGraphicsRectItem {
     Q_OBJECT
@@ -32,6 +24,8 @@ public:
 
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
 
+    // Seconds, as is the duration; the item is laid out from them at the
+    // timeline's pixels per second
     void setStartTime(qreal startTime);
     qreal startTime() const;
 
@@ -45,9 +39,32 @@ public:
     QColor color() const;
 
     void updateGeometry(qreal startTime, qreal duration);
+    void setPixelsPerSecond(qreal pixelsPerSecond);
 
     AudioResult loadaudiowaveform(const QString &filePath);
 
+    // Waveform to draw, possibly partial while the file is still decoding
+    void setPeaks(const PeakPyramid &peaks);
+    // Shows a placeholder until the first peaks arrive
+    void setLoading(bool loading);
+    bool isLoading() const { return m_loading; }
+
+    // Source file played by this clip
+    void setFilePath(const QString &filePath) { m_filePath = filePath; }
+    QString filePath() const { return m_filePath; }
+
+    // A clip is drawn as cached tiles of TILE_WIDTH physical pixels. These
+    // draw the part of a clip at bounds that lies in exposed; cacheKey names
+    // everything the tiles show except the zoom, and must change with it.
+    // Returns the number of tiles rendered rather than found in QPixmapCache.
+    static constexpr int TILE_WIDTH = 256;
+    static int paintTiles(QPainter *painter, const QRectF &bounds, const QRectF &exposed, const QString &cacheKey,
+                          const PeakPyramid &peaks, qreal peakScale, const QColor &color, bool loading);
+    // Gain that makes the loudest peak fill the clip
+    static qreal peakScaleFor(const PeakPyramid &peaks);
+    // Clips drawn through paintTiles so far, for the benchmarks
+    static quint64 paintedClipCount() { return s_paintedClips; }
+
 
 private:
     int m_trackNumber;
@@ -55,7 +72,9 @@ private:
     QPointF m_pressPos;
     qreal m_startTime;
     qreal m_duration;
+    qreal m_pixelsPerSecond = TimeScale::DEFAULT_PIXELS_PER_SECOND;
     QColor m_color;
+    QString m_filePath;
     int m_trackHeight; // New private member variable to store track height
     int m_timeIndicatorHeight = 0; // Store time indicator height for positioning
     QPointF m_lastPos; // Store last mouse press position for dragging
@@ -65,7 +84,28 @@ private:
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
     // Item change event handler
     QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
-    std::vector<qreal> m_waveform;
+    PeakPyramid m_peaks; // Waveform at every zoom level
+    qreal m_peakScale = 1.0; // Gain that makes the loudest peak fill the clip
+    bool m_loading = false;
+
+    // Tiles are keyed by render generation, width, zoom and device pixel
+    // ratio; any other change to what a tile shows moves the item to a new
+    // generation
+    quint64 m_renderGeneration = 0;
+    static quint64 s_paintedClips; // GUI thread only
+    static QPixmap renderTile(const QSizeF &size, qint64 tile, qreal scaleX, qreal scaleY, const PeakPyramid &peaks,
+                              qreal peakScale, const QColor &color, bool loading);
+    void invalidateTiles();
+    QString tileKey() const;
+
+    // While dragging, the clip is drawn from one pixmap of the part on
+    // screen, so moving it costs a blit however long it is. The model
+    // (start time, positionChanged) is updated on release.
+    void beginDrag();
+    void endDrag();
+    QPixmap m_dragProxy;
+    QRectF m_dragProxyRect; // Item coordinates the proxy covers
+    bool m_dragging = false;
 
 #if HAVE_FFMPEG
     AudioResult processAudioFile(const QString &filePath);
@@ -73,7 +113,6 @@ private:
 
 signals:
     void positionChanged(const QPointF& newPosition);
-    void itemMoved(AudioItem* item);
     void currentItem(AudioItem* item);
     void removeRequested(AudioItem* item);
 
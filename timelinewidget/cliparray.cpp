@@ -0,0 +1,118 @@
+#include "cliparray.h"
+#include <algorithm>
+
+int ClipArray::add(const ClipRecord& clip)
+{
+    // Loops are usually laid down left to right, which appends
+    const int index = upperBound(clip.start);
+    m_clips.insert(index, clip);
+    m_maxLength = std::max(m_maxLength, clip.length);
+    if (!m_endStale) {
+        m_end = std::max(m_end, clip.end());
+    }
+    return index;
+}
+
+void ClipArray::remove(int index)
+{
+    const double end = m_clips[index].end();
+    m_clips.remove(index);
+    if (m_clips.isEmpty()) {
+        m_maxLength = 0.0;
+        m_end = 0.0;
+        m_endStale = false;
+    } else {
+        endChanged(end, 0.0);
+    }
+}
+
+int ClipArray::move(int index, double start)
+{
+    ClipRecord clip = m_clips[index];
+    const double end = clip.end();
+    clip.start = start;
+    endChanged(end, clip.end());
+    const int target = upperBound(start);
+
+    // Shift the clips in between by one instead of erasing and inserting
+    ClipRecord* clips = m_clips.data();
+    if (target > index + 1) {
+        std::rotate(clips + index, clips + index + 1, clips + target);
+        clips[target - 1] = clip;
+        return target - 1;
+    }
+    if (target < index) {
+        std::rotate(clips + target, clips + index, clips + index + 1);
+        clips[target] = clip;
+        return target;
+    }
+    clips[index] = clip;
+    return index;
+}
+
+void ClipArray::setLength(int index, double length)
+{
+    const double end = m_clips[index].end();
+    m_clips[index].length = length;
+    m_maxLength = std::max(m_maxLength, length);
+    endChanged(end, m_clips[index].end());
+}
+
+void ClipArray::clear()
+{
+    m_clips.clear();
+    m_maxLength = 0.0;
+    m_end = 0.0;
+    m_endStale = false;
+}
+
+void ClipArray::span(double from, double to, int* first, int* end) const
+{
+    const auto byStart = [](const ClipRecord& clip, double start) { return clip.start < start; };
+    *first = static_cast<int>(std::lower_bound(m_clips.begin(), m_clips.end(), from - m_maxLength, byStart) - m_clips.begin());
+    *end = static_cast<int>(std::lower_bound(m_clips.begin() + *first, m_clips.end(), to, byStart) - m_clips.begin());
+}
+
+int ClipArray::clipAt(double seconds) const
+{
+    for (int index = upperBound(seconds) - 1; index >= 0; --index) {
+        const ClipRecord& clip = m_clips[index];
+        if (clip.start < seconds - m_maxLength) {
+            break; // Nothing further left reaches it
+        }
+        if (seconds < clip.end()) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+double ClipArray::end() const
+{
+    if (m_endStale) {
+        m_end = 0.0;
+        for (const ClipRecord& clip : m_clips) {
+            m_end = std::max(m_end, clip.end());
+        }
+        m_endStale = false;
+    }
+    return m_end;
+}
+
+void ClipArray::endChanged(double from, double to)
+{
+    if (m_endStale) {
+        return;
+    }
+    if (to >= m_end) {
+        m_end = to;
+    } else if (from >= m_end) {
+        m_endStale = true; // The last clip moved in; found again when asked
+    }
+}
+
+int ClipArray::upperBound(double start) const
+{
+    const auto byStart = [](double value, const ClipRecord& clip) { return value < clip.start; };
+    return static_cast<int>(std::upper_bound(m_clips.begin(), m_clips.end(), start, byStart) - m_clips.begin());
+}
@@ -0,0 +1,62 @@
+#ifndef CLIPARRAY_H
+#define CLIPARRAY_H
+
+#include <QRgb>
+#include <QVector>
+
+// One clip of a batched track: plain data, no QObject or scene item
+struct ClipRecord {
+    double start = 0.0;  // Seconds
+    double length = 0.0; // Seconds
+    quint64 id = 0;      // Stable identity, for the mixer
+    quint32 source = 0;  // Index of the clip's file in the track's sources
+    QRgb color = 0;
+
+    double end() const { return start + length; }
+};
+
+// The clips of one track, kept sorted by start.
+//
+// Finding the clips in a span or under a point is a binary search: clips
+// starting before span's end are a prefix, and none that starts more than
+// the longest clip before the span's start can reach into it. Drawing and
+// hit-testing therefore cost O(log n + visible clips) however many clips
+// the track holds. Indices change when clips are added, moved or removed.
+class ClipArray
+{
+public:
+    int size() const { return static_cast<int>(m_clips.size()); }
+    bool isEmpty() const { return m_clips.isEmpty(); }
+    const ClipRecord& at(int index) const { return m_clips[index]; }
+    const QVector<ClipRecord>& records() const { return m_clips; }
+    void reserve(int count) { m_clips.reserve(count); }
+
+    // Returns the index it lands at; after any clips with the same start
+    int add(const ClipRecord& clip);
+    void remove(int index);
+    // Returns the clip's new index
+    int move(int index, double start);
+    void setLength(int index, double length);
+    void clear();
+
+    // Index of the first clip, and one past the last, that may overlap
+    // [from, to) seconds; clips in between that end before from are skipped
+    // by the caller
+    void span(double from, double to, int* first, int* end) const;
+    // The clip drawn on top at the time (the last one in order), or -1
+    int clipAt(double seconds) const;
+    // Largest end of any clip; 0 if there are none. Kept as clips change,
+    // rescanned only after the clip that ended last moved in or went away.
+    double end() const;
+
+private:
+    int upperBound(double start) const; // First clip starting after start
+    void endChanged(double from, double to); // A clip's end moved
+
+    QVector<ClipRecord> m_clips;
+    double m_maxLength = 0.0; // Never shrinks on removal, which only widens span()
+    mutable double m_end = 0.0;
+    mutable bool m_endStale = false;
+};
+
+#endif // CLIPARRAY_H
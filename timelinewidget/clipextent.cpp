@@ -0,0 +1,34 @@
+#include "clipextent.h"
+
+bool ClipExtent::set(quint64 id, double end)
+{
+    const double before = this->end();
+    const auto found = m_clips.find(id);
+    if (found == m_clips.end()) {
+        m_clips.insert(id, m_ends.insert(end));
+    } else if (*found.value() != end) {
+        // Reuses the node: moving a clip allocates nothing
+        Ends::node_type node = m_ends.extract(found.value());
+        node.value() = end;
+        found.value() = m_ends.insert(std::move(node));
+    }
+    return this->end() != before;
+}
+
+bool ClipExtent::remove(quint64 id)
+{
+    const auto found = m_clips.find(id);
+    if (found == m_clips.end()) {
+        return false;
+    }
+    const double before = end();
+    m_ends.erase(found.value());
+    m_clips.erase(found);
+    return end() != before;
+}
+
+void ClipExtent::clear()
+{
+    m_ends.clear();
+    m_clips.clear();
+}
@@ -0,0 +1,34 @@
+#ifndef CLIPEXTENT_H
+#define CLIPEXTENT_H
+
+#include <QHash>
+#include <QtGlobal>
+#include <set>
+
+// The end of the arrangement: the latest end, in seconds, of any clip.
+//
+// Every clip's end is kept in an ordered multiset, so adding, moving or
+// removing one costs O(log n) and the extent is the last key, where it
+// used to take a walk over every track and clip on each change. Callers
+// name clips by the id the mixer uses; a track's batched clips count as
+// one entry, their ClipArray's end.
+class ClipExtent
+{
+public:
+    // Adds the clip or moves its end; true if that changed end()
+    bool set(quint64 id, double end);
+    // True if that changed end()
+    bool remove(quint64 id);
+    void clear();
+
+    double end() const { return m_ends.empty() ? 0.0 : *m_ends.rbegin(); }
+    int size() const { return static_cast<int>(m_ends.size()); }
+
+private:
+    using Ends = std::multiset<double>;
+
+    Ends m_ends;
+    QHash<quint64, Ends::iterator> m_clips;
+};
+
+#endif // CLIPEXTENT_H
@@ -0,0 +1,101 @@
+#include "playheadanimator.h"
+#include "../src/applog.h"
+#include "../src/transportclock.h"
+#include <QEvent>
+#include <QScreen>
+#include <QWidget>
+#include <cmath>
+
+PlayheadAnimator::PlayheadAnimator(QWidget* surface, QObject* parent)
+    : QObject(parent)
+    , m_surface(surface)
+{
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameTimer, &QTimer::timeout, this, &PlayheadAnimator::onFrame);
+    m_surface->installEventFilter(this);
+}
+
+void PlayheadAnimator::start(const TransportClock* clock)
+{
+    if (!clock) {
+        return;
+    }
+
+    m_clock = clock;
+    m_shownFrame = -1;
+    m_driftPaints = 0;
+    m_driftSumMs = 0.0;
+    m_driftMaxMs = 0.0;
+    m_driftOverFrame = 0;
+    m_statsTimer.start();
+
+    // Tick at the display's rate; rounding down means no frame goes without a new position
+    const QScreen* screen = m_surface->screen();
+    const qreal refreshRate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+    m_frameIntervalMs = 1000.0 / refreshRate;
+    m_frameTimer.start(qMax(1, static_cast<int>(m_frameIntervalMs)));
+
+    LOG_DEBUG(lcTimeline) << "PlayheadAnimator: Following the transport clock at" << refreshRate << "Hz";
+    onFrame();
+}
+
+void PlayheadAnimator::stop()
+{
+    if (!m_clock) {
+        return;
+    }
+
+    m_frameTimer.stop();
+    const DriftStats stats = driftStats();
+    LOG_DEBUG(lcTimeline) << "PlayheadAnimator: Stopped after" << stats.paints << "paints, drift mean"
+                          << stats.meanMilliseconds << "ms, max" << stats.maxMilliseconds << "ms,"
+                          << stats.paintsOverOneFrame << "over one frame";
+    m_clock = nullptr;
+}
+
+PlayheadAnimator::DriftStats PlayheadAnimator::driftStats() const
+{
+    DriftStats stats;
+    stats.paints = m_driftPaints;
+    stats.meanMilliseconds = m_driftPaints > 0 ? m_driftSumMs / m_driftPaints : 0.0;
+    stats.maxMilliseconds = m_driftMaxMs;
+    stats.paintsOverOneFrame = m_driftOverFrame;
+    return stats;
+}
+
+void PlayheadAnimator::onFrame()
+{
+    if (!m_clock) {
+        return;
+    }
+
+    const qint64 frame = m_clock->playbackFrameAt(TransportClock::nowNanoseconds());
+    if (frame != m_shownFrame) {
+        m_shownFrame = frame;
+        emit positionChanged(static_cast<double>(frame) / m_clock->sampleRate());
+    }
+
+    if (m_statsTimer.elapsed() >= STATS_INTERVAL_MS) {
+        const DriftStats stats = driftStats();
+        LOG_DEBUG(lcTimeline) << "PlayheadAnimator: Drift mean" << stats.meanMilliseconds << "ms, max"
+                              << stats.maxMilliseconds << "ms over" << stats.paints << "paints (frame"
+                              << m_frameIntervalMs << "ms)";
+        m_statsTimer.restart();
+    }
+}
+
+bool PlayheadAnimator::eventFilter(QObject* watched, QEvent* event)
+{
+    // The surface is about to draw m_shownFrame; compare it with what is heard now
+    if (watched == m_surface && event->type() == QEvent::Paint && m_clock && m_shownFrame >= 0) {
+        const qint64 audible = m_clock->playbackFrameAt(TransportClock::nowNanoseconds());
+        const double driftMs = std::abs(static_cast<double>(m_shownFrame - audible)) * 1000.0 / m_clock->sampleRate();
+        ++m_driftPaints;
+        m_driftSumMs += driftMs;
+        m_driftMaxMs = qMax(m_driftMaxMs, driftMs);
+        if (driftMs > m_frameIntervalMs) {
+            ++m_driftOverFrame;
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
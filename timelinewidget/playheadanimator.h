@@ -0,0 +1,67 @@
+#ifndef PLAYHEADANIMATOR_H
+#define PLAYHEADANIMATOR_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+class QWidget;
+class TransportClock;
+
+// Moves the playhead from the audio clock while the engine plays.
+//
+// Once per display frame it reads TransportClock::playbackFrameAt(now), the
+// audible frame extrapolated from the last audio callback, and reports where
+// the playhead belongs; nothing else moves it during playback, so engine
+// position signals and timers cannot fight over it.
+//
+// Drift is measured where it matters: each time the surface paints, the
+// position being drawn is compared with what is audible at that moment. It
+// should stay under one display frame; the statistics are logged once per
+// STATS_INTERVAL_MS at debug level.
+class PlayheadAnimator : public QObject
+{
+    Q_OBJECT
+public:
+    // surface: the widget the playhead is painted on, for the frame rate and
+    // the drift measurement
+    explicit PlayheadAnimator(QWidget* surface, QObject* parent = nullptr);
+
+    void start(const TransportClock* clock);
+    void stop();
+    bool isRunning() const { return m_clock != nullptr; }
+
+    struct DriftStats {
+        qint64 paints = 0; // Since start()
+        double meanMilliseconds = 0.0; // |drawn - audible|
+        double maxMilliseconds = 0.0;
+        qint64 paintsOverOneFrame = 0;
+    };
+    DriftStats driftStats() const;
+    double frameIntervalMilliseconds() const { return m_frameIntervalMs; }
+
+    static constexpr int STATS_INTERVAL_MS = 1000;
+
+signals:
+    void positionChanged(double seconds);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void onFrame();
+
+    QWidget* m_surface;
+    const TransportClock* m_clock = nullptr;
+    QTimer m_frameTimer;
+    double m_frameIntervalMs = 1000.0 / 60.0;
+    qint64 m_shownFrame = -1; // Transport frame last reported; -1 before the first
+
+    qint64 m_driftPaints = 0;
+    double m_driftSumMs = 0.0;
+    double m_driftMaxMs = 0.0;
+    qint64 m_driftOverFrame = 0;
+    QElapsedTimer m_statsTimer;
+};
+
+#endif // PLAYHEADANIMATOR_H
@@ -0,0 +1,339 @@
+#include "timelineview.h"
+#include "../src/applog.h"
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QVector>
+#include <cmath>
+#include <iterator>
+
+namespace {
+
+// Candidate label spacings, in seconds, each with the number of grid lines
+// per label that still reads well at that spacing
+constexpr struct {
+    double seconds;
+    int minorDivisions;
+} STEPS[] = {
+    { 0.01, 2 }, { 0.02, 2 }, { 0.05, 5 }, { 0.1, 2 }, { 0.2, 2 }, { 0.5, 5 },
+    { 1, 2 }, { 2, 2 }, { 5, 5 }, { 10, 2 }, { 15, 3 }, { 30, 2 },
+    { 60, 2 }, { 120, 2 }, { 300, 5 }, { 600, 2 }, { 900, 3 }, { 1800, 2 }, { 3600, 2 }
+};
+
+} // namespace
+
+TimelineView::TimelineView(QGraphicsScene* scene, QWidget* parent)
+    : QGraphicsView(scene, parent)
+    , m_labelFont("Arial", 9, QFont::Medium)
+{
+    m_statsTimer.start();
+}
+
+void TimelineView::setRulerHeight(int height)
+{
+    m_rulerHeight = height;
+    resetCachedContent();
+    viewport()->update();
+}
+
+TimelineView::TickSpacing TimelineView::tickSpacing(double pixelsPerSecond)
+{
+    for (const auto& step : STEPS) {
+        if (step.seconds * pixelsPerSecond >= MIN_LABEL_SPACING) {
+            return { step.seconds, step.minorDivisions };
+        }
+    }
+    const auto& coarsest = STEPS[std::size(STEPS) - 1];
+    return { coarsest.seconds, coarsest.minorDivisions };
+}
+
+QString TimelineView::timeLabel(qint64 milliseconds, int decimals)
+{
+    const qint64 totalSeconds = milliseconds / 1000;
+    const qint64 hours = totalSeconds / 3600;
+    const qint64 minutes = totalSeconds / 60 % 60;
+    const qint64 seconds = totalSeconds % 60;
+
+    QString text = hours > 0 ? QString("%1:%2:%3")
+                                   .arg(hours)
+                                   .arg(minutes, 2, 10, QChar('0'))
+                                   .arg(seconds, 2, 10, QChar('0'))
+                             : QString("%1:%2").arg(minutes, 2, 10, QChar('0')).arg(seconds, 2, 10, QChar('0'));
+    if (decimals > 0) {
+        const qint64 fraction = milliseconds % 1000 / (decimals == 1 ? 100 : 10);
+        text += QString(".%1").arg(fraction, decimals, 10, QChar('0'));
+    }
+    return text;
+}
+
+const QStaticText& TimelineView::label(qint64 milliseconds, int decimals)
+{
+    const qint64 key = milliseconds * 4 + decimals;
+    const auto cached = m_labels.constFind(key);
+    if (cached != m_labels.constEnd()) {
+        return *cached;
+    }
+
+    // Zooming through many spacings only ever needs the labels on screen
+    if (m_labels.size() >= MAX_CACHED_LABELS) {
+        m_labels.clear();
+    }
+
+    QStaticText text(timeLabel(milliseconds, decimals));
+    text.setTextFormat(Qt::PlainText);
+    text.setPerformanceHint(QStaticText::AggressiveCaching);
+    text.prepare(QTransform(), m_labelFont);
+    return *m_labels.insert(key, text);
+}
+
+void TimelineView::drawBackground(QPainter* painter, const QRectF& rect)
+{
+    QGraphicsView::drawBackground(painter, rect);
+
+    const QRectF area = rect.intersected(sceneRect());
+    const QTransform toDevice = painter->worldTransform();
+    const double pixelsPerSecond = m_pixelsPerSecond * toDevice.m11();
+    if (area.isEmpty() || pixelsPerSecond <= 0.0) {
+        return;
+    }
+
+    const TickSpacing spacing = tickSpacing(pixelsPerSecond);
+    const double minorStep = spacing.major / spacing.minorDivisions;
+    const int decimals = spacing.major < 0.1 ? 2 : spacing.major < 1.0 ? 1 : 0;
+
+    // One label step early: a label reaches to the right of its line
+    const qint64 firstTick = qMax<qint64>(
+        0, static_cast<qint64>(std::floor((area.left() / m_pixelsPerSecond - spacing.major) / minorStep)));
+    const qint64 lastTick = static_cast<qint64>(std::ceil(area.right() / m_pixelsPerSecond / minorStep));
+
+    // Grid, one drawLines call per pen
+    const qreal gridTop = qMax<qreal>(area.top(), m_rulerHeight);
+    if (gridTop < area.bottom()) {
+        QVector<QLineF> majorLines;
+        QVector<QLineF> minorLines;
+        for (qint64 tick = firstTick; tick <= lastTick; ++tick) {
+            const qreal x = tick * minorStep * m_pixelsPerSecond;
+            (tick % spacing.minorDivisions == 0 ? majorLines : minorLines).append(QLineF(x, gridTop, x, area.bottom()));
+        }
+
+        // Cosmetic: one device pixel wide at any zoom
+        static const QPen majorPen(QColor(100, 100, 100), 0);
+        static const QPen minorPen(QColor(60, 60, 60), 0);
+        painter->setPen(minorPen);
+        painter->drawLines(minorLines);
+        painter->setPen(majorPen);
+        painter->drawLines(majorLines);
+    }
+
+    // Ruler labels, in device coordinates so zooming never stretches them
+    if (area.top() < m_rulerHeight) {
+        painter->save();
+        painter->resetTransform();
+        painter->setFont(m_labelFont);
+        painter->setPen(QColor(200, 200, 200));
+        for (qint64 tick = firstTick - firstTick % spacing.minorDivisions; tick <= lastTick;
+             tick += spacing.minorDivisions) {
+            const double seconds = tick * minorStep;
+            const QPointF position = toDevice.map(QPointF(seconds * m_pixelsPerSecond, 2));
+            painter->drawStaticText(position + QPointF(5, 0), label(qRound64(seconds * 1000.0), decimals));
+        }
+        painter->restore();
+    }
+}
+
+void TimelineView::setPixelsPerSecond(double pixelsPerSecond)
+{
+    if (pixelsPerSecond == m_pixelsPerSecond || pixelsPerSecond <= 0.0) {
+        return;
+    }
+
+    // The playhead stays at the same time; everything under it moved
+    m_playheadX *= pixelsPerSecond / m_pixelsPerSecond;
+    m_pixelsPerSecond = pixelsPerSecond;
+    m_bandRect = QRect();
+    m_playheadDirty = QRegion();
+    resetCachedContent();
+    viewport()->update();
+}
+
+void TimelineView::setPlayheadPosition(qreal sceneX)
+{
+    if (sceneX == m_playheadX) {
+        return;
+    }
+
+    const QRegion previous = playheadRegion();
+    m_playheadX = sceneX;
+    const QRegion dirty = previous + playheadRegion();
+    m_playheadDirty += dirty;
+    viewport()->update(dirty);
+}
+
+QRect TimelineView::playheadHeadRect() const
+{
+    // Antialiased triangle plus its pen
+    const QPoint top = mapFromScene(QPointF(m_playheadX, m_rulerHeight));
+    return QRect(top.x() - PLAYHEAD_HEAD_SIZE / 2 - 2, top.y() - 2, PLAYHEAD_HEAD_SIZE + 5, PLAYHEAD_HEAD_SIZE + 4);
+}
+
+QRect TimelineView::playheadLineRect() const
+{
+    const QPoint top = mapFromScene(QPointF(m_playheadX, m_rulerHeight));
+    const int bottom = mapFromScene(QPointF(m_playheadX, sceneRect().bottom())).y();
+    return QRect(top.x() - 1, top.y() + PLAYHEAD_HEAD_SIZE, 2, qMax(0, bottom - top.y() - PLAYHEAD_HEAD_SIZE));
+}
+
+QRegion TimelineView::playheadRegion() const
+{
+    return (QRegion(playheadHeadRect()) + playheadLineRect()) & viewport()->rect();
+}
+
+void TimelineView::drawPlayhead(QPainter* painter) const
+{
+    static const QPen pen(Qt::green, 2);
+    static const QBrush brush(Qt::green);
+
+    const QRect line = playheadLineRect();
+    const QPointF tip(line.left() + 1, line.top());
+    const QPolygonF triangle({ tip + QPointF(-PLAYHEAD_HEAD_SIZE / 2, -PLAYHEAD_HEAD_SIZE),
+                               tip + QPointF(PLAYHEAD_HEAD_SIZE / 2, -PLAYHEAD_HEAD_SIZE), tip });
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, true);
+    painter->setPen(pen);
+    painter->setBrush(brush);
+    painter->drawPolygon(triangle);
+    painter->fillRect(line, brush); // Pixel aligned, so it stays inside its strip
+    painter->restore();
+}
+
+bool TimelineView::coverWithBand(const QRect& needed)
+{
+    if (m_bandRect.contains(needed)) {
+        return true;
+    }
+
+    // A seek far away: not worth a band, paint the strips from the scene
+    const QRect visible = viewport()->rect();
+    if (needed.width() > PLAYHEAD_BAND_WIDTH) {
+        return false;
+    }
+
+    // Centred on the playhead, so playback crosses half a band before the next render
+    const int left = qBound(visible.left(), needed.center().x() - PLAYHEAD_BAND_WIDTH / 2,
+                            qMax(visible.left(), visible.right() + 1 - PLAYHEAD_BAND_WIDTH));
+    const QRect band = QRect(left, visible.top(), PLAYHEAD_BAND_WIDTH, visible.height()) & visible;
+    if (!band.contains(needed)) {
+        return false;
+    }
+
+    const qreal ratio = viewport()->devicePixelRatioF();
+    if (m_band.size() != band.size() * ratio || m_band.devicePixelRatio() != ratio) {
+        m_band = QPixmap(band.size() * ratio);
+        m_band.setDevicePixelRatio(ratio);
+    }
+    m_band.fill(viewport()->palette().color(viewport()->backgroundRole()));
+
+    QPainter painter(&m_band);
+    painter.setRenderHints(renderHints());
+    render(&painter, QRectF(QPointF(0, 0), band.size()), band);
+    painter.end();
+
+    m_bandRect = band;
+    m_stats.scenePixels += static_cast<qint64>(band.width()) * band.height();
+    return true;
+}
+
+void TimelineView::paintEvent(QPaintEvent* event)
+{
+    const QRegion exposed = event->region();
+    // Scene updates cover whole items plus a margin, so an exposed region
+    // inside the playhead strips was only asked for by the playhead
+    const bool playheadOnly = !m_playheadDirty.isEmpty() && (exposed - m_playheadDirty).isEmpty();
+    m_playheadDirty = QRegion();
+    ++m_stats.paints;
+
+    if (playheadOnly && coverWithBand(exposed.boundingRect())) {
+        QPainter painter(viewport());
+        const qreal ratio = m_band.devicePixelRatio();
+        for (const QRect& rect : exposed) {
+            const QRectF source(QPointF(rect.topLeft() - m_bandRect.topLeft()) * ratio, QSizeF(rect.size()) * ratio);
+            painter.drawPixmap(QRectF(rect), m_band, source);
+            m_stats.blittedPixels += static_cast<qint64>(rect.width()) * rect.height();
+        }
+        drawPlayhead(&painter);
+    } else {
+        QGraphicsView::paintEvent(event);
+        if (exposed.intersects(m_bandRect)) {
+            m_bandRect = QRect();
+        }
+        for (const QRect& rect : exposed) {
+            m_stats.scenePixels += static_cast<qint64>(rect.width()) * rect.height();
+        }
+
+        QPainter painter(viewport());
+        drawPlayhead(&painter);
+    }
+
+    logRepaintStats();
+}
+
+void TimelineView::logRepaintStats()
+{
+    if (m_statsTimer.elapsed() < STATS_INTERVAL_MS) {
+        return;
+    }
+
+    const qint64 paints = m_stats.paints - m_loggedStats.paints;
+    if (paints > 0) {
+        LOG_TRACE(lcTimeline) << "TimelineView:" << paints << "paints,"
+                              << (m_stats.scenePixels - m_loggedStats.scenePixels) / paints
+                              << "px/paint from the scene,"
+                              << (m_stats.blittedPixels - m_loggedStats.blittedPixels) / paints
+                              << "px/paint from the playhead band";
+    }
+    m_loggedStats = m_stats;
+    m_statsTimer.restart();
+}
+
+void TimelineView::scrollContentsBy(int dx, int dy)
+{
+    // The viewport's pixels move, the band's do not
+    m_bandRect = QRect();
+    QGraphicsView::scrollContentsBy(dx, dy);
+}
+
+void TimelineView::mousePressEvent(QMouseEvent* event)
+{
+    const QPoint position = event->position().toPoint();
+    const QRect line = playheadLineRect();
+    if (event->button() == Qt::LeftButton && qAbs(position.x() - line.center().x()) <= PLAYHEAD_GRAB_DISTANCE
+        && position.y() >= playheadHeadRect().top() && position.y() <= line.bottom()) {
+        m_draggingPlayhead = true;
+        event->accept();
+        return;
+    }
+    QGraphicsView::mousePressEvent(event);
+}
+
+void TimelineView::mouseMoveEvent(QMouseEvent* event)
+{
+    if (m_draggingPlayhead) {
+        const qreal sceneX = qMax<qreal>(0.0, mapToScene(event->position().toPoint()).x());
+        setPlayheadPosition(sceneX);
+        emit playheadDragged(sceneX);
+        event->accept();
+        return;
+    }
+    QGraphicsView::mouseMoveEvent(event);
+}
+
+void TimelineView::mouseReleaseEvent(QMouseEvent* event)
+{
+    if (m_draggingPlayhead && event->button() == Qt::LeftButton) {
+        m_draggingPlayhead = false;
+        event->accept();
+        return;
+    }
+    QGraphicsView::mouseReleaseEvent(event);
+}
@@ -0,0 +1,106 @@
+#ifndef TIMELINEVIEW_H
+#define TIMELINEVIEW_H
+
+#include <QElapsedTimer>
+#include <QFont>
+#include <QGraphicsView>
+#include <QHash>
+#include <QPixmap>
+#include <QRegion>
+#include <QStaticText>
+#include "timescale.h"
+
+// The timeline's view. It paints the time ruler and the grid itself, in
+// drawBackground, instead of keeping scene items for them.
+//
+// Only the exposed part of the scene is painted, so the cost follows the
+// size of the window, not the length of the session. The tick spacing
+// follows the horizontal zoom, so labels never crowd together. Labels are
+// drawn unscaled from cached QStaticText.
+//
+// The playhead is not a scene item either. It is drawn over the scene, and
+// the view keeps a band of rendered scene around it. Moving the playhead
+// repaints just its old and new strips from that band, without painting any
+// clip. The band is rendered again only when the playhead leaves it or
+// something else repaints it.
+class TimelineView : public QGraphicsView
+{
+    Q_OBJECT
+public:
+    explicit TimelineView(QGraphicsScene* scene, QWidget* parent = nullptr);
+
+    // Scene height of the ruler strip above the tracks; grid lines start below it
+    void setRulerHeight(int height);
+    int rulerHeight() const { return m_rulerHeight; }
+
+    // Horizontal zoom, as set on the TimeScale; the view itself is never
+    // scaled horizontally
+    void setPixelsPerSecond(double pixelsPerSecond);
+    double pixelsPerSecond() const { return m_pixelsPerSecond; }
+
+    void setPlayheadPosition(qreal sceneX);
+    qreal playheadPosition() const { return m_playheadX; }
+
+    // Viewport pixels repainted, by source
+    struct RepaintStats {
+        qint64 paints = 0;
+        qint64 scenePixels = 0;   // Painted from the scene: backgrounds, clips, band renders
+        qint64 blittedPixels = 0; // Copied from the playhead band
+    };
+    const RepaintStats& repaintStats() const { return m_stats; }
+    void resetRepaintStats() { m_stats = RepaintStats(); }
+
+    static constexpr qreal MIN_LABEL_SPACING = 80.0;  // Device pixels between labelled lines
+    static constexpr int MAX_CACHED_LABELS = 1024;
+    static constexpr int PLAYHEAD_HEAD_SIZE = 20;
+    static constexpr int PLAYHEAD_GRAB_DISTANCE = 10;
+    static constexpr int PLAYHEAD_BAND_WIDTH = 256; // About 2.5 s of playback at the default zoom
+    static constexpr int STATS_INTERVAL_MS = 1000;
+
+signals:
+    void playheadDragged(qreal sceneX);
+
+protected:
+    void drawBackground(QPainter* painter, const QRectF& rect) override;
+    void paintEvent(QPaintEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+
+private:
+    struct TickSpacing {
+        double major;       // Seconds between labelled lines
+        int minorDivisions; // Unlabelled lines per major step
+    };
+
+    // Smallest spacing that keeps labels MIN_LABEL_SPACING apart
+    static TickSpacing tickSpacing(double pixelsPerSecond);
+    static QString timeLabel(qint64 milliseconds, int decimals);
+    const QStaticText& label(qint64 milliseconds, int decimals);
+
+    QRect playheadHeadRect() const; // Viewport pixels of the triangle
+    QRect playheadLineRect() const; // Viewport pixels of the line below it
+    QRegion playheadRegion() const;
+    void drawPlayhead(QPainter* painter) const;
+    // Renders the band around the playhead if it does not cover needed yet
+    bool coverWithBand(const QRect& needed);
+    void logRepaintStats();
+
+    int m_rulerHeight = 0;
+    double m_pixelsPerSecond = TimeScale::DEFAULT_PIXELS_PER_SECOND;
+    QFont m_labelFont;
+    QHash<qint64, QStaticText> m_labels; // By time and precision
+
+    qreal m_playheadX = 0.0;
+    bool m_draggingPlayhead = false;
+    QRegion m_playheadDirty; // Requested by playhead moves since the last paint
+    QPixmap m_band;          // Scene without the playhead, at m_bandRect
+    QRect m_bandRect;        // Viewport coordinates; null when stale
+
+    RepaintStats m_stats;
+    RepaintStats m_loggedStats;
+    QElapsedTimer m_statsTimer;
+};
+
+#endif // TIMELINEVIEW_H
@@ -1,4 +1,6 @@
 #include "timelinewidget.h"
+#include "../src/applog.h"
+#include "../src/mediacache.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QScrollBar>
@@ -6,17 +8,14 @@
 #include <QKeyEvent>
 #include <QWheelEvent>
 #include <QFileInfo>
+#include <QPixmapCache>
 
-#if HAVE_FFMPEG
-extern "C" {
-#include <libavformat/avformat.h>
-#include <libavutil/avutil.h>
-}
-#endif
 #include <QDebug>
 #include <QScrollBar>
 #include <QPoint>
 #include <QTime>
+#include <QElapsedTimer>
+#include <cmath>
 
 TimelineWidget::TimelineWidget(QWidget* parent) :
     QWidget(parent),
@@ -27,16 +26,44 @@ TimelineWidget::TimelineWidget(QWidget* parent) :
     scrollLeft(false),
     scrollRight(false),
     m_trackIdWidth(AppConfig::instance().getTrackIdWidth()),
-    m_isMoving(false)
+    m_isMoving(false),
+    m_batchedClips(AppConfig::instance().getBatchedClips())
 {
     // Calculate time indicator height
     QFont timeFont("Arial", 10);
     QFontMetrics fm(timeFont);
     m_timeIndicatorHeight = fm.height() + 5; // Add some padding
     
+    // Room for a few screens of waveform tiles (AudioItem::paint)
+    QPixmapCache::setCacheLimit(qMax(QPixmapCache::cacheLimit(), 64 * 1024));
+    
+    // Edits made in one go (adding a thousand clips, say) are announced once
+    m_arrangementTimer = new QTimer(this);
+    m_arrangementTimer->setSingleShot(true);
+    m_arrangementTimer->setInterval(0);
+    connect(m_arrangementTimer, &QTimer::timeout, this, &TimelineWidget::arrangementChanged);
+    
+    m_waveformLoader = new WaveformLoader(this);
+    connect(m_waveformLoader, &WaveformLoader::loaded, this, &TimelineWidget::onWaveformLoaded);
+    connect(m_waveformLoader, &WaveformLoader::failed, this, [](AudioItem* item, const AudioResult& result) {
+        LOG_WARNING(lcWaveform) << "TimelineWidget: Could not load waveform data for" << item->filePath() << "-"
+                                << result.getErrorMessage();
+    });
+    connect(m_waveformLoader, &WaveformLoader::sourcePeaksChanged, this, &TimelineWidget::onSourcePeaksChanged);
+    connect(m_waveformLoader, &WaveformLoader::sourceLoaded, this, &TimelineWidget::onSourceLoaded);
+    connect(m_waveformLoader, &WaveformLoader::sourceFailed, this, [this](const QString& filePath, const AudioResult& result) {
+        LOG_WARNING(lcWaveform) << "TimelineWidget: Could not load waveform data for" << filePath << "-" << result.getErrorMessage();
+        for (Track* track : m_tracks) {
+            track->setSourceLoading(filePath, false);
+        }
+    });
+    
     setupUi();
     createTracksAndItems();
     setupConnections();
+    
+    m_playheadAnimator = new PlayheadAnimator(m_view->viewport(), this);
+    connect(m_playheadAnimator, &PlayheadAnimator::positionChanged, this, &TimelineWidget::placePlayhead);
 }
 
 void TimelineWidget::createTracksAndItems() {
@@ -62,122 +89,139 @@ void TimelineWidget::createTracksAndItems() {
     }
 }
 
-void TimelineWidget::addAudioItemToTrack(const QString& filePath, int trackIndex, const QColor& itemColor) {
-    qDebug() << "=== TimelineWidget::addAudioItemToTrack START ===";
-    qDebug() << "File path:" << filePath;
-    qDebug() << "Track index:" << trackIndex;
-    qDebug() << "Item color:" << itemColor.name();
-    qDebug() << "Number of tracks available:" << m_tracks.size();
-    
+void TimelineWidget::addAudioItemToTrack(const QString& filePath, int trackIndex, const QColor& itemColor, double startSeconds) {
     // Ensure we have tracks and the requested track exists
     if (m_tracks.isEmpty() || trackIndex >= m_tracks.size() || trackIndex < 0) {
-        qDebug() << "ERROR: Cannot add audio item: invalid track index" << trackIndex << "or no tracks available";
+        LOG_WARNING(lcTimeline) << "TimelineWidget: Cannot add audio item: invalid track index" << trackIndex
+                                << "of" << m_tracks.size();
         return;
     }
     
     Track* targetTrack = m_tracks[trackIndex];
     if (!targetTrack) {
-        qDebug() << "ERROR: Cannot add audio item: target track is null";
+        LOG_WARNING(lcTimeline) << "TimelineWidget: Cannot add audio item: target track is null";
         return;
     }
-    qDebug() << "Target track found and valid";
     
     // Get real audio file duration
     qreal actualDuration = getAudioFileDuration(filePath);
     
-    // Create audio item at timeline start position (0,0)
-    qreal startTime = 0.0; // Start at beginning of timeline
+    // Create audio item at the requested start, the beginning of the timeline by default
+    qreal startTime = qMax(0.0, startSeconds);
     qreal duration = actualDuration > 0 ? actualDuration : 300.0; // Use actual duration or fallback to 3 seconds
     QColor color = QColor::fromHsv(120, 180, 220); // Nice blue-green color for loaded audio
     
-    qDebug() << "=== AUDIO FILE DURATION DETECTION ===";
-    qDebug() << "File:" << filePath;
-    qDebug() << "Raw duration from getAudioFileDuration():" << actualDuration << "seconds";
-    qDebug() << "Final duration being used:" << duration << "seconds";
-    qDebug() << "Duration in pixels (100px/sec):" << (duration * 100.0) << "pixels";
-    qDebug() << "Duration in minutes:" << (duration / 60.0) << "minutes";
-    qDebug() << "=========================================";
-    
-    qDebug() << "Creating AudioItem with parameters:";
-    qDebug() << "  - trackIndex:" << trackIndex;
-    qDebug() << "  - startTime:" << startTime;
-    qDebug() << "  - duration:" << duration;
-    qDebug() << "  - trackHeight:" << m_trackHeight;
-    
-    AudioItem* audioItem = new AudioItem(trackIndex, startTime, duration, itemColor, m_trackHeight, nullptr);
-    if (!audioItem) {
-        qDebug() << "ERROR: Failed to create audio item";
+    if (m_batchedClips) {
+        // A record in the track's clip array: no item, no connections, and
+        // no log line, so importing thousands of clips stays cheap
+        bool newSource = false;
+        targetTrack->addClip(filePath, startTime, duration, itemColor, &newSource);
+#if HAVE_FFMPEG
+        if (newSource) {
+            targetTrack->setSourceLoading(filePath, true);
+            m_waveformLoader->loadSource(filePath);
+        }
+#endif
+        updateExtent(targetTrack);
+        scheduleArrangementChanged();
         return;
     }
     
+    AudioItem* audioItem = new AudioItem(trackIndex, startTime, duration, itemColor, m_trackHeight, nullptr);
+    
     // Set the time indicator height for proper positioning calculations
     audioItem->setTimeIndicatorHeight(m_timeIndicatorHeight);
-    qDebug() << "AudioItem created successfully";
+    audioItem->setPixelsPerSecond(m_timeScale.pixelsPerSecond());
+    audioItem->setFilePath(filePath);
     
+#if !HAVE_FFMPEG
     // Load waveform data from the audio file
-    qDebug() << "Loading waveform data...";
     AudioResult waveformResult = audioItem->loadaudiowaveform(filePath);
     if (!waveformResult.isSuccess()) {
-        qDebug() << "WARNING: Could not load waveform data:" << waveformResult.getErrorMessage();
+        LOG_WARNING(lcWaveform) << "TimelineWidget: Could not load waveform data for" << filePath << "-"
+                                << waveformResult.getErrorMessage();
         // Continue anyway - the item will still be created without waveform visualization
-    } else {
-        qDebug() << "Waveform data loaded successfully";
     }
+#endif
     
-    // === POSITIONING MEASUREMENTS LOG ===
-    qDebug() << "=== AUDIO ITEM INITIAL POSITIONING ===";
-    qDebug() << "Timeline measurements:";
-    qDebug() << "  - m_timeIndicatorHeight:" << m_timeIndicatorHeight;
-    qDebug() << "  - m_trackHeight:" << m_trackHeight;
-    qDebug() << "  - scene_height:" << scene_height;
-    qDebug() << "  - Number of tracks:" << m_tracks.size();
-    
-    qDebug() << "Audio item parameters:";
-    qDebug() << "  - Target track index:" << trackIndex;
-    qDebug() << "  - Start time:" << startTime;
-    qDebug() << "  - Duration:" << duration;
-    
-    // Calculate Y position with detailed logging
+    // Top of the target track, below the time indicator
     qreal yPos = m_timeIndicatorHeight + (trackIndex * m_trackHeight);
-    qDebug() << "Position calculation:";
-    qDebug() << "  - Formula: m_timeIndicatorHeight + (trackIndex * m_trackHeight)";
-    qDebug() << "  - Calculation:" << m_timeIndicatorHeight << " + (" << trackIndex << " * " << m_trackHeight << ")";
-    qDebug() << "  - Result Y position:" << yPos;
-    
-    // Log track boundaries for reference
-    for (int i = 0; i < m_tracks.size(); ++i) {
-        qreal trackStartY = m_timeIndicatorHeight + (i * m_trackHeight);
-        qreal trackEndY = trackStartY + m_trackHeight;
-        qDebug() << "  - Track" << i << "boundaries: Y" << trackStartY << "to" << trackEndY;
-    }
-    
-    audioItem->setPos(startTime, yPos);
-    qDebug() << "Audio item positioned at scene coordinates (" << startTime << "," << yPos << ")";
-    qDebug() << "=== END INITIAL POSITIONING ===\n";
+    audioItem->setPos(m_timeScale.x(startTime), yPos);
     
     // Add to track and scene
-    qDebug() << "Adding audio item to track...";
     targetTrack->addAudioItem(audioItem);
-    qDebug() << "Audio item added to track";
-    
-    qDebug() << "Adding audio item to scene...";
     if (!m_scene) {
-        qDebug() << "ERROR: Scene is null!";
+        LOG_WARNING(lcTimeline) << "TimelineWidget: Cannot add audio item: scene is null";
         return;
     }
     m_scene->addItem(audioItem);
-    qDebug() << "Audio item added to scene";
     
-    // Connect signals with detailed logging
-    qDebug() << "Connecting signals for item:" << (void*)audioItem;
-    qDebug() << "Connecting currentItem signal...";
     QObject::connect(audioItem, &AudioItem::currentItem, this, &TimelineWidget::setCurrentItem);
-    qDebug() << "Connecting removeRequested signal...";
     QObject::connect(audioItem, &AudioItem::removeRequested, this, &TimelineWidget::removeAudioItem);
-    qDebug() << "All signals connected for item:" << (void*)audioItem;
+    QObject::connect(audioItem, &AudioItem::positionChanged, this, &TimelineWidget::handleAudioItemPositionChange);
+    updateExtent(audioItem);
+    
+#if HAVE_FFMPEG
+    // Decoded in the background; the clip fills in as the decode progresses
+    m_waveformLoader->load(audioItem, filePath);
+#endif
+    
+    LOG_DEBUG(lcTimeline) << "TimelineWidget: Added audio item to track" << trackIndex << "at" << startTime
+                          << "seconds," << duration << "seconds long, from file:" << filePath;
     
-    qDebug() << "Successfully added audio item to track" << trackIndex << "from file:" << filePath;
-    qDebug() << "=== TimelineWidget::addAudioItemToTrack END ===";
+    scheduleArrangementChanged();
+}
+
+void TimelineWidget::scheduleArrangementChanged()
+{
+    m_arrangementTimer->start();
+}
+
+void TimelineWidget::flushArrangementChanged()
+{
+    if (m_arrangementTimer->isActive()) {
+        m_arrangementTimer->stop();
+        emit arrangementChanged();
+    }
+}
+
+MixerArrangement TimelineWidget::mixerArrangement() const
+{
+    MixerArrangement arrangement;
+    arrangement.tracks.reserve(m_tracks.size());
+    for (Track* track : m_tracks) {
+        MixerTrack mixerTrack;
+        mixerTrack.volume = track->getVolume();
+        mixerTrack.pan = track->getPan();
+        mixerTrack.muted = track->isMuted();
+        mixerTrack.soloed = track->isSoloed();
+        arrangement.tracks.append(mixerTrack);
+        
+        for (AudioItem* item : track->audioItems()) {
+            if (item->filePath().isEmpty()) {
+                continue; // Placeholder item without audio
+            }
+            MixerClip clip;
+            clip.id = reinterpret_cast<quintptr>(item);
+            clip.filePath = item->filePath();
+            clip.startSeconds = item->startTime();
+            clip.durationSeconds = item->duration();
+            clip.trackIndex = item->trackNumber(); // Dragging can move an item to another track
+            arrangement.clips.append(clip);
+        }
+
+        // Batched clips stay on the track that draws them
+        for (const ClipRecord& record : track->clips().records()) {
+            MixerClip clip;
+            clip.id = record.id;
+            clip.filePath = track->sourcePath(record.source);
+            clip.startSeconds = record.start;
+            clip.durationSeconds = record.length;
+            clip.trackIndex = track->getIndex();
+            arrangement.clips.append(clip);
+        }
+    }
+    return arrangement;
 }
 
 int TimelineWidget::getTrackCount() const
@@ -185,32 +229,23 @@ int TimelineWidget::getTrackCount() const
     return m_tracks.size();
 }
 
-void TimelineWidget::onTrackMuteToggled(bool muted)
+void TimelineWidget::onTrackMuteToggled(Track* track, bool muted)
 {
-    // Find which track header widget sent the signal
-    TrackHeaderWidget* senderWidget = qobject_cast<TrackHeaderWidget*>(sender());
-    if (!senderWidget) {
-        qDebug() << "TimelineWidget: Could not identify sender of mute toggle signal";
-        return;
-    }
-    
-    qDebug() << "TimelineWidget: Track mute toggled to" << muted;
+    LOG_DEBUG(lcTimeline) << "TimelineWidget: Track" << track->getIndex() << "mute toggled to" << muted;
     
-    // The track model is already updated by the TrackHeaderWidget
-    // Here we could add additional logic like:
-    // - Update audio engine to actually mute the track
-    // - Visual feedback in the timeline
-    // - Notify other components
+    // The track is already updated by the header model,
+    // let the audio engine pick up the new mix
+    scheduleArrangementChanged();
 }
 
 void TimelineWidget::openTrackSettingsDialog(Track* track)
 {
     if (!track) {
-        qDebug() << "TimelineWidget: Cannot open settings for null track";
+        LOG_WARNING(lcTimeline) << "TimelineWidget: Cannot open settings for null track";
         return;
     }
     
-    qDebug() << "TimelineWidget: Opening settings dialog for track" << track->getIndex();
+    LOG_DEBUG(lcTimeline) << "TimelineWidget: Opening settings dialog for track" << track->getIndex();
     
     // Create and show the track settings dialog
     TrackSettingsDialog* dialog = new TrackSettingsDialog(track, this);
@@ -222,11 +257,12 @@ void TimelineWidget::openTrackSettingsDialog(Track* track)
     int result = dialog->exec();
     
     if (result == QDialog::Accepted) {
-        qDebug() << "TimelineWidget: Track settings dialog accepted";
+        LOG_DEBUG(lcTimeline) << "TimelineWidget: Track settings dialog accepted";
         // Settings are already applied by the dialog
-        // Could add additional processing here if needed
+        m_trackModel->trackChanged(track);
+        scheduleArrangementChanged();
     } else {
-        qDebug() << "TimelineWidget: Track settings dialog cancelled";
+        LOG_DEBUG(lcTimeline) << "TimelineWidget: Track settings dialog cancelled";
     }
     
     // Clean up
@@ -239,45 +275,35 @@ void TimelineWidget::setupUi() {
     configureSplitter();
     setupTrackList();
     setupGraphicsView();
-    addTimeIndicators();
-    addSecondLines();
 
     QWidget* trackListContainer = new QWidget();
     QVBoxLayout* trackListLayout = new QVBoxLayout(trackListContainer);
     trackListLayout->setContentsMargins(0, 0, 0, 0); // Remove any extra padding
     trackListLayout->setSpacing(0);
     trackListLayout->addSpacing(m_timeIndicatorHeight);
-    trackListLayout->addWidget(m_trackList);
+    trackListLayout->addWidget(m_trackHeaders);
     m_splitter->addWidget(trackListContainer);
     m_splitter->addWidget(m_view);
 }
 
 void TimelineWidget::setupConnections() {
     // Here, connect signals and slots for interaction, e.g., track mute toggles.
+    // Edge scrolling and centering run only while there is somewhere to go
     scrollTimer = new QTimer(this);
+    scrollTimer->setInterval(20);
     connect(scrollTimer, &QTimer::timeout, this, &TimelineWidget::performScroll);
-    scrollTimer->start(20);
+
+    m_centerTimer = new QTimer(this);
+    m_centerTimer->setInterval(15);
+    connect(m_centerTimer, &QTimer::timeout, this, &TimelineWidget::stepCentering);
 
     m_playTimer = new QTimer(this);
     connect(m_playTimer, &QTimer::timeout, this, &TimelineWidget::moveIndicator);
     m_playTimer->setInterval(16); // 60fps (16ms interval)
 
-    // Create and setup timeline indicator after scene is ready
-    if (m_scene) {
-        // Ensure only one indicator exists
-        if (m_indicator) {
-            m_scene->removeItem(m_indicator);
-            delete m_indicator;
-            m_indicator = nullptr;
-        }
-        
-        m_indicator = new TimelineIndicator(m_scene->height());
-        m_indicator->setZValue(100); // Ensure it's on top
-        m_scene->addItem(m_indicator);
-        m_indicator->setPos(0, m_timeIndicatorHeight);
-        
-        QObject::connect(m_indicator,&TimelineIndicator::indicatorMoved,this,&TimelineWidget::onIndicatorMoved);
-    }
+    // The playhead is drawn by the view, over the scene
+    m_view->setPlayheadPosition(0);
+    connect(m_view, &TimelineView::playheadDragged, this, &TimelineWidget::onPlayheadDragged);
     
     // Synchronize scrolling between track list and timeline
     synchronizeScrollBars();
@@ -295,19 +321,26 @@ void TimelineWidget::configureSplitter(){
 }
 
 void TimelineWidget::setupTrackList(){
-    m_trackList = new QListWidget();
-    m_trackList->setFixedWidth(m_trackIdWidth);
-    m_trackList->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff); // Sync with timeline scroll
-    m_trackList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    m_trackList->setSelectionMode(QAbstractItemView::SingleSelection);
-    m_trackList->setSpacing(0);
-    m_trackList->setStyleSheet("QListWidget { border: none; background: transparent; }");
+    // Headers are model rows painted by a delegate, not a widget per track
+    m_trackModel = new TrackListModel(this);
+    connect(m_trackModel, &TrackListModel::muteToggled, this, &TimelineWidget::onTrackMuteToggled);
+
+    TrackHeaderDelegate* delegate = new TrackHeaderDelegate(m_trackHeight, this);
+    connect(delegate, &TrackHeaderDelegate::settingsRequested, this, [this](const QModelIndex& index) {
+        openTrackSettingsDialog(m_trackModel->track(index.row()));
+    });
+
+    m_trackHeaders = new TrackHeaderView();
+    m_trackHeaders->setFixedWidth(m_trackIdWidth);
+    m_trackHeaders->setItemDelegate(delegate);
+    m_trackHeaders->setModel(m_trackModel);
 }
 
 void TimelineWidget::setupGraphicsView(){
     m_scene = new QGraphicsScene(this);
     m_scene->setSceneRect(0, 0, scene_width, scene_height); // Placeholder values for scene dimensions
-    m_view = new QGraphicsView(m_scene);
+    m_view = new TimelineView(m_scene);
+    m_view->setRulerHeight(m_timeIndicatorHeight); // Ruler and grid are painted by the view, not scene items
     m_view->setMinimumWidth(400);
     m_view->setAlignment(Qt::AlignLeft | Qt::AlignTop);
     m_view->setContentsMargins(0, 0, 0, 0);
@@ -315,65 +348,14 @@ void TimelineWidget::setupGraphicsView(){
     m_view->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
 }
 
-void TimelineWidget::addTimeIndicators(){
-    QFont font("Arial", 9, QFont::Medium);
-    QColor textColor(200, 200, 200); // Light gray for modern look
-    
-    for (int i = 0; i <= m_scene->width() / 100; ++i) {
-        // Convert seconds to MM:SS format
-        int totalSeconds = i;
-        int minutes = totalSeconds / 60;
-        int seconds = totalSeconds % 60;
-        QString timeText = QString("%1:%2").arg(minutes, 2, 10, QChar('0')).arg(seconds, 2, 10, QChar('0'));
-        
-        QGraphicsTextItem* timeIndicator = new QGraphicsTextItem(timeText);
-        timeIndicator->setFont(font);
-        timeIndicator->setDefaultTextColor(textColor);
-        timeIndicator->setPos(i * 100 + 5, 2); // Small offset for better positioning
-        m_scene->addItem(timeIndicator);
-    }
-}
-
-void TimelineWidget::addSecondLines(){
-    // Major time lines (every second)
-    QPen majorPen(QColor(100, 100, 100), 1); // Dark gray
-    for (int i = 0; i <= m_scene->width() / 100; ++i) {
-        QGraphicsLineItem* line = new QGraphicsLineItem(i * 100, m_timeIndicatorHeight, i * 100, m_scene->height());
-        line->setPen(majorPen);
-        line->setZValue(-1); // Behind other items
-        m_scene->addItem(line);
-    }
-    
-    // Minor time lines (every 0.5 seconds)
-    QPen minorPen(QColor(60, 60, 60), 1); // Darker gray, thinner
-    for (int i = 0; i <= m_scene->width() / 50; ++i) {
-        if (i % 2 != 0) { // Only draw on odd numbers (0.5, 1.5, 2.5, etc.)
-            QGraphicsLineItem* line = new QGraphicsLineItem(i * 50, m_timeIndicatorHeight, i * 50, m_scene->height());
-            line->setPen(minorPen);
-            line->setZValue(-2); // Behind major lines
-            m_scene->addItem(line);
-        }
-    }
-}
-
 void TimelineWidget::addTrack(Track* track) {
     // Set track index for proper identification
     int trackIndex = m_tracks.size();
     track->setIndex(trackIndex);
+    track->setPixelsPerSecond(m_timeScale.pixelsPerSecond());
     
-    // Create TrackHeaderWidget instead of simple QListWidgetItem
-    TrackHeaderWidget* headerWidget = new TrackHeaderWidget(track, this);
-    
-    // Connect signals from header widget
-    connect(headerWidget, &TrackHeaderWidget::muteToggled, this, &TimelineWidget::onTrackMuteToggled);
-    connect(headerWidget, &TrackHeaderWidget::settingsRequested, this, &TimelineWidget::openTrackSettingsDialog);
-    
-    // Create QListWidgetItem to hold the custom widget
-    QListWidgetItem* trackItem = new QListWidgetItem(m_trackList);
-    trackItem->setSizeHint(QSize(m_trackIdWidth, m_trackHeight));
-    
-    // Set the custom widget as the item widget
-    m_trackList->setItemWidget(trackItem, headerWidget);
+    // A row in the header column
+    m_trackModel->addTrack(track);
     
     // Position the track properly in the scene to align with track list
     track->setPos(0, trackIndex * m_trackHeight + m_timeIndicatorHeight); // Account for time indicators height
@@ -381,31 +363,46 @@ void TimelineWidget::addTrack(Track* track) {
     // Add the track to the scene
     m_scene->addItem(track);
     m_tracks.append(track);
+    connect(track, &Track::clipsChanged, this, [this, track]() {
+        updateExtent(track);
+        scheduleArrangementChanged();
+    });
 }
 
 void TimelineWidget::handleAudioItemPositionChange(const QPointF& newPosition) {
-    updateViewWidth();
-    m_scene->update();
+    Q_UNUSED(newPosition);
+    // The item repaints where it left and where it landed by itself
+    if (AudioItem* item = qobject_cast<AudioItem*>(sender())) {
+        updateExtent(item);
+    }
+    scheduleArrangementChanged();
+}
+
+void TimelineWidget::updateExtent(AudioItem* item) {
+    if (m_extent.set(reinterpret_cast<quintptr>(item), item->startTime() + item->duration())) {
+        updateViewWidth();
+    }
+}
+
+void TimelineWidget::updateExtent(Track* track) {
+    if (m_extent.set(reinterpret_cast<quintptr>(track), track->clips().end())) {
+        updateViewWidth();
+    }
 }
 
 
 void TimelineWidget::updateViewWidth() {
-    int maxWidth = 0;
+    // Latest end of any clip, in seconds
+    const double endSeconds = m_extent.end();
 
-    // Calculate the maximum width needed for all tracks
-    for (Track* track : m_tracks) {
-        int trackWidth = 0;
-        for (AudioItem* item : track->audioItems()) {
-            int itemEndPosition = item->startTime() + item->duration(); // Assuming both are in pixels
-            trackWidth = std::max(trackWidth, itemEndPosition);
-        }
-        maxWidth = std::max(maxWidth, trackWidth);
-    }
-    maxWidth += 200; // Adding some margin
+    // At the current zoom, with some margin, and never narrower than the
+    // configured scene width shows at the default zoom
+    const double minimumSeconds = scene_width / TimeScale::DEFAULT_PIXELS_PER_SECOND;
+    const int maxWidth = static_cast<int>(std::ceil(std::max(m_timeScale.x(endSeconds) + 200, m_timeScale.x(minimumSeconds))));
 
-    // Adjust the scene's rectangle to accommodate the new width
+    // Adjust the scene's rectangle to the new width; zooming out can shrink it
     QRectF currentSceneRect = m_scene->sceneRect();
-    if (maxWidth > currentSceneRect.width()) {
+    if (maxWidth != currentSceneRect.width()) {
         m_scene->setSceneRect(0, 0, maxWidth, currentSceneRect.height());
 
         for(Track* track: m_tracks){
@@ -415,10 +412,25 @@ void TimelineWidget::updateViewWidth() {
 
     scrollLeft = false;
     scrollRight = false;
+    if (scrollTimer) {
+        scrollTimer->stop();
+    }
 }
 
 void TimelineWidget::decelerateAndCenterItem(QGraphicsItem* item) {
-    if (!item) return; // Ensure the item is valid
+    m_centeredItem = item;
+    if (!m_centerTimer->isActive()) {
+        m_centerTimer->start();
+    }
+    stepCentering();
+}
+
+void TimelineWidget::stepCentering() {
+    QGraphicsItem* item = m_centeredItem;
+    if (!item) { // Ensure the item is valid
+        m_centerTimer->stop();
+        return;
+    }
 
     // Target position to center the item
     qreal centerX = item->sceneBoundingRect().center().x();
@@ -434,7 +446,9 @@ void TimelineWidget::decelerateAndCenterItem(QGraphicsItem* item) {
     // If the delta is small enough, just jump to the target and stop the timer
     if (abs(delta) <= 5) {
         m_view->horizontalScrollBar()->setValue(targetScrollBarPos);
-        return; // Stop the deceleration process here
+        m_centeredItem = nullptr;
+        m_centerTimer->stop(); // Stop the deceleration process here
+        return;
     }
 
     // Calculate the next step size for a smooth deceleration
@@ -443,29 +457,43 @@ void TimelineWidget::decelerateAndCenterItem(QGraphicsItem* item) {
         stepSize = (delta > 0) ? 1 : -1; // Ensure we always move at least a little bit
     }
 
-    // Update the scroll bar position to move towards the center
+    // Update the scroll bar position to move towards the center; an item
+    // near either end of the scene can't be centered, so stop where the bar does
     m_view->horizontalScrollBar()->setValue(currentScrollBarPos + stepSize);
-
-    // Continue the deceleration process after a short delay
-    QTimer::singleShot(15, this, [this, item]() { decelerateAndCenterItem(item); });
+    if (m_view->horizontalScrollBar()->value() == currentScrollBarPos) {
+        m_centeredItem = nullptr;
+        m_centerTimer->stop();
+    }
 }
 
 
 void TimelineWidget::focusOnItem(QGraphicsItem *item)
 {
     if (item && m_view) {
-        qreal itemMiddleX = item->pos().x() + (item->boundingRect().width() / 2);
+        keepVisible(item->pos().x() + (item->boundingRect().width() / 2));
+    }
+}
+
+void TimelineWidget::keepVisible(qreal sceneX)
+{
+    // Convert the point to viewport coordinates.
+    QPoint pointInViewport = m_view->mapFromScene(QPointF(sceneX, 0));
 
-        // Step 2: Convert the middle point to viewport coordinates.
-        QPoint itemMiddlePointInViewport = m_view->mapFromScene(QPointF(itemMiddleX, item->pos().y()));
+    // Determine margins as a fixed value or a percentage of the viewport's width
+    int leftMargin = 0; // e.g., 50 pixels from the left edge of the viewport
+    int rightMargin = m_view->viewport()->width() ; // e.g., 50 pixels from the right edge of the viewport
 
-        // Determine margins as a fixed value or a percentage of the viewport's width
-        int leftMargin = 0; // e.g., 50 pixels from the left edge of the viewport
-        int rightMargin = m_view->viewport()->width() ; // e.g., 50 pixels from the right edge of the viewport
+    // Check if the point is within the margins
+    scrollLeft = pointInViewport.x() <= leftMargin;
+    scrollRight = pointInViewport.x() >= rightMargin;
 
-        // Step 3: Check if the middle point is within the margins
-        scrollLeft = itemMiddlePointInViewport.x() <= leftMargin;
-        scrollRight = itemMiddlePointInViewport.x() >= rightMargin;
+    // The timer runs only while the point is past an edge
+    if (scrollLeft || scrollRight) {
+        if (!scrollTimer->isActive()) {
+            scrollTimer->start();
+        }
+    } else {
+        scrollTimer->stop();
     }
 }
 
@@ -481,9 +509,12 @@ void TimelineWidget::wheelEvent(QWheelEvent *event) {
     m_view->setTransformationAnchor(QGraphicsView::AnchorUnderMouse); // Set transformation anchor to mouse position
 
     if (event->modifiers() & Qt::ControlModifier) {
-        // Zoom on X-axis when Control key is pressed
-        qreal scaleFactor = m_view->transform().m11() * zoomFactor;
-        m_view->scale(zoomFactor, 1.0);
+        // Zoom on X-axis when Control key is pressed: the time scale changes
+        // and the clips are laid out again, the view is not scaled
+        setPixelsPerSecond(m_timeScale.pixelsPerSecond() * zoomFactor,
+                           m_view->viewport()->mapFrom(this, mousePos.toPoint()).x());
+        event->accept();
+        return;
     } else if (event->modifiers() & Qt::ShiftModifier) {
         // Zoom on Y-axis when Shift key is pressed
         qreal scaleFactor = m_view->transform().m22() * zoomFactor;
@@ -499,64 +530,8 @@ void TimelineWidget::wheelEvent(QWheelEvent *event) {
 }
 
 void TimelineWidget::synchronizeScrollBars() {
-    // Connect timeline vertical scrollbar to track list scrolling
-    connect(m_view->verticalScrollBar(), &QScrollBar::valueChanged, 
-            this, &TimelineWidget::onTimelineScrolled);
-}
-
-void TimelineWidget::onTimelineScrolled(int value) {
-    // Synchronize track list scrolling with timeline scrolling
-    if (m_trackList->count() > 0) {
-        // Calculate which track should be visible at the top based on timeline scroll
-        // Account for the time indicator height offset
-        int adjustedValue = qMax(0, value - m_timeIndicatorHeight);
-        int topTrackIndex = adjustedValue / m_trackHeight;
-        
-        // Ensure we don't scroll beyond available tracks
-        topTrackIndex = qMin(topTrackIndex, m_trackList->count() - 1);
-        
-        if (topTrackIndex >= 0 && topTrackIndex < m_trackList->count()) {
-            // Calculate the exact scroll position to align track list with timeline
-            QListWidgetItem* topItem = m_trackList->item(topTrackIndex);
-            if (topItem) {
-                // Calculate the pixel offset within the track
-                int pixelOffsetInTrack = adjustedValue % m_trackHeight;
-                
-                // Scroll to the appropriate track and position
-                m_trackList->scrollToItem(topItem, QAbstractItemView::PositionAtTop);
-                
-                // Fine-tune the scroll position to match the exact pixel offset
-                QScrollBar* trackScrollBar = m_trackList->verticalScrollBar();
-                int currentPos = trackScrollBar->value();
-                trackScrollBar->setValue(currentPos + pixelOffsetInTrack);
-            }
-        }
-    }
-    
-    // Ensure timeline indicator remains visible and properly rendered after scrolling
-    if (m_indicator) {
-        m_indicator->update();
-        m_scene->update(m_indicator->boundingRect().translated(m_indicator->scenePos()));
-    }
-}
-
-void TimelineWidget::onTrackListScrolled(int value) {
-    // Calculate the corresponding position in the timeline
-    // The timeline should scroll proportionally with the track list
-    if (m_view->verticalScrollBar()->maximum() > 0) {
-        // Calculate the scroll ratio based on track list scroll position
-        int maxTrackListScroll = m_trackList->verticalScrollBar()->maximum();
-        int maxTimelineScroll = m_view->verticalScrollBar()->maximum();
-        
-        // Calculate proportional scroll position for timeline
-        double scrollRatio = static_cast<double>(value) / maxTrackListScroll;
-        int timelineScrollPos = static_cast<int>(scrollRatio * maxTimelineScroll);
-        
-        // Scroll the timeline to match track list position
-        m_view->verticalScrollBar()->blockSignals(true);
-        m_view->verticalScrollBar()->setValue(timelineScrollPos);
-        m_view->verticalScrollBar()->blockSignals(false);
-    }
+    // The header column follows the timeline's vertical scroll bar
+    m_trackHeaders->setScrollSource(m_view->verticalScrollBar());
 }
 
 void TimelineWidget::ensureItemVisibility(AudioItem *item) {
@@ -589,12 +564,17 @@ void TimelineWidget::performScroll(){
         if (stepSize < maxStepSize) {
             stepSize += acceleration;
         }
-        int newValue = m_view->horizontalScrollBar()->value() + (scrollRight ? stepSize : -stepSize);
+        const int currentValue = m_view->horizontalScrollBar()->value();
+        int newValue = currentValue + (scrollRight ? stepSize : -stepSize);
         m_view->horizontalScrollBar()->setValue(newValue);
-    } else {
-        // Reset step size when scrolling stops
-        stepSize = 1;
+        if (m_view->horizontalScrollBar()->value() != currentValue) {
+            return;
+        }
+        // At the end of the scene; the next keepVisible starts it again
     }
+    // Reset step size when scrolling stops
+    stepSize = 1;
+    scrollTimer->stop();
 }
 
 void TimelineWidget::keyPressEvent(QKeyEvent *event){
@@ -617,19 +597,12 @@ void TimelineWidget::keyPressEvent(QKeyEvent *event){
 }
 
 void TimelineWidget::moveIndicator(){
-    if (m_indicator) {
-        // Use setPos instead of moveBy to avoid accumulation issues
-        QPointF currentPos = m_indicator->scenePos();
-        double newX = currentPos.x() + 1.33; // Adjusted for 60fps (2.0 * 20ms / 16ms)
-        
-        // Block signals to prevent feedback loops
-        m_indicator->blockSignals(true);
-        m_indicator->setPos(newX, m_timeIndicatorHeight);
-        m_indicator->blockSignals(false);
+    if (m_view) {
+        // Adjusted for 60fps (2.0 * 20ms / 16ms at 100 px/s)
+        double newX = m_timeScale.x(m_timeScale.seconds(m_view->playheadPosition()) + 0.0133);
         
-        // Optimize scene updates - only update the indicator's region
-        QRectF updateRect = m_indicator->boundingRect().translated(m_indicator->scenePos());
-        m_scene->update(updateRect);
+        // Repaints only the playhead's old and new strips, never the clips under it
+        m_view->setPlayheadPosition(newX);
         
         // Center view much less frequently to reduce artifacts and improve performance
         static int updateCounter = 0;
@@ -645,14 +618,14 @@ void TimelineWidget::moveIndicator(){
         static QTime lastEmit;
         QTime currentTime = QTime::currentTime();
         if (!lastEmit.isValid() || lastEmit.msecsTo(currentTime) > 33) { // Throttle to 30fps (33ms) for UI updates
-            double seconds = newX / 100.0;
+            double seconds = m_timeScale.seconds(newX);
             
             // Only emit if not in playback mode to prevent feedback loops
             if (!m_isPlaybackMode) {
-                qDebug() << "TimelineWidget: Manual indicator position change to" << seconds << "seconds";
+                LOG_TRACE(lcTimeline) << "TimelineWidget: Manual indicator position change to" << seconds << "seconds";
                 emit indicatorPositionChanged(seconds);
             } else {
-                qDebug() << "TimelineWidget: Suppressing position emission during playback";
+                LOG_TRACE(lcTimeline) << "TimelineWidget: Suppressing position emission during playback";
             }
             lastEmit = currentTime;
         }
@@ -660,18 +633,20 @@ void TimelineWidget::moveIndicator(){
 }
 
 void TimelineWidget::setIndicatorPosition(double seconds) {
-    if (m_indicator) {
-        // Convert seconds to pixels (assuming 100px = 1 second)
-        double xPos = seconds * 100.0;
-        
-        // Block signals to prevent infinite loops
-        m_indicator->blockSignals(true);
-        m_indicator->setPos(xPos, m_timeIndicatorHeight);
-        m_indicator->blockSignals(false);
+    // While the engine plays, the animator places the playhead from the audio clock
+    if (m_playheadAnimator && m_playheadAnimator->isRunning()) {
+        return;
+    }
+    placePlayhead(seconds);
+}
+
+void TimelineWidget::placePlayhead(double seconds) {
+    if (m_view) {
+        // Convert seconds to pixels at the current zoom
+        double xPos = m_timeScale.x(seconds);
         
-        // Optimize scene updates - only update the indicator's region
-        QRectF updateRect = m_indicator->boundingRect().translated(m_indicator->scenePos());
-        m_scene->update(updateRect);
+        // Setting it programmatically emits nothing, so there is no feedback loop
+        m_view->setPlayheadPosition(xPos);
         
         // Use the same throttled centering logic as direct indicator movement
         static QTime lastCenterTime;
@@ -692,9 +667,9 @@ void TimelineWidget::setIndicatorPosition(double seconds) {
 }
 
 double TimelineWidget::getIndicatorPosition() const {
-    if (m_indicator) {
-        // Convert pixels to seconds (assuming 100px = 1 second)
-        return m_indicator->scenePos().x() / 100.0;
+    if (m_view) {
+        // Convert pixels to seconds at the current zoom
+        return m_timeScale.seconds(m_view->playheadPosition());
     }
     return 0.0;
 }
@@ -713,47 +688,47 @@ void TimelineWidget::stopTimelineMovement() {
     }
 }
 
-void TimelineWidget::onIndicatorMoved(TimelineIndicator* indicator) {
-    Q_UNUSED(indicator)
-    
+void TimelineWidget::onPlayheadDragged(qreal sceneX) {
     // Always emit the current position to ensure transport dock stays in sync
-    double seconds = m_indicator->scenePos().x() / 100.0; // Convert pixels to seconds
+    double seconds = m_timeScale.seconds(sceneX); // Convert pixels to seconds
     emit indicatorPositionChanged(seconds);
     
-    // Throttle expensive operations like focusing and scene updates
+    // Throttle edge scrolling checks
     static QTime lastUpdateTime;
     QTime currentTime = QTime::currentTime();
     
     if (!lastUpdateTime.isValid() || lastUpdateTime.msecsTo(currentTime) > 33) { // Throttle to 30fps for UI responsiveness
-        // Focus on the indicator with reduced frequency
-        focusOnItem(m_indicator);
+        keepVisible(sceneX);
         lastUpdateTime = currentTime;
-        
-        // Optimize scene updates - only update the indicator's region
-        QRectF updateRect = m_indicator->boundingRect().translated(m_indicator->scenePos());
-        m_scene->update(updateRect);
     }
 }
 
 void TimelineWidget::removeAudioItem(AudioItem* item) {
     if (!item) {
-        qDebug() << "ERROR: Cannot remove null audio item";
+        LOG_WARNING(lcTimeline) << "TimelineWidget: Cannot remove null audio item";
         return;
     }
     
-    qDebug() << "=== SAFE AUDIO ITEM REMOVAL ===" ;
+    // Where it was drawn, and how wide the scene was, for the repaint below
+    const QRectF itemRect = item->sceneBoundingRect();
+    const QRectF oldSceneRect = m_scene ? m_scene->sceneRect() : QRectF();
     
     // Step 1: Immediately hide the item to prevent further interaction
     item->setVisible(false);
     item->setEnabled(false);
     
-    // Step 2: Disconnect ALL signals and slots to prevent callbacks
+    // Step 2: Disconnect ALL signals and slots to prevent callbacks, and
+    // stop building its waveform
     QObject::disconnect(item, nullptr, nullptr, nullptr);
+    m_waveformLoader->cancel(item);
     
     // Step 3: Clear any references to this item
     if (currentItem == item) {
         currentItem = nullptr;
     }
+    if (m_centeredItem == item) {
+        m_centeredItem = nullptr;
+    }
     
     // Step 4: Remove from tracks (simple approach)
     for (Track* track : m_tracks) {
@@ -766,66 +741,130 @@ void TimelineWidget::removeAudioItem(AudioItem* item) {
     }
     
     // Step 6: Force immediate deletion instead of deleteLater
+    if (m_extent.remove(reinterpret_cast<quintptr>(item))) {
+        updateViewWidth();
+    }
     delete item;
     
-    // Step 7: Force scene update
+    // Step 7: Repaint where the clip was, and the tail the scene lost if it
+    // was the last clip
     if (m_scene) {
-        m_scene->update();
+        m_scene->update(itemRect);
+        const qreal newWidth = m_scene->sceneRect().width();
+        if (newWidth < oldSceneRect.width()) {
+            m_scene->update(QRectF(newWidth, oldSceneRect.top(), oldSceneRect.width() - newWidth, oldSceneRect.height()));
+        }
     }
     
-    qDebug() << "=== AUDIO ITEM REMOVAL COMPLETE ===";
+    LOG_DEBUG(lcTimeline) << "TimelineWidget: Removed audio item";
+    
+    scheduleArrangementChanged();
 }
 
-void TimelineWidget::setPlaybackMode(bool isPlaying) {
-    m_isPlaybackMode = isPlaying;
-    qDebug() << "TimelineWidget: Playback mode set to" << isPlaying;
+void TimelineWidget::onWaveformLoaded(AudioItem* item, double durationSeconds) {
+    // The clip was sized from the container's estimate; use the decoded length
+    if (durationSeconds > 0.0 && !qFuzzyCompare(item->duration(), durationSeconds)) {
+        LOG_DEBUG(lcTimeline) << "TimelineWidget: Correcting duration of" << item->filePath() << "from" << item->duration()
+                              << "to" << durationSeconds << "seconds";
+        item->setDuration(durationSeconds);
+        updateExtent(item);
+        scheduleArrangementChanged();
+    }
 }
 
-qreal TimelineWidget::getAudioFileDuration(const QString& filePath) {
-    qDebug() << "=== DETECTING AUDIO FILE DURATION ===";
-    qDebug() << "File path:" << filePath;
-    
-#if HAVE_FFMPEG
-    qDebug() << "Using FFmpeg for duration detection";
+void TimelineWidget::onSourcePeaksChanged(const QString& filePath, const PeakPyramid& peaks) {
+    for (Track* track : m_tracks) {
+        track->setSourcePeaks(filePath, peaks);
+    }
+}
+
+void TimelineWidget::onSourceLoaded(const QString& filePath, double durationSeconds) {
+    // Batched clips were sized from the container's estimate too
+    bool changed = false;
+    for (Track* track : m_tracks) {
+        track->setSourceLoading(filePath, false);
+        if (durationSeconds > 0.0 && track->setSourceLength(filePath, durationSeconds)) {
+            updateExtent(track);
+            changed = true;
+        }
+    }
+    if (changed) {
+        LOG_DEBUG(lcTimeline) << "TimelineWidget: Corrected duration of batched clips of" << filePath << "to" << durationSeconds
+                              << "seconds";
+        scheduleArrangementChanged();
+    }
+}
+
+void TimelineWidget::setPlaybackMode(bool isPlaying) {
+    m_isPlaybackMode = isPlaying;
+    LOG_DEBUG(lcTimeline) << "TimelineWidget: Playback mode set to" << isPlaying;
     
-    AVFormatContext *formatContext = avformat_alloc_context();
-    if (!formatContext) {
-        qDebug() << "ERROR: Could not allocate format context";
-        return -1.0;
+    // Follow the audio clock rather than the free-running timer or queued position updates
+    if (isPlaying && m_transportClock) {
+        stopTimelineMovement();
+        m_playheadAnimator->start(m_transportClock);
+    } else {
+        m_playheadAnimator->stop();
     }
+}
 
-    if (avformat_open_input(&formatContext, filePath.toStdString().c_str(), nullptr, nullptr) != 0) {
-        qDebug() << "ERROR: Could not open file for duration detection";
-        avformat_free_context(formatContext);
-        return -1.0;
+void TimelineWidget::setPixelsPerSecond(double pixelsPerSecond, int anchorX) {
+    const double anchorSeconds = m_timeScale.seconds(m_view->mapToScene(anchorX, 0).x());
+    if (!m_timeScale.setPixelsPerSecond(pixelsPerSecond)) {
+        return; // At a limit
     }
+    const double scale = m_timeScale.pixelsPerSecond();
 
-    if (avformat_find_stream_info(formatContext, nullptr) < 0) {
-        qDebug() << "ERROR: Could not find stream information";
-        avformat_close_input(&formatContext);
-        return -1.0;
+    QElapsedTimer timer;
+    timer.start();
+
+    // Items move to their new x; batched tracks just draw at the new scale
+    for (Track* track : m_tracks) {
+        track->setPixelsPerSecond(scale);
+        const QList<AudioItem*>& items = track->audioItems();
+        for (AudioItem* item : items) {
+            item->setPixelsPerSecond(scale);
+        }
     }
+    updateViewWidth();
+    m_view->setPixelsPerSecond(scale);
+    m_view->horizontalScrollBar()->setValue(qRound(m_timeScale.x(anchorSeconds)) - anchorX);
 
-    // Get duration in seconds
-    double duration = 0.0;
-    if (formatContext->duration != AV_NOPTS_VALUE) {
-        duration = static_cast<double>(formatContext->duration) / AV_TIME_BASE;
-        qDebug() << "FFmpeg detected duration:" << duration << "seconds";
-    } else {
-        qDebug() << "WARNING: Could not determine duration from FFmpeg";
-        duration = -1.0;
+    LOG_DEBUG(lcTimeline) << "TimelineWidget: Zoomed to" << scale << "px/s, laid out in"
+                          << timer.nsecsElapsed() / 1.0e6 << "ms";
+}
+
+void TimelineWidget::setTransportClock(const TransportClock* clock) {
+    m_transportClock = clock;
+}
+
+qreal TimelineWidget::getAudioFileDuration(const QString& filePath) {
+#if HAVE_FFMPEG
+    // Exact once decoded; otherwise the container's estimate, which
+    // onWaveformLoaded() corrects when the background decode finishes
+    if (QSharedPointer<const DecodedMedia> media = MediaCache::instance().find(filePath)) {
+        LOG_TRACE(lcTimeline) << "TimelineWidget: Decoded duration:" << media->durationSeconds() << "seconds";
+        return media->durationSeconds();
+    }
+
+    int sourceRate = 0;
+    qint64 estimatedFrames = 0;
+    AudioResult result = MediaCache::instance().probe(filePath, &sourceRate, &estimatedFrames);
+    if (!result.isSuccess() || sourceRate <= 0 || estimatedFrames <= 0) {
+        LOG_WARNING(lcTimeline) << "TimelineWidget: Could not determine the duration of" << filePath << "-"
+                                << result.getErrorMessage();
+        return -1.0;
     }
 
-    avformat_close_input(&formatContext);
-    return duration;
+    LOG_TRACE(lcTimeline) << "TimelineWidget: Estimated duration:" << static_cast<double>(estimatedFrames) / sourceRate
+                          << "seconds";
+    return static_cast<double>(estimatedFrames) / sourceRate;
     
 #else
-    qDebug() << "FFmpeg not available, using Qt Multimedia for duration detection";
-    
     // Use Qt's QMediaPlayer for duration detection
     QFileInfo fileInfo(filePath);
     if (!fileInfo.exists()) {
-        qDebug() << "ERROR: Audio file does not exist:" << filePath;
+        LOG_WARNING(lcTimeline) << "TimelineWidget: Audio file does not exist:" << filePath;
         return -1.0;
     }
     
@@ -836,13 +875,10 @@ qreal TimelineWidget::getAudioFileDuration(const QString& filePath) {
     // Duration (seconds) = (file size in bytes * 8) / (bitrate in bits per second)
     double estimatedDuration = (static_cast<double>(fileSize) * 8.0) / (128.0 * 1000.0);
     
-    qDebug() << "File size:" << fileSize << "bytes";
-    qDebug() << "Estimated duration (128kbps assumption):" << estimatedDuration << "seconds";
-    
     // Clamp to reasonable values (between 1 second and 10 minutes)
     estimatedDuration = qBound(1.0, estimatedDuration, 600.0);
     
-    qDebug() << "Final estimated duration:" << estimatedDuration << "seconds";
+    LOG_TRACE(lcTimeline) << "TimelineWidget: Estimated duration (128kbps assumption):" << estimatedDuration << "seconds";
     return estimatedDuration;
 #endif
 }
@@ -7,15 +7,21 @@
 #include <QGraphicsView>
 #include <QGraphicsScene>
 #include <QVBoxLayout>
-#include <QListWidget>
 #include "audioitem.h"
+#include "clipextent.h"
 #include "track.h"
 #include <QTimer>
 #include <QSplitter>
-#include "TimelineIndicator.h"
-#include "trackheaderwidget.h"
+#include "playheadanimator.h"
+#include "timelineview.h"
+#include "timescale.h"
+#include "trackheaderdelegate.h"
+#include "trackheaderview.h"
+#include "tracklistmodel.h"
 #include "tracksettingsdialog.h"
+#include "waveformloader.h"
 #include "../src/appconfig.h"
+#include "../src/audiomixer.h"
 
 class TimelineWidget : public QWidget {
     Q_OBJECT
@@ -24,10 +30,13 @@ public:
     TimelineWidget(QWidget* parent = nullptr);
     void addTrack(Track* track);
     void createTracksAndItems();
-    void addAudioItemToTrack(const QString& filePath, int trackIndex = 0, const QColor& itemColor = QColor(255, 107, 107));
+    // startSeconds: where on the timeline the clip begins
+    void addAudioItemToTrack(const QString& filePath, int trackIndex = 0, const QColor& itemColor = QColor(255, 107, 107),
+                             double startSeconds = 0.0);
     int getTrackCount() const;
+    const QList<Track*>& tracks() const { return m_tracks; }
     void performScroll();
-    QTimer* scrollTimer;
+    QTimer* scrollTimer = nullptr; // Edge scrolling, only while keepVisible finds a point past an edge
     bool scrollLeft;
     bool scrollRight;
     
@@ -37,24 +46,38 @@ public:
     
     // Playback state management
     void setPlaybackMode(bool isPlaying);
+    // Clock the playhead follows while playing (the engine's)
+    void setTransportClock(const TransportClock* clock);
     
     // Direct timeline movement control (like spacebar)
     void startTimelineMovement();
     void stopTimelineMovement();
     
-    // Audio file duration detection
+    // Audio file duration detection: exact once the file is decoded, the
+    // container's estimate before that
     qreal getAudioFileDuration(const QString& filePath);
     
+    // Horizontal zoom. Lays every clip out again at the new scale, keeping
+    // the time at anchorX (viewport pixels) where it is on screen.
+    void setPixelsPerSecond(double pixelsPerSecond, int anchorX = 0);
+    const TimeScale& timeScale() const { return m_timeScale; }
+    
+    // Every clip and track mix setting, as the mixer takes them
+    MixerArrangement mixerArrangement() const;
+    // arrangementChanged is emitted once control returns to the event loop,
+    // however many edits came before; this emits a pending one right away
+    void flushArrangementChanged();
+    
 public slots:
-    void onTrackMuteToggled(bool muted);
+    void onTrackMuteToggled(Track* track, bool muted);
     void openTrackSettingsDialog(Track* track);
 private:
     QGraphicsItem *currentItem;
     QGraphicsScene* m_scene = nullptr;
-    QGraphicsView* m_view = nullptr;
-    QListWidget* m_trackList = nullptr; // For displaying track names and mute toggle
+    TimelineView* m_view = nullptr;
+    TrackListModel* m_trackModel = nullptr;
+    TrackHeaderView* m_trackHeaders = nullptr; // Track names and mute toggles
     QVBoxLayout* m_layout = nullptr;
-    TimelineIndicator *m_indicator = nullptr;
     QTimer *m_playTimer = nullptr;
     bool m_isMoving;
     int m_trackHeight;
@@ -64,6 +87,12 @@ private:
     int scene_width;
     int scene_height;
     QList<Track*> m_tracks;
+    WaveformLoader* m_waveformLoader = nullptr;
+    PlayheadAnimator* m_playheadAnimator = nullptr;
+    const TransportClock* m_transportClock = nullptr;
+    bool m_batchedClips = false; // New clips go into their track's ClipArray
+    TimeScale m_timeScale;
+    ClipExtent m_extent; // End of every clip, and of each track's batched clips
     qreal m_zoomFactorX = 1.0;
     qreal m_zoomFactorY = 1.0;
     qreal m_zoomDelta = 0.1;
@@ -71,16 +100,25 @@ private:
     void setupUi();
     void setupConnections();
     void updateViewWidth();
+    // Records where the clip now ends; the scene resizes only if the arrangement's end moved
+    void updateExtent(AudioItem* item);
+    void updateExtent(Track* track);
+    void scheduleArrangementChanged(); // Coalesced into one arrangementChanged
+    QTimer* m_arrangementTimer = nullptr;
+    // Scrolls item to the middle of the view in decelerating steps
     void decelerateAndCenterItem(QGraphicsItem* item);
+    void stepCentering();
+    QTimer* m_centerTimer = nullptr; // Runs only until the item is centered
+    QGraphicsItem* m_centeredItem = nullptr;
     void ensureItemVisibility(AudioItem *item);
     void synchronizeScrollBars();
+    void placePlayhead(double seconds); // Moves it and keeps it in view
+    void keepVisible(qreal sceneX); // Starts edge scrolling when sceneX leaves the viewport
 
     void initializelayout();
     void configureSplitter();
     void setupTrackList();
     void setupGraphicsView();
-    void addTimeIndicators();
-    void addSecondLines();
     QSplitter* m_splitter;
     
     // Playback state flag to prevent position feedback loops
@@ -95,13 +133,15 @@ public slots:
     void focusOnItem(QGraphicsItem* item);
     void setCurrentItem(AudioItem* item);
     void moveIndicator();
-    void onTrackListScrolled(int value);
-    void onTimelineScrolled(int value);
-    void onIndicatorMoved(TimelineIndicator* indicator);
+    void onPlayheadDragged(qreal sceneX);
     void removeAudioItem(AudioItem* item);
+    void onWaveformLoaded(AudioItem* item, double durationSeconds);
+    void onSourcePeaksChanged(const QString& filePath, const PeakPyramid& peaks);
+    void onSourceLoaded(const QString& filePath, double durationSeconds);
 
 signals:
     void indicatorPositionChanged(double seconds);
+    void arrangementChanged(); // Clips, track mix settings or clip positions changed; once per batch of edits
 };
 
 #endif // TIMELINEWIDGET_H
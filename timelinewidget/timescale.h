@@ -0,0 +1,45 @@
+#ifndef TIMESCALE_H
+#define TIMESCALE_H
+
+#include <QtGlobal>
+
+// Maps timeline time to scene x.
+//
+// Clip positions are kept in seconds and laid out at the current number of
+// pixels per second. Horizontal zoom changes that number and lays the items
+// out again instead of scaling the view, so clips, waveforms and the ruler
+// are always drawn at their real size: zoomed out, a long session is a
+// narrow scene of narrow clips, and each waveform reads the peak level that
+// matches its width.
+class TimeScale
+{
+public:
+    static constexpr double DEFAULT_PIXELS_PER_SECOND = 100.0;
+    static constexpr double MIN_PIXELS_PER_SECOND = 0.05;   // Three hours in 540 px
+    static constexpr double MAX_PIXELS_PER_SECOND = 2000.0; // Half a millisecond per pixel
+
+    explicit TimeScale(double pixelsPerSecond = DEFAULT_PIXELS_PER_SECOND)
+        : m_pixelsPerSecond(qBound(MIN_PIXELS_PER_SECOND, pixelsPerSecond, MAX_PIXELS_PER_SECOND))
+    {
+    }
+
+    double pixelsPerSecond() const { return m_pixelsPerSecond; }
+    // Clamped to the limits; false if that leaves it unchanged
+    bool setPixelsPerSecond(double pixelsPerSecond)
+    {
+        const double clamped = qBound(MIN_PIXELS_PER_SECOND, pixelsPerSecond, MAX_PIXELS_PER_SECOND);
+        if (clamped == m_pixelsPerSecond) {
+            return false;
+        }
+        m_pixelsPerSecond = clamped;
+        return true;
+    }
+
+    double x(double seconds) const { return seconds * m_pixelsPerSecond; }
+    double seconds(double x) const { return x / m_pixelsPerSecond; }
+
+private:
+    double m_pixelsPerSecond;
+};
+
+#endif // TIMESCALE_H
@@ -1,5 +1,9 @@
 #include "track.h"
+#include "../src/applog.h"
+#include <QGraphicsSceneMouseEvent>
+#include <QMenu>
 #include <QPainter>
+#include <QStyleOptionGraphicsItem>
 
 Track::Track(int trackHeight, qreal trackWidth) :
     QGraphicsItem(),
@@ -11,7 +15,8 @@ Track::Track(int trackHeight, qreal trackWidth) :
     m_pan(0.0f),
     m_solo(false)
 {
-
+    // Batched clips are drawn only where exposed
+    setFlag(ItemUsesExtendedStyleOption);
 }
 
 void Track::setIndex(int index)
@@ -50,8 +55,100 @@ bool Track::removeAudioItem(AudioItem* item) {
     return false;
 }
 
-QList<AudioItem*> Track::audioItems() const {
-    return m_audioItems;
+int Track::addClip(const QString& filePath, double start, double length, const QColor& color, bool* newSource) {
+    // Odd, so never the address of an AudioItem, which the mixer also uses as an id
+    static quint64 nextClipId = 0;
+
+    int source = findSource(filePath);
+    if (newSource) {
+        *newSource = source < 0;
+    }
+    if (source < 0) {
+        source = m_sources.size();
+        m_sources.append(ClipSource());
+        m_sources.last().filePath = filePath;
+        invalidateSource(m_sources.last());
+    }
+
+    ClipRecord clip;
+    clip.start = qMax(0.0, start);
+    clip.length = length;
+    clip.id = (++nextClipId << 1) | 1;
+    clip.source = static_cast<quint32>(source);
+    clip.color = color.rgba();
+    const int index = m_clips.add(clip);
+    if (m_selectedClip >= index) {
+        ++m_selectedClip;
+    }
+    update(clipRect(clip));
+    return index;
+}
+
+void Track::removeClip(int index) {
+    update(clipRect(m_clips.at(index)));
+    m_clips.remove(index);
+    if (m_selectedClip == index) {
+        m_selectedClip = -1;
+    } else if (m_selectedClip > index) {
+        --m_selectedClip;
+    }
+}
+
+void Track::setSourcePeaks(const QString& filePath, const PeakPyramid& peaks) {
+    const int index = findSource(filePath);
+    if (index < 0) {
+        return;
+    }
+    ClipSource& source = m_sources[index];
+    source.peaks = peaks;
+    source.peakScale = AudioItem::peakScaleFor(peaks);
+    invalidateSource(source);
+}
+
+void Track::setSourceLoading(const QString& filePath, bool loading) {
+    const int index = findSource(filePath);
+    if (index >= 0 && m_sources[index].loading != loading) {
+        m_sources[index].loading = loading;
+        invalidateSource(m_sources[index]);
+    }
+}
+
+bool Track::isSourceLoading(const QString& filePath) const {
+    const int index = findSource(filePath);
+    return index >= 0 && m_sources[index].loading;
+}
+
+bool Track::setSourceLength(const QString& filePath, double length) {
+    const int source = findSource(filePath);
+    bool changed = false;
+    for (int index = 0; source >= 0 && index < m_clips.size(); ++index) {
+        const ClipRecord& clip = m_clips.at(index);
+        if (clip.source == static_cast<quint32>(source) && !qFuzzyCompare(clip.length, length)) {
+            m_clips.setLength(index, length);
+            changed = true;
+        }
+    }
+    if (changed) {
+        update();
+    }
+    return changed;
+}
+
+int Track::findSource(const QString& filePath) const {
+    // A track plays a handful of files, however many clips it has
+    for (int index = 0; index < m_sources.size(); ++index) {
+        if (m_sources[index].filePath == filePath) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+void Track::invalidateSource(ClipSource& source) {
+    // Tiles are keyed by generation; stale ones age out of QPixmapCache
+    static quint64 nextGeneration = 0;
+    source.generation = ++nextGeneration;
+    update();
 }
 
 void Track::setMute(bool mute) {
@@ -68,7 +165,6 @@ QRectF Track::boundingRect() const {
 }
 
 void Track::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
-    Q_UNUSED(option);
     Q_UNUSED(widget);
 
     QPen pen(Qt::black, 1); // Set the color and width of the pen as desired
@@ -82,6 +178,93 @@ void Track::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWi
     // Draw the bottom line
     painter->drawLine(rect.bottomLeft(), rect.bottomRight());
 
+    if (m_clips.isEmpty()) {
+        return;
+    }
+
+    // Only the clips that reach into the exposed rect are looked at
+    const QRectF exposed = option->exposedRect;
+    const double from = exposed.left() / m_pixelsPerSecond;
+    int first = 0;
+    int end = 0;
+    m_clips.span(from, exposed.right() / m_pixelsPerSecond, &first, &end);
+
+    int drawn = 0;
+    for (int index = first; index < end; ++index) {
+        const ClipRecord& clip = m_clips.at(index);
+        if (clip.end() <= from) {
+            continue;
+        }
+        // Every instance of a file at the same length shares its tiles
+        const ClipSource& source = m_sources[clip.source];
+        const QRectF bounds = clipRect(clip);
+        const QString key = QStringLiteral("Track/%1/%2/%3/%4")
+                                .arg(source.generation)
+                                .arg(clip.color)
+                                .arg(qRound64(bounds.width() * 100.0))
+                                .arg(m_trackHeight);
+        AudioItem::paintTiles(painter, bounds, exposed.intersected(bounds), key, source.peaks, source.peakScale,
+                              QColor::fromRgba(clip.color), source.loading);
+        ++drawn;
+    }
+
+    if (m_selectedClip >= first && m_selectedClip < end) {
+        painter->setPen(QPen(Qt::white, 0));
+        painter->setBrush(Qt::NoBrush);
+        painter->drawRect(clipRect(m_clips.at(m_selectedClip)).adjusted(0.5, 0.5, -0.5, -0.5));
+    }
+
+    LOG_TRACE(lcTimeline) << "Track: Drew" << drawn << "of" << m_clips.size() << "clips";
+}
+
+void Track::mousePressEvent(QGraphicsSceneMouseEvent* event) {
+    const int index = m_clips.clipAt(event->pos().x() / m_pixelsPerSecond);
+    if (index < 0) {
+        event->ignore(); // Empty lane
+        return;
+    }
+
+    if (m_selectedClip >= 0) {
+        update(clipRect(m_clips.at(m_selectedClip)));
+    }
+    m_selectedClip = index;
+    update(clipRect(m_clips.at(index)));
+
+    m_dragStartedAt = m_clips.at(index).start;
+    m_dragOffset = event->pos().x() / m_pixelsPerSecond - m_dragStartedAt;
+    if (event->button() == Qt::RightButton) {
+        showClipMenu(index, event->screenPos());
+    }
+}
+
+void Track::mouseMoveEvent(QGraphicsSceneMouseEvent* event) {
+    if (m_selectedClip < 0 || !(event->buttons() & Qt::LeftButton)) {
+        return;
+    }
+
+    // Batched clips move along their track only
+    update(clipRect(m_clips.at(m_selectedClip)));
+    m_selectedClip = m_clips.move(m_selectedClip, qMax(0.0, event->pos().x() / m_pixelsPerSecond - m_dragOffset));
+    update(clipRect(m_clips.at(m_selectedClip)));
+}
+
+void Track::mouseReleaseEvent(QGraphicsSceneMouseEvent* event) {
+    Q_UNUSED(event);
+
+    if (m_selectedClip >= 0 && m_clips.at(m_selectedClip).start != m_dragStartedAt) {
+        emit clipsChanged();
+    }
+}
+
+void Track::showClipMenu(int index, const QPoint& screenPos) {
+    QMenu contextMenu;
+    QAction* removeAction = contextMenu.addAction("Remove Audio Track");
+    removeAction->setIcon(QIcon(":/icons/delete"));
+
+    if (contextMenu.exec(screenPos) == removeAction) {
+        removeClip(index);
+        emit clipsChanged();
+    }
 }
 
 void Track::handleAudioItemPositionChange(const QPointF& newPosition) {
@@ -89,6 +272,12 @@ void Track::handleAudioItemPositionChange(const QPointF& newPosition) {
     // For example, update the display if necessary
 }
 
+void Track::setPixelsPerSecond(qreal pixelsPerSecond) {
+    // Batched clips are laid out as they are drawn
+    m_pixelsPerSecond = pixelsPerSecond;
+    update();
+}
+
 void Track::updateTrackWidth(qreal trackWidth){
     prepareGeometryChange();
     m_trackWidth = trackWidth;
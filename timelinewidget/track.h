@@ -4,7 +4,18 @@
 #include <QList>
 #include <QGraphicsItem>
 #include "audioitem.h"
+#include "cliparray.h"
+#include "timescale.h"
+#include "../src/peakpyramid.h"
 #include <QObject>
+#include <QVector>
+
+// A track lane. Its clips are usually AudioItems of their own; batched
+// clips (AppConfig "timeline/batchedClips") are instead kept in the track's
+// ClipArray and drawn and hit-tested by the track itself, so thousands of
+// loop instances cost a small record each rather than a QObject, a scene
+// item and its connections. Instances of one file share cached waveform
+// tiles.
 
 class Track : public QObject ,public QGraphicsItem {
     Q_OBJECT
@@ -19,10 +30,23 @@ public:
     int getTrackHeight();
 
     void updateTrackWidth(qreal trackWidth);
+    void setPixelsPerSecond(qreal pixelsPerSecond);
 
     void addAudioItem(AudioItem* item);
     bool removeAudioItem(AudioItem* item);
-    QList<AudioItem*> audioItems() const;
+    const QList<AudioItem*>& audioItems() const { return m_audioItems; }
+
+    // Batched clips; start and length in seconds. Returns the clip's index;
+    // newSource tells whether the track had no clip of filePath yet.
+    int addClip(const QString& filePath, double start, double length, const QColor& color, bool* newSource = nullptr);
+    void removeClip(int index);
+    const ClipArray& clips() const { return m_clips; }
+    QString sourcePath(quint32 source) const { return m_sources[source].filePath; }
+    // Every clip of filePath
+    void setSourcePeaks(const QString& filePath, const PeakPyramid& peaks);
+    void setSourceLoading(const QString& filePath, bool loading);
+    bool isSourceLoading(const QString& filePath) const;
+    bool setSourceLength(const QString& filePath, double length); // True if any clip changed
 
     void setMute(bool mute);
     bool isMute() const;
@@ -45,7 +69,31 @@ public:
 public slots:
     void handleAudioItemPositionChange(const QPointF& newPosition);
 
+signals:
+    void clipsChanged(); // Batched clips moved or removed by the user
+
+protected:
+    void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
+    void mouseMoveEvent(QGraphicsSceneMouseEvent* event) override;
+    void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) override;
+
 private:
+    struct ClipSource {
+        QString filePath;
+        PeakPyramid peaks;
+        qreal peakScale = 1.0;
+        bool loading = false;
+        quint64 generation = 0; // Names the peaks in the tile cache
+    };
+
+    int findSource(const QString& filePath) const;
+    void invalidateSource(ClipSource& source);
+    QRectF clipRect(const ClipRecord& clip) const
+    {
+        return QRectF(clip.start * m_pixelsPerSecond, 0, clip.length * m_pixelsPerSecond, m_trackHeight);
+    }
+    void showClipMenu(int index, const QPoint& screenPos);
+
     QString m_name;
     QList<AudioItem*> m_audioItems;
     bool m_mute;
@@ -57,6 +105,13 @@ private:
     float m_volume;
     float m_pan;
     bool m_solo;
+
+    ClipArray m_clips;
+    QVector<ClipSource> m_sources;
+    qreal m_pixelsPerSecond = TimeScale::DEFAULT_PIXELS_PER_SECOND;
+    int m_selectedClip = -1;
+    double m_dragOffset = 0.0;    // Seconds from the selected clip's start to the press
+    double m_dragStartedAt = 0.0; // Its start when pressed
 };
 
 #endif // TRACK_H
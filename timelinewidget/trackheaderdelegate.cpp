@@ -0,0 +1,106 @@
+#include "trackheaderdelegate.h"
+#include "tracklistmodel.h"
+#include <QAbstractItemView>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+
+TrackHeaderDelegate::TrackHeaderDelegate(int rowHeight, QObject* parent)
+    : QStyledItemDelegate(parent)
+    , m_rowHeight(rowHeight)
+{
+}
+
+QRect TrackHeaderDelegate::muteRect(const QRect& row)
+{
+    return QRect(row.right() + 1 - MARGIN - BUTTON_SIZE, row.top() + (row.height() - BUTTON_SIZE) / 2, BUTTON_SIZE,
+                 BUTTON_SIZE);
+}
+
+QRect TrackHeaderDelegate::nameRect(const QRect& row)
+{
+    return row.adjusted(MARGIN, 4, -(2 * MARGIN + BUTTON_SIZE), -4);
+}
+
+void TrackHeaderDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    const QRect row = option.rect;
+    painter->save();
+
+    // Background and separator
+    const bool hovered = option.state & QStyle::State_MouseOver;
+    painter->fillRect(row, hovered ? QColor("#353535") : QColor("#2b2b2b"));
+    painter->setPen(QColor("#404040"));
+    painter->drawLine(row.bottomLeft(), row.bottomRight());
+
+    // Track name
+    QFont font = option.font;
+    font.setBold(true);
+    font.setPixelSize(12);
+    painter->setFont(font);
+    painter->setPen(Qt::white);
+    const QRect name = nameRect(row);
+    const QString text = painter->fontMetrics().elidedText(index.data().toString(), Qt::ElideRight, name.width());
+    painter->drawText(name, Qt::AlignLeft | Qt::AlignVCenter, text);
+
+    // Mute button
+    const bool muted = index.data(TrackListModel::MutedRole).toBool();
+    const QRect button = muteRect(row);
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(muted ? QColor("#ff6666") : QColor("#555555"));
+    painter->setBrush(muted ? QColor("#ff4444") : QColor("#404040"));
+    painter->drawRoundedRect(QRectF(button).adjusted(0.5, 0.5, -0.5, -0.5), 3, 3);
+    font.setPixelSize(10);
+    painter->setFont(font);
+    painter->setPen(Qt::white);
+    painter->drawText(button, Qt::AlignCenter, QStringLiteral("M"));
+
+    painter->restore();
+}
+
+QSize TrackHeaderDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    Q_UNUSED(index);
+    return QSize(option.rect.width(), m_rowHeight);
+}
+
+void TrackHeaderDelegate::updateEditorGeometry(QWidget* editor, const QStyleOptionViewItem& option,
+                                               const QModelIndex& index) const
+{
+    Q_UNUSED(index);
+    editor->setGeometry(nameRect(option.rect));
+}
+
+bool TrackHeaderDelegate::editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option,
+                                      const QModelIndex& index)
+{
+    const QEvent::Type type = event->type();
+    if (type == QEvent::MouseButtonPress || type == QEvent::MouseButtonRelease || type == QEvent::MouseButtonDblClick) {
+        const QMouseEvent* mouse = static_cast<QMouseEvent*>(event);
+        if (mouse->button() == Qt::LeftButton) {
+            if (muteRect(option.rect).contains(mouse->position().toPoint())) {
+                // The button toggles on release and swallows double clicks
+                if (type == QEvent::MouseButtonRelease) {
+                    model->setData(index, !index.data(TrackListModel::MutedRole).toBool(), TrackListModel::MutedRole);
+                }
+                return true;
+            }
+            if (type == QEvent::MouseButtonDblClick) {
+                emit settingsRequested(index);
+                return true;
+            }
+        }
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+bool TrackHeaderDelegate::helpEvent(QHelpEvent* event, QAbstractItemView* view, const QStyleOptionViewItem& option,
+                                    const QModelIndex& index)
+{
+    if (event->type() == QEvent::ToolTip && muteRect(option.rect).contains(event->pos())) {
+        QToolTip::showText(event->globalPos(), QStringLiteral("Mute Track"), view);
+        return true;
+    }
+    return QStyledItemDelegate::helpEvent(event, view, option, index);
+}
@@ -0,0 +1,40 @@
+#ifndef TRACKHEADERDELEGATE_H
+#define TRACKHEADERDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Paints a TrackListModel row as a track header: the name and a mute
+// button. The button is drawn, not a widget; clicks on it go through
+// editorEvent. The only real widget is the line edit for renaming, which
+// the view creates when editing starts (F2) and deletes when it ends.
+class TrackHeaderDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit TrackHeaderDelegate(int rowHeight, QObject* parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    void updateEditorGeometry(QWidget* editor, const QStyleOptionViewItem& option,
+                              const QModelIndex& index) const override;
+    bool helpEvent(QHelpEvent* event, QAbstractItemView* view, const QStyleOptionViewItem& option,
+                   const QModelIndex& index) override;
+
+signals:
+    void settingsRequested(const QModelIndex& index); // Double click outside the mute button
+
+protected:
+    bool editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option,
+                     const QModelIndex& index) override;
+
+private:
+    static constexpr int MARGIN = 8;
+    static constexpr int BUTTON_SIZE = 24;
+
+    static QRect muteRect(const QRect& row);
+    static QRect nameRect(const QRect& row);
+
+    int m_rowHeight;
+};
+
+#endif // TRACKHEADERDELEGATE_H
@@ -0,0 +1,72 @@
+#include "trackheaderview.h"
+#include <QCoreApplication>
+#include <QScrollBar>
+#include <QWheelEvent>
+
+TrackHeaderView::TrackHeaderView(QWidget* parent)
+    : QListView(parent)
+{
+    // Rows all have the track height, so laying them out is arithmetic
+    setUniformItemSizes(true);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setEditTriggers(QAbstractItemView::EditKeyPressed); // Double click opens the track's settings
+    setFrameShape(QFrame::NoFrame);
+    setMouseTracking(true);
+    viewport()->setAttribute(Qt::WA_Hover);
+    setStyleSheet("QListView { border: none; background: transparent; }");
+}
+
+void TrackHeaderView::setScrollSource(QScrollBar* scrollBar)
+{
+    if (m_scrollSource) {
+        disconnect(m_scrollSource, nullptr, this, nullptr);
+    }
+    m_scrollSource = scrollBar;
+    if (m_scrollSource) {
+        connect(m_scrollSource, &QScrollBar::valueChanged, this, &TrackHeaderView::setScrollOffset);
+        setScrollOffset(m_scrollSource->value());
+    }
+}
+
+void TrackHeaderView::setScrollOffset(int offset)
+{
+    // The timeline can scroll past the last track; so can the headers
+    m_offset = offset;
+    QScrollBar* bar = verticalScrollBar();
+    bar->setMaximum(qMax(bar->maximum(), offset));
+    bar->setValue(offset);
+}
+
+void TrackHeaderView::updateGeometries()
+{
+    QListView::updateGeometries();
+    setScrollOffset(m_offset); // The base class resets the range to the rows alone
+}
+
+void TrackHeaderView::wheelEvent(QWheelEvent* event)
+{
+    if (m_scrollSource) {
+        QCoreApplication::sendEvent(m_scrollSource, event);
+    } else {
+        QListView::wheelEvent(event);
+    }
+}
+
+void TrackHeaderView::scrollTo(const QModelIndex& index, ScrollHint hint)
+{
+    if (!m_scrollSource) {
+        QListView::scrollTo(index, hint);
+        return;
+    }
+
+    // Move the shared bar just enough to show the row; this view follows
+    const QRect rect = visualRect(index);
+    if (rect.top() < 0) {
+        m_scrollSource->setValue(m_scrollSource->value() + rect.top());
+    } else if (rect.bottom() >= viewport()->height()) {
+        m_scrollSource->setValue(m_scrollSource->value() + rect.bottom() + 1 - viewport()->height());
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef TRACKHEADERVIEW_H
+#define TRACKHEADERVIEW_H
+
+#include <QListView>
+
+class QScrollBar;
+
+// The track header column. It has no scroll bar of its own: it follows
+// the timeline view's vertical scroll bar, and wheel events and keyboard
+// navigation over it move that bar, so the headers and the tracks always
+// share one scroll offset.
+class TrackHeaderView : public QListView
+{
+    Q_OBJECT
+public:
+    explicit TrackHeaderView(QWidget* parent = nullptr);
+
+    void setScrollSource(QScrollBar* scrollBar);
+    void scrollTo(const QModelIndex& index, ScrollHint hint = EnsureVisible) override;
+
+protected:
+    void wheelEvent(QWheelEvent* event) override;
+    void updateGeometries() override;
+
+private:
+    void setScrollOffset(int offset);
+
+    QScrollBar* m_scrollSource = nullptr;
+    int m_offset = 0;
+};
+
+#endif // TRACKHEADERVIEW_H
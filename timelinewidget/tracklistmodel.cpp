@@ -0,0 +1,80 @@
+#include "tracklistmodel.h"
+#include "track.h"
+#include "../src/applog.h"
+
+TrackListModel::TrackListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void TrackListModel::addTrack(Track* track)
+{
+    const int row = m_tracks.size();
+    beginInsertRows(QModelIndex(), row, row);
+    m_tracks.append(track);
+    endInsertRows();
+}
+
+void TrackListModel::trackChanged(Track* track)
+{
+    const int row = m_tracks.indexOf(track);
+    if (row >= 0) {
+        emit dataChanged(index(row), index(row));
+    }
+}
+
+int TrackListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_tracks.size();
+}
+
+QVariant TrackListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_tracks.size()) {
+        return QVariant();
+    }
+
+    const Track* track = m_tracks[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return track->name().isEmpty() ? QString("Track %1").arg(track->getIndex() + 1) : track->name();
+    case MutedRole:
+        return track->isMuted();
+    default:
+        return QVariant();
+    }
+}
+
+bool TrackListModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (!index.isValid() || index.row() >= m_tracks.size()) {
+        return false;
+    }
+
+    Track* track = m_tracks[index.row()];
+    if (role == Qt::EditRole) {
+        track->setName(value.toString());
+    } else if (role == MutedRole) {
+        const bool muted = value.toBool();
+        if (muted == track->isMuted()) {
+            return false;
+        }
+        LOG_DEBUG(lcTimeline) << "TrackListModel: Track" << track->getIndex() << "mute set to" << muted;
+        track->setMuted(muted);
+        emit muteToggled(track, muted);
+    } else {
+        return false;
+    }
+
+    emit dataChanged(index, index, { role });
+    return true;
+}
+
+Qt::ItemFlags TrackListModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+}
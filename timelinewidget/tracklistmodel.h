@@ -0,0 +1,41 @@
+#ifndef TRACKLISTMODEL_H
+#define TRACKLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+
+class Track;
+
+// One row per track, for the header column beside the timeline. Rows are
+// painted by TrackHeaderDelegate instead of being built from widgets, so a
+// template with hundreds of tracks costs a row each and only the rows on
+// screen are drawn.
+class TrackListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Roles {
+        MutedRole = Qt::UserRole + 1
+    };
+
+    explicit TrackListModel(QObject* parent = nullptr);
+
+    void addTrack(Track* track);
+    Track* track(int row) const { return m_tracks.value(row); }
+    // Repaints the track's row after it was edited elsewhere
+    void trackChanged(Track* track);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    // Qt::EditRole renames the track, MutedRole mutes it
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+signals:
+    void muteToggled(Track* track, bool muted);
+
+private:
+    QList<Track*> m_tracks;
+};
+
+#endif // TRACKLISTMODEL_H
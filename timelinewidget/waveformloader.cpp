@@ -0,0 +1,270 @@
+#include "waveformloader.h"
+#include "audioitem.h"
+#include "../src/applog.h"
+#include "../src/audiokernels.h"
+#include "../src/mediacache.h"
+#include "../src/paralleldecoder.h"
+#include "../src/peakpyramid.h"
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <cmath>
+
+namespace {
+
+// Level-0 peak being filled in; chunks from different threads can share one
+struct Bucket {
+    float min = 0.0f;
+    float max = 0.0f;
+    double squares = 0.0;
+    qint64 samples = 0;
+
+    void add(const Bucket& other)
+    {
+        if (other.samples == 0) {
+            return;
+        }
+        min = samples > 0 ? std::min(min, other.min) : other.min;
+        max = samples > 0 ? std::max(max, other.max) : other.max;
+        squares += other.squares;
+        samples += other.samples;
+    }
+};
+
+} // namespace
+
+struct WaveformLoader::Job {
+    AudioItem* item = nullptr; // Only dereferenced on the GUI thread while the job is current; null for a source
+    QString filePath;
+    std::atomic<bool> cancelled{ false };
+
+    QMutex mutex; // Guards the fields below
+    QVector<Bucket> buckets;
+    qint64 estimatedFrames = 0;
+    QElapsedTimer sincePublished;
+};
+
+WaveformLoader::WaveformLoader(QObject* parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(MAX_CONCURRENT_FILES);
+}
+
+WaveformLoader::~WaveformLoader()
+{
+    for (const QSharedPointer<Job>& job : std::as_const(m_jobs)) {
+        job->cancelled = true;
+    }
+    for (const QSharedPointer<Job>& job : std::as_const(m_sourceJobs)) {
+        job->cancelled = true;
+    }
+    m_jobs.clear();
+    m_sourceJobs.clear();
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void WaveformLoader::load(AudioItem* item, const QString& filePath)
+{
+    cancel(item);
+
+    QSharedPointer<Job> job(new Job);
+    job->item = item;
+    job->filePath = filePath;
+    m_jobs.insert(item, job);
+    item->setLoading(true);
+
+    m_pool.start([this, job]() { run(job); });
+}
+
+void WaveformLoader::loadSource(const QString& filePath)
+{
+    if (m_sourceJobs.contains(filePath)) {
+        return;
+    }
+
+    QSharedPointer<Job> job(new Job);
+    job->filePath = filePath;
+    m_sourceJobs.insert(filePath, job);
+
+    m_pool.start([this, job]() { run(job); });
+}
+
+void WaveformLoader::cancel(AudioItem* item)
+{
+    QSharedPointer<Job> job = m_jobs.take(item);
+    if (job) {
+        job->cancelled = true;
+        LOG_DEBUG(lcWaveform) << "WaveformLoader: Cancelled" << job->filePath;
+    }
+}
+
+void WaveformLoader::run(const QSharedPointer<Job>& job)
+{
+    if (job->cancelled) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Peaks from an earlier decode are mapped, not rebuilt: no audio is read
+    if (!MediaCache::instance().find(job->filePath)) {
+        int sampleRate = 0;
+        const PeakPyramid peaks = MediaCache::instance().peakCache().map(job->filePath, &sampleRate);
+        if (!peaks.isEmpty()) {
+            LOG_DEBUG(lcWaveform) << "WaveformLoader: Mapped peaks for" << job->filePath << "in"
+                                  << timer.nsecsElapsed() / 1.0e6 << "ms";
+            const double duration = static_cast<double>(peaks.frames()) / sampleRate;
+            QMetaObject::invokeMethod(this, [this, job, peaks, duration]() {
+                if (!take(job)) {
+                    return;
+                }
+                deliver(job, peaks);
+                if (job->item) {
+                    emit loaded(job->item, duration);
+                } else {
+                    emit sourceLoaded(job->filePath, duration);
+                }
+            }, Qt::QueuedConnection);
+            return;
+        }
+    }
+
+    // The container's estimate sizes the partial waveform until the decode gives the exact length
+    if (!MediaCache::instance().find(job->filePath)) {
+        qint64 estimatedFrames = 0;
+        MediaCache::instance().probe(job->filePath, nullptr, &estimatedFrames);
+        QMutexLocker locker(&job->mutex);
+        job->estimatedFrames = estimatedFrames;
+        job->sincePublished.start();
+    }
+
+    AudioResult result;
+    QSharedPointer<const DecodedMedia> media = MediaCache::instance().load(
+        job->filePath, &result, [this, job](qint64 frame, const float* samples, int frames) {
+            return accumulate(job, frame, samples, frames);
+        });
+
+    LOG_DEBUG(lcWaveform) << "WaveformLoader: Loaded" << job->filePath << "in" << timer.elapsed() << "ms";
+
+    QMetaObject::invokeMethod(this, [this, job, media, result]() {
+        if (!take(job)) {
+            return; // Cancelled or replaced meanwhile
+        }
+
+        if (!media) {
+            if (job->item) {
+                emit failed(job->item, result);
+            } else {
+                emit sourceFailed(job->filePath, result);
+            }
+            return;
+        }
+        deliver(job, media->peaks);
+        if (job->item) {
+            emit loaded(job->item, media->durationSeconds());
+        } else {
+            emit sourceLoaded(job->filePath, media->durationSeconds());
+        }
+    }, Qt::QueuedConnection);
+}
+
+bool WaveformLoader::accumulate(const QSharedPointer<Job>& job, qint64 frame, const float* samples, int frames)
+{
+    if (job->cancelled) {
+        return false;
+    }
+
+    // Summarize the chunk without the lock, then merge it in
+    constexpr qint64 bucketFrames = PeakPyramid::BASE_BUCKET_FRAMES;
+    if (frame < 0) {
+        samples -= frame * ParallelDecoder::CHANNELS;
+        frames += static_cast<int>(frame);
+        frame = 0;
+    }
+    if (frames <= 0) {
+        return true;
+    }
+
+    const qint64 firstBucket = frame / bucketFrames;
+    const qint64 endFrame = frame + frames;
+    QVector<Bucket> chunk((endFrame - 1) / bucketFrames - firstBucket + 1);
+    for (qint64 position = frame; position < endFrame;) {
+        const qint64 count = std::min((position / bucketFrames + 1) * bucketFrames, endFrame) - position;
+        const qint64 sampleCount = count * ParallelDecoder::CHANNELS;
+        Bucket part;
+        AudioKernels::peakStats(samples + (position - frame) * ParallelDecoder::CHANNELS, static_cast<size_t>(sampleCount),
+                                &part.min, &part.max, &part.squares);
+        part.samples = sampleCount;
+        chunk[position / bucketFrames - firstBucket].add(part);
+        position += count;
+    }
+
+    QVector<Peak> snapshot;
+    qint64 snapshotFrames = 0;
+    {
+        QMutexLocker locker(&job->mutex);
+        if (job->buckets.size() < firstBucket + chunk.size()) {
+            job->buckets.resize(firstBucket + chunk.size());
+        }
+        for (qsizetype i = 0; i < chunk.size(); ++i) {
+            job->buckets[firstBucket + i].add(chunk[i]);
+        }
+
+        if (job->sincePublished.isValid() && job->sincePublished.elapsed() >= PROGRESS_INTERVAL_MS) {
+            job->sincePublished.restart();
+            snapshot.resize(job->buckets.size());
+            for (qsizetype i = 0; i < snapshot.size(); ++i) {
+                const Bucket& bucket = job->buckets[i];
+                snapshot[i] = bucket.samples > 0
+                                  ? Peak{ bucket.min, bucket.max, static_cast<float>(std::sqrt(bucket.squares / bucket.samples)) }
+                                  : Peak{ 0.0f, 0.0f, 0.0f };
+            }
+            snapshotFrames = std::max(job->estimatedFrames, snapshot.size() * bucketFrames);
+        }
+    }
+
+    if (!snapshot.isEmpty()) {
+        // Not-yet-decoded buckets stay flat; the final pyramid replaces all of it
+        const PeakPyramid peaks = PeakPyramid::fromBaseLevel(snapshot, snapshotFrames);
+        QMetaObject::invokeMethod(this, [this, job, peaks]() {
+            if (isCurrent(job)) {
+                deliver(job, peaks);
+            }
+        }, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+bool WaveformLoader::isCurrent(const QSharedPointer<Job>& job) const
+{
+    return job->item ? m_jobs.value(job->item) == job : m_sourceJobs.value(job->filePath) == job;
+}
+
+bool WaveformLoader::take(const QSharedPointer<Job>& job)
+{
+    if (!isCurrent(job)) {
+        return false;
+    }
+    if (job->item) {
+        m_jobs.remove(job->item);
+        job->item->setLoading(false);
+    } else {
+        m_sourceJobs.remove(job->filePath);
+    }
+    return true;
+}
+
+void WaveformLoader::deliver(const QSharedPointer<Job>& job, const PeakPyramid& peaks)
+{
+    if (job->item) {
+        job->item->setPeaks(peaks);
+    } else {
+        emit sourcePeaksChanged(job->filePath, peaks);
+    }
+}
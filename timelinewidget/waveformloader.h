@@ -0,0 +1,67 @@
+#ifndef WAVEFORMLOADER_H
+#define WAVEFORMLOADER_H
+
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QThreadPool>
+#include "../src/audioerror.h"
+#include "../src/peakpyramid.h"
+
+class AudioItem;
+
+// Builds clip waveforms on a worker pool so importing never blocks the GUI.
+//
+// A clip shows a placeholder at once. Files decoded before get their peaks
+// mapped from the PeakCache without decoding anything. Otherwise, while the
+// file decodes (through the MediaCache, so playback reuses the result) the
+// peaks decoded so far are published every PROGRESS_INTERVAL_MS and drawn;
+// the final pyramid and the exact duration replace them when it completes.
+// Cancelling a clip's job stops its decode at the next decoded block, and
+// nothing from it reaches the clip afterwards.
+//
+// Clips drawn by their Track (batched clips) have no item of their own; their
+// waveforms are loaded per file instead, with loadSource, and reported
+// through the source signals.
+class WaveformLoader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WaveformLoader(QObject* parent = nullptr);
+    ~WaveformLoader() override;
+
+    // Replaces any job the item already has
+    void load(AudioItem* item, const QString& filePath);
+    // Call before the item is deleted
+    void cancel(AudioItem* item);
+    bool isLoading(AudioItem* item) const { return m_jobs.contains(item); }
+
+    // Does nothing while the file is already loading
+    void loadSource(const QString& filePath);
+
+    static constexpr int MAX_CONCURRENT_FILES = 2; // Each decode already spreads over every core
+    static constexpr int PROGRESS_INTERVAL_MS = 100;
+
+signals:
+    void loaded(AudioItem* item, double durationSeconds);
+    void failed(AudioItem* item, const AudioResult& result);
+    void sourcePeaksChanged(const QString& filePath, const PeakPyramid& peaks); // Partial, then final
+    void sourceLoaded(const QString& filePath, double durationSeconds);
+    void sourceFailed(const QString& filePath, const AudioResult& result);
+
+private:
+    struct Job;
+
+    void run(const QSharedPointer<Job>& job); // Worker thread
+    bool accumulate(const QSharedPointer<Job>& job, qint64 frame, const float* samples, int frames); // Decoding threads
+    bool isCurrent(const QSharedPointer<Job>& job) const; // GUI thread, as are the two below
+    bool take(const QSharedPointer<Job>& job);            // Ends the job if it is still current
+    void deliver(const QSharedPointer<Job>& job, const PeakPyramid& peaks);
+
+    QThreadPool m_pool;
+    QHash<AudioItem*, QSharedPointer<Job>> m_jobs;     // GUI thread only
+    QHash<QString, QSharedPointer<Job>> m_sourceJobs;  // GUI thread only
+};
+
+#endif // WAVEFORMLOADER_H